@@ -47,18 +47,37 @@ CONFIG(debug, debug|release) {
 
 SOURCES += \
     classes/aclass.cpp \
+    classes/baselineestimator.cpp \
+    classes/binaryframedecoder.cpp \
+    classes/classificationcache.cpp \
+    classes/classifier.cpp \
+    classes/classifierbenchmark.cpp \
+    classes/classificationworker.cpp \
+    classes/classifierensemble.cpp \
+    classes/classifierevaluation.cpp \
+    classes/taskexecutor.cpp \
+    classes/modelfitter.cpp \
+    classes/fitterbenchmark.cpp \
     classes/annotation.cpp \
     classes/clouduploader.cpp \
     classes/controler.cpp \
     classes/datasource.cpp \
+    classes/devicepipeline.cpp \
+    classes/devicesimulator.cpp \
     classes/enosecolor.cpp \
     classes/espflasher.cpp \
     classes/fakedatasource.cpp \
     classes/functionalisation.cpp \
+    classes/funcwindowbuffer.cpp \
     classes/leastsquaresfitter.cpp \
+    classes/liveclassifier.cpp \
     classes/measurementdata.cpp \
+    classes/mlpclassifier.cpp \
     classes/mvector.cpp \
-    classes/torchclassifier.cpp \
+    classes/replaydatasource.cpp \
+    classes/serialjournal.cpp \
+    classes/serialjournaldatasource.cpp \
+    classes/stressdatasource.cpp \
     classes/usbdatasource.cpp \
     classes/curvefitworker.cpp \
     lib/comboboxitemdelegate.cpp \
@@ -86,20 +105,40 @@ SOURCES += \
 
 HEADERS += \
     classes/aclass.h \
+    classes/baselineestimator.h \
+    classes/binaryframedecoder.h \
+    classes/classificationcache.h \
+    classes/classifierbenchmark.h \
+    classes/classificationworker.h \
+    classes/classifier.h \
+    classes/classifierensemble.h \
+    classes/classifierevaluation.h \
+    classes/taskexecutor.h \
+    classes/modelfitter.h \
+    classes/fitterbenchmark.h \
     classes/annotation.h \
     classes/classifier_definitions.h \
     classes/clouduploader.h \
     classes/controler.h \
     classes/datasource.h \
+    classes/devicepipeline.h \
+    classes/devicesimulator.h \
     classes/defaultSettings.h \
     classes/enosecolor.h \
     classes/espflasher.h \
     classes/fakedatasource.h \
     classes/functionalisation.h \
+    classes/funcwindowbuffer.h \
     classes/leastsquaresfitter.h \
+    classes/liveclassifier.h \
     classes/measurementdata.h \
+    classes/mlpclassifier.h \
     classes/mvector.h \
-    classes/torchclassifier.h \
+    classes/replaydatasource.h \
+    classes/serialjournal.h \
+    classes/serialjournaldatasource.h \
+    classes/spscringbuffer.h \
+    classes/stressdatasource.h \
     classes/usbdatasource.h \
     classes/curvefitworker.h \
     lib/comboboxitemdelegate.h \
@@ -150,15 +189,31 @@ DISTFILES += \
 RESOURCES += \
     eNoseAnnotator.qrc
 
-# libtorch
-win32: LIBS += -L$$PWD/lib/libtorch/lib -ltorch -lc10 -ltorch_cpu
-unix:!macx: LIBS += -L$$PWD/lib/libtorch/lib -ltorch -lc10 -ltorch_cpu
-unix:!macx: QMAKE_RPATHDIR += $$PWD/lib/libtorch/lib
+# libtorch: TorchScript classifiers, build with "qmake CONFIG+=no_torch" to use only the built-in MLP backend
+!no_torch {
+    DEFINES += TORCH_BACKEND
 
-INCLUDEPATH += $$PWD/lib/libtorch/include
-DEPENDPATH += $$PWD/lib/libtorch/include
-INCLUDEPATH += $$PWD/lib/libtorch/include/torch/csrc/api/include
-DEPENDPATH += $$PWD/lib/libtorch/include/torch/csrc/api/include
+    SOURCES += classes/torchclassifier.cpp
+    HEADERS += classes/torchclassifier.h
+
+    win32: LIBS += -L$$PWD/lib/libtorch/lib -ltorch -lc10 -ltorch_cpu
+    unix:!macx: LIBS += -L$$PWD/lib/libtorch/lib -ltorch -lc10 -ltorch_cpu
+    unix:!macx: QMAKE_RPATHDIR += $$PWD/lib/libtorch/lib
+
+    INCLUDEPATH += $$PWD/lib/libtorch/include
+    DEPENDPATH += $$PWD/lib/libtorch/include
+    INCLUDEPATH += $$PWD/lib/libtorch/include/torch/csrc/api/include
+    DEPENDPATH += $$PWD/lib/libtorch/include/torch/csrc/api/include
+}
+
+# AVX2 & FMA kernels of the built-in MLP backend and the curve fit model: "qmake CONFIG+=mlp_avx2", the binary then requires a CPU supporting them
+mlp_avx2 {
+    win32-msvc*: QMAKE_CXXFLAGS += /arch:AVX2
+    else: QMAKE_CXXFLAGS += -mavx2 -mfma
+}
+
+# peak memory of the classifier benchmark
+win32: LIBS += -lpsapi
 
 # dlib
 LIBS += -L$$PWD/lib/dlib
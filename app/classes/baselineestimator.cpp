@@ -0,0 +1,205 @@
+#include "baselineestimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+/*!
+ * \class BaselineEstimator
+ * \brief Estimates the base vector (R0) of a sensor from the stream of vectors received.
+ * After reset() the next nVectors vectors are collected and combined by their mean, median or trimmed mean.
+ * If trackDrift is set, the base vector adapts afterwards by an exponential moving average with weight driftAlpha per vector.
+ * A new base vector is only reported if one of its channels changed by more than driftThreshold relative to the last one reported.
+ *
+ * All buffers are allocated by reset(), so update() costs O(nChannels) per vector without allocations.
+ */
+BaselineEstimator::BaselineEstimator(BaselineEstimator::Settings settings):
+    settings(settings)
+{
+}
+
+BaselineEstimator::Settings BaselineEstimator::getSettings() const
+{
+    return settings;
+}
+
+/*!
+ * \brief BaselineEstimator::setSettings changes the settings. A changed mode or nVectors applies to the next base vector estimated.
+ */
+void BaselineEstimator::setSettings(const BaselineEstimator::Settings &value)
+{
+    Q_ASSERT("Invalid number of base vectors!" && value.nVectors > 0);
+
+    bool resize = value.nVectors != settings.nVectors;
+    settings = value;
+
+    // start drift tracking from the current base vector
+    if (ready && settings.trackDrift)
+        for (int i=0; i<nChannels; i++)
+            drift[i] = baseVector[i];
+
+    // a running estimation restarts with the new number of vectors
+    if (resize && !ready)
+        reset(nChannels);
+}
+
+/*!
+ * \brief BaselineEstimator::reset starts the estimation of a new base vector with \a nChannels channels.
+ */
+void BaselineEstimator::reset(int nChannels)
+{
+    this->nChannels = nChannels;
+    nCollected = 0;
+    ready = false;
+
+    size_t channels = static_cast<size_t>(nChannels);
+    sum.assign(channels, 0.0);
+    window.assign(channels * static_cast<size_t>(settings.nVectors), 0.0);
+    column.assign(static_cast<size_t>(settings.nVectors), 0.0);
+    drift.assign(channels, 0.0);
+
+    if (baseVector.getSize() != channels)
+        baseVector = AbsoluteMVector(nullptr, channels);
+}
+
+/*!
+ * \brief BaselineEstimator::update adds \a vector to the estimation. Returns true if the base vector changed.
+ */
+bool BaselineEstimator::update(const MVector &vector)
+{
+    if (ready)
+        return settings.trackDrift && trackDrift(vector);
+
+    int channels = qMin(nChannels, static_cast<int>(vector.getSize()));
+    double *row = window.data() + static_cast<size_t>(nCollected) * static_cast<size_t>(nChannels);
+    for (int i=0; i<channels; i++)
+    {
+        row[i] = vector[i];
+        sum[i] += vector[i];
+    }
+    nCollected++;
+
+    if (nCollected < settings.nVectors)
+        return false;
+
+    estimate();
+    ready = true;
+
+    for (int i=0; i<nChannels; i++)
+        drift[i] = baseVector[i];
+
+    return true;
+}
+
+void BaselineEstimator::estimate()
+{
+    size_t n = static_cast<size_t>(nCollected);
+
+    if (settings.mode == Mode::Mean)
+    {
+        for (int i=0; i<nChannels; i++)
+            baseVector[i] = sum[i] / nCollected;
+        return;
+    }
+
+    // at least one value per side is cut if there are enough: a small window still drops its outliers
+    // (tolerance: 0.1 * 30 must not round up to 4)
+    size_t trim = settings.mode == Mode::TrimmedMean ? static_cast<size_t>(std::ceil(settings.trimFraction * n - 1e-9)) : 0;
+    if (2 * trim >= n)
+        trim = (n - 1) / 2;
+
+    for (int i=0; i<nChannels; i++)
+    {
+        for (size_t j=0; j<n; j++)
+            column[j] = window[j * static_cast<size_t>(nChannels) + static_cast<size_t>(i)];
+
+        std::sort(column.begin(), column.begin() + static_cast<long>(n));
+
+        if (settings.mode == Mode::Median)
+        {
+            baseVector[i] = n % 2 == 1 ? column[n/2] : (column[n/2 - 1] + column[n/2]) / 2;
+        }
+        else
+        {
+            double trimmedSum = 0.0;
+            for (size_t j=trim; j<n-trim; j++)
+                trimmedSum += column[j];
+            baseVector[i] = trimmedSum / (n - 2 * trim);
+        }
+    }
+}
+
+/*!
+ * \brief BaselineEstimator::trackDrift adds \a vector to the drift estimate.
+ * Returns true and updates the base vector if the drift estimate of a channel deviates by more than driftThreshold from it.
+ */
+bool BaselineEstimator::trackDrift(const MVector &vector)
+{
+    int channels = qMin(nChannels, static_cast<int>(vector.getSize()));
+    bool changed = false;
+
+    for (int i=0; i<channels; i++)
+    {
+        double value = vector[i];
+        if (!qIsFinite(value))
+            continue;
+
+        drift[i] += settings.driftAlpha * (value - drift[i]);
+
+        if (qAbs(drift[i] - baseVector[i]) > settings.driftThreshold * qAbs(baseVector[i]))
+            changed = true;
+    }
+
+    if (changed)
+        for (int i=0; i<nChannels; i++)
+            baseVector[i] = drift[i];
+
+    return changed;
+}
+
+/*!
+ * \brief BaselineEstimator::isEmpty returns true if no vector was added since the last reset.
+ */
+bool BaselineEstimator::isEmpty() const
+{
+    return nCollected == 0;
+}
+
+/*!
+ * \brief BaselineEstimator::isReady returns true if a base vector was estimated since the last reset.
+ */
+bool BaselineEstimator::isReady() const
+{
+    return ready;
+}
+
+int BaselineEstimator::getNChannels() const
+{
+    return nChannels;
+}
+
+const AbsoluteMVector &BaselineEstimator::getBaseVector() const
+{
+    return baseVector;
+}
+
+QString BaselineEstimator::modeToString(BaselineEstimator::Mode mode)
+{
+    switch (mode)
+    {
+    case Mode::Median:
+        return "median";
+    case Mode::TrimmedMean:
+        return "trimmed mean";
+    default:
+        return "mean";
+    }
+}
+
+BaselineEstimator::Mode BaselineEstimator::modeFromString(QString modeString)
+{
+    if (modeString == "median")
+        return Mode::Median;
+    if (modeString == "trimmed mean")
+        return Mode::TrimmedMean;
+    return Mode::Mean;
+}
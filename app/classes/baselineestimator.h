@@ -0,0 +1,59 @@
+#ifndef BASELINEESTIMATOR_H
+#define BASELINEESTIMATOR_H
+
+#include "mvector.h"
+
+class BaselineEstimator
+{
+public:
+    enum class Mode {
+        Mean,
+        Median,
+        TrimmedMean
+    };
+
+    struct Settings{
+        Mode mode = Mode::Mean;
+        int nVectors = 4;                   // vectors used to estimate a new base vector
+        double trimFraction = 0.2;          // fraction of values cut at each end in TrimmedMean mode
+        bool trackDrift = false;            // adapt the base vector slowly after it was estimated
+        double driftAlpha = 0.001;          // weight of each vector in the drift estimate
+        double driftThreshold = 0.005;      // min relative change of a channel to publish a new base vector
+    };
+
+    BaselineEstimator(Settings settings = Settings());
+
+    Settings getSettings() const;
+    void setSettings(const Settings &value);
+
+    void reset(int nChannels);
+    bool update(const MVector &vector);
+
+    bool isEmpty() const;
+    bool isReady() const;
+    int getNChannels() const;
+    const AbsoluteMVector &getBaseVector() const;
+
+    static QString modeToString(Mode mode);
+    static Mode modeFromString(QString modeString);
+
+private:
+    Settings settings;
+    int nChannels = 0;
+    int nCollected = 0;         // vectors collected since the last reset
+    bool ready = false;
+
+    std::vector<double> sum;    // running sum of the collected vectors
+    std::vector<double> window; // collected vectors, one row of nChannels values per vector
+    std::vector<double> column; // values of one channel, sorted for median & trimmed mean
+    std::vector<double> drift;  // slowly adapting estimate of the base values
+
+    AbsoluteMVector baseVector;
+
+    void estimate();
+    bool trackDrift(const MVector &vector);
+};
+
+Q_DECLARE_METATYPE(BaselineEstimator::Settings);
+
+#endif // BASELINEESTIMATOR_H
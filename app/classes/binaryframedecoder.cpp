@@ -0,0 +1,278 @@
+#include "binaryframedecoder.h"
+
+#include <QtEndian>
+
+#include <array>
+#include <cstring>
+
+namespace {
+
+float floatFromLittleEndian(const uchar *data)
+{
+    quint32 bits = qFromLittleEndian<quint32>(data);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void floatToLittleEndian(float value, uchar *data)
+{
+    quint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian<quint32>(bits, data);
+}
+
+}
+
+const quint8 BinaryFrameDecoder::syncBytes[2] = {0xA5, 0x5A};
+
+/*!
+ * \class BinaryFrameDecoder
+ * \brief Decodes the binary framed protocol of the eNose firmware.
+ * Binary frames replace the ASCII lines for sensors with many channels or high rates.
+ * USBDataSource requests them with BINARY_ON after the device info was received; devices answering BINARY_OK send frames afterwards.
+ *
+ * Frame layout (little endian):
+ * sync (0xA5 0x5A), type (quint8), payload size (quint16), payload, CRC-16/CCITT-FALSE of type, size and payload (quint16)
+ *
+ * Payloads:
+ * \list
+ * \li Measurement: count (quint32), number of channels (quint16), flags (quint8, bit 0: environment sensors),
+ *     channel values (float32 each)[, temperature (float32), humidity (float32)]
+ * \li Fan: fan level (quint8, 0: off)
+ * \li Event: empty
+ * \endlist
+ *
+ * On a missing sync, a payload size exceeding the maximum of its frame type or a CRC error the decoder resynchronises on the next sync byte,
+ * so corrupted frames are dropped without losing following frames. The size check keeps a corrupted size field from holding back the resync
+ * until up to 64 kB were received.
+ */
+BinaryFrameDecoder::BinaryFrameDecoder()
+{
+}
+
+/*!
+ * \brief BinaryFrameDecoder::append adds \a data received to the decoder. Invalidates the payloads of frames taken before.
+ */
+void BinaryFrameDecoder::append(const QByteArray &data)
+{
+    if (position > 0)
+    {
+        buffer.remove(0, position);
+        position = 0;
+    }
+    buffer.append(data);
+}
+
+/*!
+ * \brief BinaryFrameDecoder::takeFrame decodes the next complete frame into \a frame. Returns false if no complete frame is buffered.
+ */
+bool BinaryFrameDecoder::takeFrame(BinaryFrameDecoder::Frame &frame)
+{
+    while (buffer.size() - position >= headerSize + crcSize)
+    {
+        const uchar *data = reinterpret_cast<const uchar*>(buffer.constData()) + position;
+
+        // resync: skip to next sync byte
+        if (data[0] != syncBytes[0] || data[1] != syncBytes[1])
+        {
+            int next = buffer.indexOf(static_cast<char>(syncBytes[0]), position + 1);
+            int skipped = (next < 0 ? buffer.size() : next) - position;
+            nDiscardedBytes += static_cast<quint64>(skipped);
+            position += skipped;
+            continue;
+        }
+
+        quint8 type = data[2];
+        int size = qFromLittleEndian<quint16>(data + 3);
+        if (type < static_cast<quint8>(FrameType::Measurement) || type > static_cast<quint8>(FrameType::Event) || size > maxSize(type))
+        {
+            nDiscardedBytes++;
+            position++;
+            continue;
+        }
+
+        // wait for the rest of the frame
+        if (buffer.size() - position < headerSize + size + crcSize)
+            return false;
+
+        quint16 crc = qFromLittleEndian<quint16>(data + headerSize + size);
+        if (crc16(reinterpret_cast<const char*>(data) + 2, headerSize - 2 + size) != crc)
+        {
+            nCrcErrors++;
+            nDiscardedBytes++;
+            position++;
+            continue;
+        }
+
+        frame.type = static_cast<FrameType>(type);
+        frame.payload = reinterpret_cast<const char*>(data) + headerSize;
+        frame.size = size;
+
+        position += headerSize + size + crcSize;
+        nFrames++;
+        return true;
+    }
+
+    return false;
+}
+
+void BinaryFrameDecoder::clear()
+{
+    buffer.clear();
+    position = 0;
+}
+
+/*!
+ * \brief BinaryFrameDecoder::setNChannels sets the number of channels of the device, limiting the size of measurement frames accepted.
+ */
+void BinaryFrameDecoder::setNChannels(int value)
+{
+    nChannels = value;
+}
+
+/*!
+ * \brief BinaryFrameDecoder::maxSize returns the maximum payload size of frames of \a type.
+ */
+int BinaryFrameDecoder::maxSize(quint8 type) const
+{
+    switch (static_cast<FrameType>(type)) {
+    case FrameType::Measurement:
+        // count, number of channels, flags, channel values, temperature & humidity
+        return nChannels > 0 ? qMin(7 + 4 * (nChannels + 2), static_cast<int>(maxPayloadSize)) : maxPayloadSize;
+    case FrameType::Fan:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+quint64 BinaryFrameDecoder::getNFrames() const
+{
+    return nFrames;
+}
+
+quint64 BinaryFrameDecoder::getNCrcErrors() const
+{
+    return nCrcErrors;
+}
+
+/*!
+ * \brief BinaryFrameDecoder::getNDiscardedBytes returns the number of bytes skipped while resynchronising.
+ */
+quint64 BinaryFrameDecoder::getNDiscardedBytes() const
+{
+    return nDiscardedBytes;
+}
+
+/*!
+ * \brief BinaryFrameDecoder::decodeMeasurement writes the channel values of the measurement \a frame directly into \a vector.
+ * Returns false if the payload is malformed or the number of values differs from the size of \a vector: \a vector is reused for all frames,
+ * so missing channels would keep the values of the previous frame.
+ */
+bool BinaryFrameDecoder::decodeMeasurement(const BinaryFrameDecoder::Frame &frame, AbsoluteMVector &vector, quint32 &count, double &temperature, double &humidity, bool &hasEnvSensors)
+{
+    const int fixedSize = 7;
+    if (frame.type != FrameType::Measurement || frame.size < fixedSize)
+        return false;
+
+    const uchar *data = reinterpret_cast<const uchar*>(frame.payload);
+    count = qFromLittleEndian<quint32>(data);
+    int nValues = qFromLittleEndian<quint16>(data + 4);
+    hasEnvSensors = data[6] & 0x01;
+
+    if (frame.size != fixedSize + 4 * (nValues + (hasEnvSensors ? 2 : 0)) || static_cast<size_t>(nValues) != vector.getSize())
+        return false;
+
+    const uchar *values = data + fixedSize;
+    for (int i=0; i<nValues; i++)
+        vector[i] = static_cast<double>(floatFromLittleEndian(values + 4*i));
+
+    if (hasEnvSensors)
+    {
+        temperature = static_cast<double>(floatFromLittleEndian(values + 4*nValues));
+        humidity = static_cast<double>(floatFromLittleEndian(values + 4*nValues + 4));
+    }
+
+    return true;
+}
+
+/*!
+ * \brief BinaryFrameDecoder::decodeFanLevel returns the fan level of \a frame or -1 if the payload is malformed.
+ */
+int BinaryFrameDecoder::decodeFanLevel(const BinaryFrameDecoder::Frame &frame)
+{
+    if (frame.type != FrameType::Fan || frame.size != 1)
+        return -1;
+
+    return static_cast<quint8>(frame.payload[0]);
+}
+
+QByteArray BinaryFrameDecoder::encodeFrame(BinaryFrameDecoder::FrameType type, const QByteArray &payload)
+{
+    Q_ASSERT("Payload of binary frame too large!" && payload.size() <= maxPayloadSize);
+
+    QByteArray frame(headerSize + payload.size() + crcSize, Qt::Uninitialized);
+    uchar *data = reinterpret_cast<uchar*>(frame.data());
+
+    data[0] = syncBytes[0];
+    data[1] = syncBytes[1];
+    data[2] = static_cast<quint8>(type);
+    qToLittleEndian<quint16>(static_cast<quint16>(payload.size()), data + 3);
+    memcpy(data + headerSize, payload.constData(), static_cast<size_t>(payload.size()));
+    qToLittleEndian<quint16>(crc16(frame.constData() + 2, headerSize - 2 + payload.size()), data + headerSize + payload.size());
+
+    return frame;
+}
+
+QByteArray BinaryFrameDecoder::encodeMeasurement(quint32 count, const std::vector<double> &values, bool hasEnvSensors, double temperature, double humidity)
+{
+    int nValues = static_cast<int>(values.size());
+    QByteArray payload(7 + 4 * (nValues + (hasEnvSensors ? 2 : 0)), Qt::Uninitialized);
+    uchar *data = reinterpret_cast<uchar*>(payload.data());
+
+    qToLittleEndian<quint32>(count, data);
+    qToLittleEndian<quint16>(static_cast<quint16>(nValues), data + 4);
+    data[6] = hasEnvSensors ? 0x01 : 0x00;
+
+    uchar *valueData = data + 7;
+    for (int i=0; i<nValues; i++)
+        floatToLittleEndian(static_cast<float>(values[static_cast<size_t>(i)]), valueData + 4*i);
+
+    if (hasEnvSensors)
+    {
+        floatToLittleEndian(static_cast<float>(temperature), valueData + 4*nValues);
+        floatToLittleEndian(static_cast<float>(humidity), valueData + 4*nValues + 4);
+    }
+
+    return encodeFrame(FrameType::Measurement, payload);
+}
+
+QByteArray BinaryFrameDecoder::encodeFanLevel(int fanLevel)
+{
+    return encodeFrame(FrameType::Fan, QByteArray(1, static_cast<char>(qBound(0, fanLevel, 255))));
+}
+
+/*!
+ * \brief BinaryFrameDecoder::crc16 returns the CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF) of \a size bytes at \a data.
+ */
+quint16 BinaryFrameDecoder::crc16(const char *data, int size)
+{
+    static const std::array<quint16, 256> table = [](){
+        std::array<quint16, 256> crcTable;
+        for (int i=0; i<256; i++)
+        {
+            quint16 crc = static_cast<quint16>(i << 8);
+            for (int bit=0; bit<8; bit++)
+                crc = static_cast<quint16>(crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1);
+            crcTable[static_cast<size_t>(i)] = crc;
+        }
+        return crcTable;
+    }();
+
+    quint16 crc = 0xFFFF;
+    for (int i=0; i<size; i++)
+        crc = static_cast<quint16>((crc << 8) ^ table[((crc >> 8) ^ static_cast<quint8>(data[i])) & 0xFF]);
+
+    return crc;
+}
@@ -0,0 +1,65 @@
+#ifndef BINARYFRAMEDECODER_H
+#define BINARYFRAMEDECODER_H
+
+#include <QByteArray>
+
+#include "mvector.h"
+
+class BinaryFrameDecoder
+{
+public:
+    enum class FrameType : quint8 {
+        Measurement = 1,
+        Fan = 2,
+        Event = 3
+    };
+
+    /*!
+     * \brief The Frame struct points to the payload of a decoded frame in the buffer of the decoder.
+     * The payload stays valid until the next call of append() or clear().
+     */
+    struct Frame{
+        FrameType type = FrameType::Measurement;
+        const char *payload = nullptr;
+        int size = 0;
+    };
+
+    // frame layout
+    static const quint8 syncBytes[2];
+    static const int headerSize = 5;    // sync, type, payload size
+    static const int crcSize = 2;
+    static const int maxPayloadSize = 65535;
+
+    BinaryFrameDecoder();
+
+    void append(const QByteArray &data);
+    bool takeFrame(Frame &frame);
+    void clear();
+    void setNChannels(int value);
+
+    quint64 getNFrames() const;
+    quint64 getNCrcErrors() const;
+    quint64 getNDiscardedBytes() const;
+
+    static bool decodeMeasurement(const Frame &frame, AbsoluteMVector &vector, quint32 &count, double &temperature, double &humidity, bool &hasEnvSensors);
+    static int decodeFanLevel(const Frame &frame);
+
+    static QByteArray encodeFrame(FrameType type, const QByteArray &payload);
+    static QByteArray encodeMeasurement(quint32 count, const std::vector<double> &values, bool hasEnvSensors, double temperature, double humidity);
+    static QByteArray encodeFanLevel(int fanLevel);
+
+    static quint16 crc16(const char *data, int size);
+
+private:
+    QByteArray buffer;
+    int position = 0;   // start of the bytes not yet decoded
+    int nChannels = 0;  // channels of the device, 0: unknown
+
+    int maxSize(quint8 type) const;
+
+    quint64 nFrames = 0;
+    quint64 nCrcErrors = 0;
+    quint64 nDiscardedBytes = 0;
+};
+
+#endif // BINARYFRAMEDECODER_H
@@ -0,0 +1,112 @@
+#include "classificationcache.h"
+
+/*!
+ * \class ClassificationCache
+ * \brief Stores the annotations of classifier inputs, so unchanged inputs are not classified again.
+ * Entries are keyed by the model key of the classifier and the raw bytes of the input vector after the input function was applied,
+ * so only bit-identical inputs of the same model are answered from the cache.
+ * At most \a capacity annotations are kept, the least recently used ones are evicted first.
+ * All methods can be called from any thread.
+ */
+ClassificationCache::ClassificationCache(int capacity):
+    cache(capacity)
+{
+}
+
+/*!
+ * \brief ClassificationCache::find sets \a annotation to the cached annotation of \a input classified by the model with \a modelKey.
+ * Returns false if \a input is not cached.
+ */
+bool ClassificationCache::find(const QByteArray &modelKey, const std::vector<double> &input, Annotation &annotation)
+{
+    QByteArray key = makeKey(modelKey, input);
+
+    QMutexLocker locker(&mutex);
+    Annotation *cachedAnnotation = cache.object(key);
+    if (cachedAnnotation == nullptr)
+    {
+        nMisses++;
+        return false;
+    }
+
+    nHits++;
+    annotation = *cachedAnnotation;
+    return true;
+}
+
+void ClassificationCache::insert(const QByteArray &modelKey, const std::vector<double> &input, const Annotation &annotation)
+{
+    QByteArray key = makeKey(modelKey, input);
+
+    QMutexLocker locker(&mutex);
+    cache.insert(key, new Annotation(annotation));
+}
+
+/*!
+ * \brief ClassificationCache::clear removes all entries and resets the statistics.
+ */
+void ClassificationCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    cache.clear();
+    nHits = 0;
+    nMisses = 0;
+}
+
+int ClassificationCache::getCapacity() const
+{
+    QMutexLocker locker(&mutex);
+    return cache.maxCost();
+}
+
+/*!
+ * \brief ClassificationCache::setCapacity sets the maximal number of entries. Evicts the least recently used entries if the cache is larger.
+ */
+void ClassificationCache::setCapacity(int value)
+{
+    QMutexLocker locker(&mutex);
+    cache.setMaxCost(value);
+}
+
+int ClassificationCache::getSize() const
+{
+    QMutexLocker locker(&mutex);
+    return cache.size();
+}
+
+quint64 ClassificationCache::getNHits() const
+{
+    QMutexLocker locker(&mutex);
+    return nHits;
+}
+
+quint64 ClassificationCache::getNMisses() const
+{
+    QMutexLocker locker(&mutex);
+    return nMisses;
+}
+
+/*!
+ * \brief ClassificationCache::getHitRate returns the fraction of lookups answered from the cache, 0 if nothing was looked up.
+ */
+double ClassificationCache::getHitRate() const
+{
+    QMutexLocker locker(&mutex);
+    quint64 nLookups = nHits + nMisses;
+    return nLookups > 0 ? static_cast<double>(nHits) / nLookups : 0.0;
+}
+
+QString ClassificationCache::statistics() const
+{
+    return "Classification cache: " + QString::number(getNHits()) + " hits, " + QString::number(getNMisses()) + " misses ("
+            + QString::number(100.0 * getHitRate(), 'f', 1) + " % hit rate), " + QString::number(getSize()) + " of " + QString::number(getCapacity()) + " entries";
+}
+
+QByteArray ClassificationCache::makeKey(const QByteArray &modelKey, const std::vector<double> &input)
+{
+    QByteArray key;
+    key.reserve(modelKey.size() + static_cast<int>(input.size() * sizeof(double)));
+    key.append(modelKey);
+    key.append(reinterpret_cast<const char*>(input.data()), static_cast<int>(input.size() * sizeof(double)));
+    return key;
+}
@@ -0,0 +1,37 @@
+#ifndef CLASSIFICATIONCACHE_H
+#define CLASSIFICATIONCACHE_H
+
+#include <QtCore>
+
+#include "annotation.h"
+
+class ClassificationCache
+{
+public:
+    explicit ClassificationCache(int capacity);
+
+    bool find(const QByteArray &modelKey, const std::vector<double> &input, Annotation &annotation);
+    void insert(const QByteArray &modelKey, const std::vector<double> &input, const Annotation &annotation);
+    void clear();
+
+    int getCapacity() const;
+    void setCapacity(int value);
+
+    int getSize() const;
+    quint64 getNHits() const;
+    quint64 getNMisses() const;
+    double getHitRate() const;
+
+    QString statistics() const;
+
+private:
+    mutable QMutex mutex;
+    QCache<QByteArray, Annotation> cache;   // least recently used entries are evicted first
+
+    quint64 nHits = 0;
+    quint64 nMisses = 0;
+
+    static QByteArray makeKey(const QByteArray &modelKey, const std::vector<double> &input);
+};
+
+#endif // CLASSIFICATIONCACHE_H
@@ -0,0 +1,117 @@
+#include "classificationworker.h"
+#include "funcwindowbuffer.h"
+
+/*!
+ * \class ClassificationWorker
+ * \brief Classifies a snapshot of the measurement data in the thread the worker was moved to.
+ * \a data contains the classifier inputs before the input function was applied: absolute or relative vectors, depending on the classifier.
+ * The func vectors of all inputs are computed once into a channel-major series. Classifiers with an input window get the overlapping windows
+ * of the series ending every window stride vectors; the annotation of a window is set at the timestamp of its latest vector.
+ * The inputs are classified in chunks of \a batchSize windows. Progress is reported after each chunk and cancel() stops after the current chunk.
+ * All annotations are passed at once by finished(), so they can be applied to the MeasurementData in one update.
+ * Vectors without a window ending at them get an empty annotation: detected annotations of a previous classification are cleared,
+ * so the result never mixes two classifiers.
+ * The classifier has to stay alive until the worker emitted finished(), cancelled() or error().
+ */
+ClassificationWorker::ClassificationWorker(Classifier *classifier, const QMap<uint, MVector> &data, const Functionalisation &functionalisation, const std::vector<bool> &sensorFailures, int batchSize, QObject *parent):
+    QObject(parent),
+    classifier(classifier),
+    data(data),
+    functionalisation(functionalisation),
+    sensorFailures(sensorFailures),
+    batchSize(batchSize)
+{
+    Q_ASSERT(classifier != nullptr);
+    Q_ASSERT("Invalid batch size!" && batchSize > 0);
+
+    qRegisterMetaType<QMap<uint, Annotation>>("QMap<uint, Annotation>");
+}
+
+/*!
+ * \brief ClassificationWorker::cancel requests to stop the classification. Can be called from any thread.
+ */
+void ClassificationWorker::cancel()
+{
+    cancelRequested = true;
+}
+
+bool ClassificationWorker::isCancelled() const
+{
+    return cancelRequested;
+}
+
+void ClassificationWorker::classify()
+{
+    QMap<uint, Annotation> annotations;
+    InputFunctionType inputFunctionType = classifier->getInputFunctionType();
+    int nChannels = classifier->getN();
+    int windowLength = classifier->getWindowLength();
+    int windowStride = classifier->getWindowStride();
+    bool windowSlopes = classifier->getWindowSlopes();
+    int inputWidth = classifier->getInputWidth();
+
+    // func series, channel-major
+    int nSteps = data.size();
+    QList<uint> timestamps = data.keys();
+    std::vector<double> series(static_cast<size_t>(nChannels) * static_cast<size_t>(nSteps));
+
+    int step = 0;
+    for (auto it = data.begin(); it != data.end(); ++it, ++step)
+    {
+        MVector funcVector = it.value().getFuncVector(functionalisation, sensorFailures, inputFunctionType);
+        if (static_cast<int>(funcVector.getSize()) != nChannels)
+        {
+            emit error("Input vector has wrong size.");
+            return;
+        }
+
+        for (int c=0; c<nChannels; c++)
+            series[static_cast<size_t>(c) * static_cast<size_t>(nSteps) + static_cast<size_t>(step)] = funcVector[c];
+    }
+
+    // no result of this classifier: clear the previous detected annotation
+    for (uint timestamp : timestamps)
+        annotations.insert(timestamp, Annotation());
+
+    // windows end every windowStride steps
+    std::vector<int> windowEnds;
+    for (int end=windowLength-1; end<nSteps; end+=windowStride)
+        windowEnds.push_back(end);
+
+    // input rows are reused by all chunks
+    std::vector<std::vector<double>> inputs;
+    inputs.reserve(static_cast<size_t>(batchSize));
+
+    size_t nClassified = 0;
+    while (nClassified < windowEnds.size())
+    {
+        if (cancelRequested)
+        {
+            emit cancelled();
+            return;
+        }
+
+        // prepare next chunk
+        size_t nRows = qMin(windowEnds.size() - nClassified, static_cast<size_t>(batchSize));
+        inputs.resize(nRows);
+        for (size_t row=0; row<nRows; row++)
+        {
+            inputs[row].resize(static_cast<size_t>(inputWidth));
+            FuncWindowBuffer::assemble(series.data(), nSteps, nChannels, windowEnds[nClassified + row], windowLength, windowSlopes, inputs[row].data());
+        }
+
+        try {
+            QList<Annotation> batchAnnotations = classifier->getAnnotations(inputs, batchSize);
+            for (size_t row=0; row<nRows; row++)
+                annotations[timestamps[windowEnds[nClassified + row]]] = batchAnnotations[static_cast<int>(row)];
+        } catch (std::invalid_argument& e) {
+            emit error(e.what());
+            return;
+        }
+
+        nClassified += nRows;
+        emit progressChanged(qRound(100.0 * nClassified / windowEnds.size()));
+    }
+
+    emit finished(annotations);
+}
@@ -0,0 +1,42 @@
+#ifndef CLASSIFICATIONWORKER_H
+#define CLASSIFICATIONWORKER_H
+
+#include <QObject>
+#include <QtCore>
+
+#include <atomic>
+
+#include "mvector.h"
+#include "functionalisation.h"
+#include "classifier.h"
+
+class ClassificationWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ClassificationWorker(Classifier *classifier, const QMap<uint, MVector> &data, const Functionalisation &functionalisation, const std::vector<bool> &sensorFailures, int batchSize, QObject *parent = nullptr);
+
+    void cancel();
+    bool isCancelled() const;
+
+public Q_SLOTS:
+    void classify();
+
+Q_SIGNALS:
+    void progressChanged(int value);    // in percent
+    void finished(QMap<uint, Annotation> annotations);
+    void cancelled();
+    void error(QString errorMessage);
+
+private:
+    Classifier *classifier;
+    QMap<uint, MVector> data;
+    Functionalisation functionalisation;
+    std::vector<bool> sensorFailures;
+    int batchSize;
+
+    std::atomic<bool> cancelRequested{false};
+};
+
+#endif // CLASSIFICATIONWORKER_H
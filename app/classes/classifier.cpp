@@ -0,0 +1,127 @@
+#include "classifier.h"
+
+/*!
+ * \brief Classifier::inputFunctionFromString returns the input function named \a functionString in the model attributes, \a defaultType if the name is unknown.
+ */
+InputFunctionType Classifier::inputFunctionFromString(QString functionString, InputFunctionType defaultType)
+{
+    if (functionString == "average")
+        return InputFunctionType::average;
+    if (functionString == "median_average")
+        return InputFunctionType::medianAverage;
+    if (functionString == "None")
+        return InputFunctionType::none;
+    return defaultType;
+}
+
+/*!
+ * \brief Classifier::outputFunctionFromString returns the output function named \a functionString in the model attributes, \a defaultType if the name is unknown.
+ */
+OutputFunctionType Classifier::outputFunctionFromString(QString functionString, OutputFunctionType defaultType)
+{
+    if (functionString == "logsoftmax")
+        return OutputFunctionType::logsoftmax;
+    if (functionString == "sigmoid")
+        return OutputFunctionType::sigmoid;
+    if (functionString == "None")
+        return OutputFunctionType::none;
+    return defaultType;
+}
+
+/*!
+ * \brief Classifier::computeNormalisation precomputes the normalisation (x - shift) * scale of the inputWidth inputs from the \a mean and \a stdev of the model.
+ * \a stdev not set: don't normalise, \a mean not set: zero mean.
+ * Per channel values (size N) apply to all steps of a window, slopes are only scaled.
+ */
+void Classifier::computeNormalisation(const std::vector<double> &mean, const std::vector<double> &stdev, int N, int windowLength, int inputWidth, std::vector<double> &shift, std::vector<double> &scale)
+{
+    shift.assign(static_cast<size_t>(inputWidth), 0.0);
+    scale.assign(static_cast<size_t>(inputWidth), 1.0);
+    if (stdev.empty())
+        return;
+
+    for (int i=0; i<inputWidth; i++)
+    {
+        bool isSlope = i >= N * windowLength;
+        int channel = isSlope ? i - N * windowLength : i / windowLength;
+
+        if (!mean.empty())
+            shift[i] = mean.size() == inputWidth ? mean[i] : isSlope ? 0.0 : mean[channel];
+        scale[i] = 1.0 / (stdev.size() == inputWidth ? stdev[i] : stdev[channel]);
+    }
+}
+
+/*!
+ * \brief Classifier::decodeAnnotation makes the predictions for one input based on the class \a probabilities, one per class in \a classNames.
+ */
+Annotation Classifier::decodeAnnotation(const float *probabilities, const QStringList &classNames, bool isMultiLabel, double threshold, bool isRegression)
+{
+    //                              //
+    // extract classes from tensor  //
+    //                              //
+    QSet<aClass> classSet;
+
+    const float* ptr = probabilities;
+    for (int i = 0; i < classNames.size(); ++i)
+        classSet << aClass(classNames[i], *ptr++);
+
+    //                                          //
+    // make predictions based on probabilities  //
+    //                                          //
+    QSet<aClass> predClasses;
+    // multi label classification:
+    if (isMultiLabel)
+    {
+        // apply threshold to get labels
+        for (aClass aclass : classSet)
+        {
+            if (aclass.getValue() > threshold)
+                predClasses << aClass(aclass);
+        }
+        // set prob of No Smell 1-maxProb
+        double maxProb = 0.;
+        for (aClass aclass : classSet)
+        {
+            if (aclass.getValue() > maxProb)
+                maxProb = aclass.getValue();
+        }
+        classSet << aClass(NO_SMELL_STRING, 1.-maxProb);
+
+        // set pred to No Smell if no label was detected
+        if (predClasses.isEmpty())
+            predClasses << aClass(NO_SMELL_STRING);
+    }
+    // multi-class classification:
+    // get class with highest probabillity
+    else
+    {
+        for (aClass aclass : classSet)
+            if (predClasses.isEmpty())
+                predClasses << aclass;
+            else if (aclass.getValue() > predClasses.begin()->getValue())
+            {
+                predClasses.clear();
+                predClasses << aClass(aclass);
+            }
+    }
+    // no regression:
+    // ignore value of predicted classes
+    if (!isRegression)
+    {
+        for (aClass aclass : predClasses)
+            aclass.setType(aClass::Type::CLASS_ONLY);
+    }
+
+    return Annotation(classSet, predClasses);
+}
+
+QString Classifier::Settings::toString() const
+{
+    QStringList settingList;
+    settingList << "frozen: " + QString(freeze || optimize ? "yes" : "no");
+    settingList << "optimised: " + QString(optimize ? "yes" : "no");
+    settingList << "warm-up runs: " + QString::number(nWarmupRuns);
+    settingList << "int8: " + quantization;
+
+    return settingList.join(", ");
+}
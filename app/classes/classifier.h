@@ -0,0 +1,82 @@
+#ifndef CLASSIFIER_H
+#define CLASSIFIER_H
+
+#include <QObject>
+#include <QtCore>
+
+#include <vector>
+
+#include "annotation.h"
+#include "classificationcache.h"
+
+#include "classifier_definitions.h"
+
+/*!
+ * \brief The Classifier class is the interface of the models annotating the measurement: a single TorchClassifier or MlpClassifier, or a ClassifierEnsemble.
+ * The inputs are windows of getWindowLength() func vectors assembled by FuncWindowBuffer, getInputWidth() values each.
+ * getAnnotation and getAnnotations can be called from several threads at the same time.
+ */
+class Classifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+     * \brief The Settings struct defines how a model is prepared for inference when it is loaded.
+     */
+    struct Settings{
+        bool freeze = true;         // TorchScript: inline parameters & attributes into the graph
+        bool optimize = false;      // TorchScript: optimize_for_inference after freezing
+        int nWarmupRuns = 3;        // inferences run after loading
+        QString quantization = "off";   // TorchScript: int8 Linear layers on the quantized backend "auto", "fbgemm" or "qnnpack"
+
+        QString toString() const;
+    };
+
+    explicit Classifier(QObject *parent = nullptr):
+        QObject(parent)
+    {}
+
+    virtual ~Classifier() {}
+
+    // useCache: look up & store the annotations in the cache set, false for inputs unlikely to recur such as live vectors
+    virtual Annotation getAnnotation (const std::vector<double> &input, bool useCache = true) = 0;
+
+    virtual QList<Annotation> getAnnotations (const std::vector<std::vector<double>> &inputs, int batchSize, bool useCache = true) = 0;
+
+    virtual QString getName() const = 0;
+
+    virtual QStringList getClassNames() const = 0;
+
+    virtual bool getIsInputAbsolute() const = 0;
+
+    virtual int getN() const = 0;
+
+    virtual int getInputWidth() const = 0;
+
+    virtual int getWindowLength() const = 0;
+
+    virtual int getWindowStride() const = 0;
+
+    virtual bool getWindowSlopes() const = 0;
+
+    virtual QString getPresetName() const = 0;
+
+    virtual InputFunctionType getInputFunctionType() const = 0;
+
+    virtual bool getIsMultiLabel() const = 0;
+
+    virtual double getThreshold() const = 0;
+
+    virtual void setCache(ClassificationCache *value) = 0;
+
+protected:
+    static InputFunctionType inputFunctionFromString(QString functionString, InputFunctionType defaultType);
+    static OutputFunctionType outputFunctionFromString(QString functionString, OutputFunctionType defaultType);
+
+    static void computeNormalisation(const std::vector<double> &mean, const std::vector<double> &stdev, int N, int windowLength, int inputWidth, std::vector<double> &shift, std::vector<double> &scale);
+
+    static Annotation decodeAnnotation(const float *probabilities, const QStringList &classNames, bool isMultiLabel, double threshold, bool isRegression);
+};
+
+#endif // CLASSIFIER_H
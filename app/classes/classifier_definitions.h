@@ -1,9 +1,9 @@
-#ifndef CLASSIFIER_H
-#define CLASSIFIER_H
+#ifndef CLASSIFIER_DEFINITIONS_H
+#define CLASSIFIER_DEFINITIONS_H
 
 #define NO_SMELL_STRING "No Smell"
 
 enum class InputFunctionType {average, medianAverage, none};
 enum class OutputFunctionType {logsoftmax, sigmoid, none};
 
-#endif // CLASSIFIER_H
+#endif // CLASSIFIER_DEFINITIONS_H
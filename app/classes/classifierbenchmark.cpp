@@ -0,0 +1,237 @@
+#include "classifierbenchmark.h"
+
+#ifdef TORCH_BACKEND
+#include "torchclassifier.h"
+#include <ATen/Parallel.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+int intraOpThreads()
+{
+#ifdef TORCH_BACKEND
+    return at::get_num_threads();
+#else
+    return 1;
+#endif
+}
+
+int interOpThreads()
+{
+#ifdef TORCH_BACKEND
+    return at::get_num_interop_threads();
+#else
+    return 1;
+#endif
+}
+
+void setIntraOpThreads(int threadCount)
+{
+#ifdef TORCH_BACKEND
+    TorchClassifier::setThreadCounts(threadCount, 0);
+#else
+    Q_UNUSED(threadCount)
+#endif
+}
+
+}
+
+/*!
+ * \class ClassifierBenchmark
+ * \brief Measures the latency and throughput of a classifier for the batch sizes and intra-op thread counts in \a settings.
+ * The thread counts apply to libtorch and don't change the built-in MLP backend, which runs in the calling thread.
+ * The inputs are func vectors recorded in a measurement (setInputs) or synthetic vectors (generateInputs).
+ * Each configuration classifies nIterations batches taken cyclically from the inputs after nWarmupIterations untimed batches.
+ * The result of run() is a JSON object, so results of different models, settings and versions can be compared over time.
+ * No classification cache should be set for \a classifier, otherwise repeated inputs are not classified.
+ */
+ClassifierBenchmark::ClassifierBenchmark(Classifier *classifier, Settings settings):
+    classifier(classifier),
+    settings(settings)
+{
+    Q_ASSERT(classifier != nullptr);
+}
+
+/*!
+ * \brief ClassifierBenchmark::setInputs sets the func vectors classified. \a source describes their origin in the results.
+ */
+void ClassifierBenchmark::setInputs(const std::vector<std::vector<double>> &value, QString source)
+{
+    inputs = value;
+    inputSource = source;
+}
+
+/*!
+ * \brief ClassifierBenchmark::generateInputs generates \a nVectors synthetic inputs with values uniformly distributed in [-10, 10].
+ */
+void ClassifierBenchmark::generateInputs(int nVectors, uint seed)
+{
+    inputs = syntheticInputs(nVectors, classifier->getInputWidth(), seed);
+    inputSource = "synthetic";
+}
+
+/*!
+ * \brief ClassifierBenchmark::syntheticInputs returns \a nVectors inputs of \a inputWidth values uniformly distributed in [-10, 10].
+ */
+std::vector<std::vector<double>> ClassifierBenchmark::syntheticInputs(int nVectors, int inputWidth, uint seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> distribution(-10.0, 10.0);
+
+    std::vector<std::vector<double>> syntheticInputs(static_cast<size_t>(nVectors), std::vector<double>(static_cast<size_t>(inputWidth)));
+    for (auto &input : syntheticInputs)
+        for (double &value : input)
+            value = distribution(generator);
+
+    return syntheticInputs;
+}
+
+/*!
+ * \brief ClassifierBenchmark::run runs all configurations and returns the results.
+ * Throws std::runtime_error if no inputs are set.
+ */
+QJsonObject ClassifierBenchmark::run()
+{
+    if (inputs.empty())
+        throw std::runtime_error("No inputs to benchmark the classifier!");
+
+    QJsonObject result;
+    result["model"] = classifier->getName();
+    result["version"] = QString(GIT_VERSION);
+    result["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    result["inputSource"] = inputSource;
+    result["nInputs"] = classifier->getN();
+    result["nVectors"] = static_cast<int>(inputs.size());
+    result["nIterations"] = settings.nIterations;
+    result["peakMemoryAfterLoadKB"] = peakMemory();
+
+    int defaultThreadCount = intraOpThreads();
+    result["defaultIntraOpThreads"] = defaultThreadCount;
+    result["interOpThreads"] = interOpThreads();
+
+    QJsonArray runs;
+    for (int threadCount : settings.threadCounts)
+        for (int batchSize : settings.batchSizes)
+            runs.append(runConfiguration(batchSize, threadCount > 0 ? threadCount : defaultThreadCount));
+    result["runs"] = runs;
+
+    setIntraOpThreads(defaultThreadCount);
+
+    result["peakMemoryKB"] = peakMemory();
+
+    return result;
+}
+
+QJsonObject ClassifierBenchmark::runConfiguration(int batchSize, int threadCount)
+{
+    setIntraOpThreads(threadCount);
+
+    // batches taken cyclically from the inputs
+    std::vector<std::vector<double>> batch(static_cast<size_t>(batchSize));
+    size_t position = 0;
+    auto nextBatch = [this, &batch, &position](){
+        for (auto &input : batch)
+        {
+            input = inputs[position];
+            position = (position + 1) % inputs.size();
+        }
+    };
+
+    for (int i=0; i<settings.nWarmupIterations; i++)
+    {
+        nextBatch();
+        classifier->getAnnotations(batch, batchSize);
+    }
+
+    std::vector<double> latencies;
+    latencies.reserve(static_cast<size_t>(settings.nIterations));
+    QElapsedTimer timer;
+    qint64 totalTime = 0;
+
+    for (int i=0; i<settings.nIterations; i++)
+    {
+        nextBatch();
+
+        timer.start();
+        classifier->getAnnotations(batch, batchSize);
+        qint64 latency = timer.nsecsElapsed();
+
+        totalTime += latency;
+        latencies.push_back(latency * 1e-6);
+    }
+
+    QJsonObject run;
+    run["batchSize"] = batchSize;
+    run["intraOpThreads"] = threadCount;
+    run["latencyMs"] = latencyStatistics(latencies);
+    run["vectorsPerSecond"] = totalTime > 0 ? 1e9 * batchSize * settings.nIterations / totalTime : 0.0;
+
+    qDebug().noquote() << "batch size" << batchSize << "threads" << threadCount << ": p50" << QString::number(run["latencyMs"].toObject()["p50"].toDouble(), 'f', 3) << "ms,"
+                       << QString::number(run["vectorsPerSecond"].toDouble(), 'f', 0) << "vectors/s";
+
+    return run;
+}
+
+/*!
+ * \brief ClassifierBenchmark::latencyStatistics returns mean, min, max and the percentiles p50, p95 and p99 of \a latencies.
+ * Percentiles are the nearest rank of the sorted latencies.
+ */
+QJsonObject ClassifierBenchmark::latencyStatistics(std::vector<double> latencies)
+{
+    QJsonObject statistics;
+    if (latencies.empty())
+        return statistics;
+
+    std::sort(latencies.begin(), latencies.end());
+
+    auto percentile = [&latencies](double p){
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * latencies.size()));
+        return latencies[qBound(static_cast<size_t>(1), rank, latencies.size()) - 1];
+    };
+
+    double sum = 0.0;
+    for (double latency : latencies)
+        sum += latency;
+
+    statistics["mean"] = sum / latencies.size();
+    statistics["min"] = latencies.front();
+    statistics["max"] = latencies.back();
+    statistics["p50"] = percentile(50);
+    statistics["p95"] = percentile(95);
+    statistics["p99"] = percentile(99);
+
+    return statistics;
+}
+
+/*!
+ * \brief ClassifierBenchmark::peakMemory returns the peak resident memory of the process in kB.
+ */
+qint64 ClassifierBenchmark::peakMemory()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<qint64>(counters.PeakWorkingSetSize / 1024);
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef Q_OS_MACOS
+    return static_cast<qint64>(usage.ru_maxrss / 1024);    // in bytes on macOS
+#else
+    return static_cast<qint64>(usage.ru_maxrss);
+#endif
+#endif
+}
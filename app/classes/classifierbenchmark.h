@@ -0,0 +1,40 @@
+#ifndef CLASSIFIERBENCHMARK_H
+#define CLASSIFIERBENCHMARK_H
+
+#include <QtCore>
+
+#include "classifier.h"
+
+class ClassifierBenchmark
+{
+public:
+    struct Settings{
+        QList<int> batchSizes{1, 8, 64, 256};
+        QList<int> threadCounts{0};     // libtorch intra-op threads, 0: libtorch default
+        int nIterations = 200;          // timed calls per batch size & thread count
+        int nWarmupIterations = 10;     // untimed calls before each run
+        int nSyntheticVectors = 1000;
+    };
+
+    explicit ClassifierBenchmark(Classifier *classifier, Settings settings = Settings());
+
+    void setInputs(const std::vector<std::vector<double>> &value, QString source);
+    void generateInputs(int nVectors, uint seed = 42);
+
+    QJsonObject run();
+
+    static qint64 peakMemory();
+    static std::vector<std::vector<double>> syntheticInputs(int nVectors, int inputWidth, uint seed = 42);
+
+private:
+    Classifier *classifier;
+    Settings settings;
+
+    std::vector<std::vector<double>> inputs;
+    QString inputSource;
+
+    QJsonObject runConfiguration(int batchSize, int threadCount);
+    static QJsonObject latencyStatistics(std::vector<double> latencies);
+};
+
+#endif // CLASSIFIERBENCHMARK_H
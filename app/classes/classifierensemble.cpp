@@ -0,0 +1,383 @@
+#include "classifierensemble.h"
+
+namespace {
+
+/*!
+ * \brief The ModelTask class classifies the inputs of one ensemble call with one model and releases \a done when finished.
+ */
+class ModelTask : public QRunnable
+{
+public:
+    ModelTask(Classifier *model, const std::vector<std::vector<double>> &inputs, int batchSize, bool useCache, QList<Annotation> &annotations, QString &error, qint64 &latency, QSemaphore &done):
+        model(model),
+        inputs(inputs),
+        batchSize(batchSize),
+        useCache(useCache),
+        annotations(annotations),
+        error(error),
+        latency(latency),
+        done(done)
+    {}
+
+    void run() override
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        try {
+            annotations = model->getAnnotations(inputs, batchSize, useCache);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+
+        latency = timer.nsecsElapsed();
+        done.release();
+    }
+
+private:
+    Classifier *model;
+    const std::vector<std::vector<double>> &inputs;
+    int batchSize;
+    bool useCache;
+    QList<Annotation> &annotations;
+    QString &error;
+    qint64 &latency;
+    QSemaphore &done;
+};
+
+}
+
+/*!
+ * \class ClassifierEnsemble
+ * \brief Runs several classifiers on the same inputs and merges their outputs into one annotation per input.
+ * The models run concurrently: the first one in the calling thread, the others in a thread pool shared by all ensembles.
+ * All models get the same batch of inputs, so they have to share the input size, input type, input function and input window.
+ *
+ * The class probabilities are merged by \a mergeRule over the models providing the class, so specialists for single smells
+ * can be combined with a generalist. The ensemble is multi-label if one of its models is, using the mean threshold of these models.
+ *
+ * Takes ownership of \a models. Throws std::invalid_argument if \a models is empty or incompatible; the models are not owned in that case.
+ */
+ClassifierEnsemble::ClassifierEnsemble(QObject *parent, QList<Classifier *> models, MergeRule mergeRule):
+    Classifier(parent),
+    models(models),
+    mergeRule(mergeRule)
+{
+    if (models.isEmpty())
+        throw std::invalid_argument("Classifier ensemble contains no models.");
+
+    Classifier *first = models.first();
+    double thresholdSum = 0.0;
+    int nMultiLabel = 0;
+    for (Classifier *model : models)
+    {
+        if (model->getN() != first->getN() || model->getIsInputAbsolute() != first->getIsInputAbsolute() || model->getInputFunctionType() != first->getInputFunctionType())
+            throw std::invalid_argument("Inputs of " + model->getName().toStdString() + " and " + first->getName().toStdString() + " differ: the models of an ensemble need the same input size, input type and input function.");
+        if (model->getWindowLength() != first->getWindowLength() || model->getWindowStride() != first->getWindowStride() || model->getWindowSlopes() != first->getWindowSlopes())
+            throw std::invalid_argument("Input windows of " + model->getName().toStdString() + " and " + first->getName().toStdString() + " differ: the models of an ensemble need the same window length, stride and slopes.");
+
+        for (const QString &className : model->getClassNames())
+            if (!classNames.contains(className))
+                classNames << className;
+
+        if (model->getIsMultiLabel())
+        {
+            thresholdSum += model->getThreshold();
+            nMultiLabel++;
+        }
+    }
+
+    isMultiLabel = nMultiLabel > 0;
+    if (isMultiLabel)
+        threshold = thresholdSum / nMultiLabel;
+
+    for (Classifier *model : models)
+        model->setParent(this);
+
+    modelLatencySum.assign(static_cast<size_t>(models.size()), 0);
+    modelLatencyMax.assign(static_cast<size_t>(models.size()), 0);
+}
+
+/*!
+ * \brief ClassifierEnsemble::modelPool returns the thread pool running the models of all ensembles but the first one of each call.
+ * It has one thread per core, so ensembles classifying at the same time (live and measurement classification) do not oversubscribe the cores
+ * beyond the intra-op threads of their models. getAnnotations waits for its tasks, so none are left when an ensemble is deleted.
+ */
+QThreadPool *ClassifierEnsemble::modelPool()
+{
+    static QThreadPool pool;
+    return &pool;
+}
+
+/*!
+ * \brief ClassifierEnsemble::getAnnotation classifies \a input with all models. Throws std::invalid_argument if a model fails.
+ */
+Annotation ClassifierEnsemble::getAnnotation(const std::vector<double> &input, bool useCache)
+{
+    return getAnnotations(std::vector<std::vector<double>>{input}, 1, useCache).first();
+}
+
+/*!
+ * \brief ClassifierEnsemble::getAnnotations classifies all \a inputs with all models in parallel and merges the results.
+ * Each model packs the inputs into batches of up to \a batchSize rows. Throws std::invalid_argument if a model fails.
+ */
+QList<Annotation> ClassifierEnsemble::getAnnotations(const std::vector<std::vector<double>> &inputs, int batchSize, bool useCache)
+{
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+
+    size_t nModels = static_cast<size_t>(models.size());
+    std::vector<QList<Annotation>> modelAnnotations(nModels);
+    std::vector<QString> errors(nModels);
+    std::vector<qint64> latencies(nModels, 0);
+    QSemaphore done;
+
+    for (size_t i=1; i<nModels; i++)
+        modelPool()->start(new ModelTask(models[static_cast<int>(i)], inputs, batchSize, useCache, modelAnnotations[i], errors[i], latencies[i], done));
+
+    ModelTask firstTask(models.first(), inputs, batchSize, useCache, modelAnnotations[0], errors[0], latencies[0], done);
+    firstTask.run();
+
+    done.acquire(static_cast<int>(nModels));
+
+    for (size_t i=0; i<nModels; i++)
+        if (!errors[i].isEmpty())
+            throw std::invalid_argument(models[static_cast<int>(i)]->getName().toStdString() + ": " + errors[i].toStdString());
+
+    QList<Annotation> annotations;
+    annotations.reserve(static_cast<int>(inputs.size()));
+    for (int i=0; i<static_cast<int>(inputs.size()); i++)
+        annotations << merge(modelAnnotations, i);
+
+    addLatencies(latencies, totalTimer.nsecsElapsed());
+
+    return annotations;
+}
+
+/*!
+ * \brief ClassifierEnsemble::merge merges the annotations of all models for the input at \a index.
+ */
+Annotation ClassifierEnsemble::merge(const std::vector<QList<Annotation>> &modelAnnotations, int index) const
+{
+    QHash<QString, double> probSum, probMax;
+    QHash<QString, int> nProviding, nVotes;
+
+    for (size_t i=0; i<modelAnnotations.size(); i++)
+    {
+        const Annotation &annotation = modelAnnotations[i][index];
+        bool modelIsMultiLabel = models[static_cast<int>(i)]->getIsMultiLabel();
+
+        for (const aClass &aclass : annotation.getClasses())
+        {
+            // no smell probability of multi-label models is recalculated for the ensemble
+            QString className = aclass.getName();
+            if (modelIsMultiLabel && className == NO_SMELL_STRING)
+                continue;
+
+            double value = aclass.getValue();
+            probSum[className] += value;
+            probMax[className] = nProviding.contains(className) ? qMax(probMax[className], value) : value;
+            nProviding[className]++;
+        }
+
+        for (const aClass &aclass : annotation.getPredClasses())
+            nVotes[aclass.getName()]++;
+    }
+
+    QSet<aClass> classSet, predClasses;
+    QString bestClass;
+    double bestValue = 0.0;
+
+    for (const QString &className : classNames)
+    {
+        if (!nProviding.contains(className))
+            continue;
+
+        double value = mergeRule == MergeRule::Max ? probMax[className] : probSum[className] / nProviding[className];
+        classSet << aClass(className, value);
+
+        if (bestClass.isEmpty() || value > bestValue)
+        {
+            bestClass = className;
+            bestValue = value;
+        }
+
+        if (mergeRule == MergeRule::Vote ? 2 * nVotes.value(className) > nProviding[className] : isMultiLabel && value > threshold)
+            predClasses << aClass(className, value);
+    }
+
+    if (isMultiLabel)
+    {
+        classSet << aClass(NO_SMELL_STRING, 1. - bestValue);
+
+        if (predClasses.isEmpty())
+            predClasses << aClass(NO_SMELL_STRING);
+    }
+    // single label: class with the highest probability if no majority was found
+    else if (predClasses.isEmpty() && !bestClass.isEmpty())
+    {
+        predClasses << aClass(bestClass, bestValue);
+    }
+
+    return Annotation(classSet, predClasses);
+}
+
+void ClassifierEnsemble::addLatencies(const std::vector<qint64> &modelLatencies, qint64 totalLatency)
+{
+    QMutexLocker locker(&statisticsMutex);
+
+    nCalls++;
+    for (size_t i=0; i<modelLatencies.size(); i++)
+    {
+        modelLatencySum[i] += modelLatencies[i];
+        modelLatencyMax[i] = qMax(modelLatencyMax[i], modelLatencies[i]);
+    }
+    totalLatencySum += totalLatency;
+    totalLatencyMax = qMax(totalLatencyMax, totalLatency);
+}
+
+QString ClassifierEnsemble::getName() const
+{
+    QStringList names;
+    for (Classifier *model : models)
+        names << model->getName();
+
+    return "Ensemble (" + names.join(", ") + ")";
+}
+
+QStringList ClassifierEnsemble::getClassNames() const
+{
+    return classNames;
+}
+
+bool ClassifierEnsemble::getIsInputAbsolute() const
+{
+    return models.first()->getIsInputAbsolute();
+}
+
+int ClassifierEnsemble::getN() const
+{
+    return models.first()->getN();
+}
+
+int ClassifierEnsemble::getInputWidth() const
+{
+    return models.first()->getInputWidth();
+}
+
+int ClassifierEnsemble::getWindowLength() const
+{
+    return models.first()->getWindowLength();
+}
+
+int ClassifierEnsemble::getWindowStride() const
+{
+    return models.first()->getWindowStride();
+}
+
+bool ClassifierEnsemble::getWindowSlopes() const
+{
+    return models.first()->getWindowSlopes();
+}
+
+QString ClassifierEnsemble::getPresetName() const
+{
+    return models.first()->getPresetName();
+}
+
+InputFunctionType ClassifierEnsemble::getInputFunctionType() const
+{
+    return models.first()->getInputFunctionType();
+}
+
+bool ClassifierEnsemble::getIsMultiLabel() const
+{
+    return isMultiLabel;
+}
+
+double ClassifierEnsemble::getThreshold() const
+{
+    return threshold;
+}
+
+/*!
+ * \brief ClassifierEnsemble::setCache sets the cache of all models. Each model caches its own outputs, the merge is not cached.
+ */
+void ClassifierEnsemble::setCache(ClassificationCache *value)
+{
+    for (Classifier *model : models)
+        model->setCache(value);
+}
+
+QList<Classifier *> ClassifierEnsemble::getModels() const
+{
+    return models;
+}
+
+ClassifierEnsemble::MergeRule ClassifierEnsemble::getMergeRule() const
+{
+    return mergeRule;
+}
+
+/*!
+ * \brief ClassifierEnsemble::getMeanLatency returns the mean time in ms the model at \a modelIndex needed per call of getAnnotations.
+ */
+double ClassifierEnsemble::getMeanLatency(int modelIndex) const
+{
+    QMutexLocker locker(&statisticsMutex);
+    return nCalls > 0 ? modelLatencySum[static_cast<size_t>(modelIndex)] * 1e-6 / nCalls : 0.0;
+}
+
+double ClassifierEnsemble::getMaxLatency(int modelIndex) const
+{
+    QMutexLocker locker(&statisticsMutex);
+    return modelLatencyMax[static_cast<size_t>(modelIndex)] * 1e-6;
+}
+
+/*!
+ * \brief ClassifierEnsemble::getMeanTotalLatency returns the mean time in ms per call of getAnnotations, including the merge.
+ */
+double ClassifierEnsemble::getMeanTotalLatency() const
+{
+    QMutexLocker locker(&statisticsMutex);
+    return nCalls > 0 ? totalLatencySum * 1e-6 / nCalls : 0.0;
+}
+
+double ClassifierEnsemble::getMaxTotalLatency() const
+{
+    QMutexLocker locker(&statisticsMutex);
+    return totalLatencyMax * 1e-6;
+}
+
+QString ClassifierEnsemble::statistics() const
+{
+    QStringList lines;
+    lines << "Ensemble classification (" + mergeRuleToString(mergeRule) + "): total latency: " + QString::number(getMeanTotalLatency(), 'f', 2) + " ms (max " + QString::number(getMaxTotalLatency(), 'f', 2) + " ms)";
+
+    for (int i=0; i<models.size(); i++)
+        lines << "\t" + models[i]->getName() + ": " + QString::number(getMeanLatency(i), 'f', 2) + " ms (max " + QString::number(getMaxLatency(i), 'f', 2) + " ms)";
+
+    return lines.join("\n");
+}
+
+QString ClassifierEnsemble::mergeRuleToString(ClassifierEnsemble::MergeRule rule)
+{
+    switch (rule)
+    {
+    case MergeRule::Max:
+        return "max";
+    case MergeRule::Vote:
+        return "vote";
+    default:
+        return "mean";
+    }
+}
+
+ClassifierEnsemble::MergeRule ClassifierEnsemble::mergeRuleFromString(QString ruleString)
+{
+    if (ruleString == "max")
+        return MergeRule::Max;
+    if (ruleString == "vote")
+        return MergeRule::Vote;
+    return MergeRule::Mean;
+}
@@ -0,0 +1,86 @@
+#ifndef CLASSIFIERENSEMBLE_H
+#define CLASSIFIERENSEMBLE_H
+
+#include <QObject>
+#include <QtCore>
+
+#include "classifier.h"
+
+class ClassifierEnsemble : public Classifier
+{
+    Q_OBJECT
+
+public:
+    enum class MergeRule {
+        Mean,   // mean probability of the models providing a class
+        Max,    // max probability of the models providing a class
+        Vote    // majority vote of the predictions of the models providing a class
+    };
+
+    explicit ClassifierEnsemble(QObject *parent, QList<Classifier*> models, MergeRule mergeRule = MergeRule::Mean);
+
+    Annotation getAnnotation (const std::vector<double> &input, bool useCache = true) override;
+
+    QList<Annotation> getAnnotations (const std::vector<std::vector<double>> &inputs, int batchSize, bool useCache = true) override;
+
+    QString getName() const override;
+
+    QStringList getClassNames() const override;
+
+    bool getIsInputAbsolute() const override;
+
+    int getN() const override;
+
+    int getInputWidth() const override;
+
+    int getWindowLength() const override;
+
+    int getWindowStride() const override;
+
+    bool getWindowSlopes() const override;
+
+    QString getPresetName() const override;
+
+    InputFunctionType getInputFunctionType() const override;
+
+    bool getIsMultiLabel() const override;
+
+    double getThreshold() const override;
+
+    void setCache(ClassificationCache *value) override;
+
+    QList<Classifier*> getModels() const;
+
+    MergeRule getMergeRule() const;
+
+    double getMeanLatency(int modelIndex) const;
+    double getMaxLatency(int modelIndex) const;
+    double getMeanTotalLatency() const;
+    double getMaxTotalLatency() const;
+
+    QString statistics() const;
+
+    static QString mergeRuleToString(MergeRule rule);
+    static MergeRule mergeRuleFromString(QString ruleString);
+
+private:
+    QList<Classifier*> models;
+    MergeRule mergeRule;
+    QStringList classNames;     // union of the class names of all models
+    bool isMultiLabel = false;
+    double threshold = 0.3;
+
+    static QThreadPool *modelPool();
+
+    // latency statistics, in ns
+    mutable QMutex statisticsMutex;
+    quint64 nCalls = 0;
+    std::vector<qint64> modelLatencySum, modelLatencyMax;
+    qint64 totalLatencySum = 0;
+    qint64 totalLatencyMax = 0;
+
+    Annotation merge (const std::vector<QList<Annotation>> &modelAnnotations, int index) const;
+    void addLatencies (const std::vector<qint64> &modelLatencies, qint64 totalLatency);
+};
+
+#endif // CLASSIFIERENSEMBLE_H
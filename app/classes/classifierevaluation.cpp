@@ -0,0 +1,624 @@
+#include "classifierevaluation.h"
+#include "funcwindowbuffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iterator>
+#include <memory>
+
+namespace {
+
+/*!
+ * \brief The FileResult struct holds the windows of one measurement file: their user annotations, annotated intervals and predictions.
+ */
+struct FileResult{
+    QString filename;
+    QList<Annotation> labels;           // user annotation of the latest vector of each window
+    std::vector<int> intervals;         // annotated interval of the latest vector of each window, -1: not annotated
+    int nIntervals = 0;
+    std::vector<Annotation> predictions;
+    double readTime = 0.0;              // in ms
+    std::atomic<qint64> inferenceTime{0};   // in ns, summed over all batches
+    QList<aClass> classes;              // declared in the file, registered after all files were read
+
+    void setError(QString value)
+    {
+        QMutexLocker locker(&errorMutex);
+        if (error.isEmpty())
+            error = value;
+    }
+
+    QString getError()
+    {
+        QMutexLocker locker(&errorMutex);
+        return error;
+    }
+
+private:
+    QMutex errorMutex;
+    QString error;
+};
+
+/*!
+ * \brief The Batch struct is a chunk of consecutive windows of one file, starting at window \a offset.
+ */
+struct Batch{
+    FileResult *file = nullptr;
+    size_t offset = 0;
+    std::vector<std::vector<double>> inputs;
+};
+
+/*!
+ * \brief The BatchQueue class passes the batches from the readers to the inference threads.
+ * push() blocks while \a capacity batches are queued, so the readers can't run ahead of the inference by more than that.
+ */
+class BatchQueue
+{
+public:
+    explicit BatchQueue(size_t capacity):
+        capacity(capacity)
+    {}
+
+    void push(Batch batch)
+    {
+        QMutexLocker locker(&mutex);
+        while (batches.size() >= capacity)
+            notFull.wait(&mutex);
+
+        batches.push_back(std::move(batch));
+        notEmpty.wakeOne();
+    }
+
+    /*!
+     * \brief pop takes the next batch. Blocks until a batch is available, returns false if the queue was closed and is empty.
+     */
+    bool pop(Batch &batch)
+    {
+        QMutexLocker locker(&mutex);
+        while (batches.empty() && !closed)
+            notEmpty.wait(&mutex);
+
+        if (batches.empty())
+            return false;
+
+        batch = std::move(batches.front());
+        batches.pop_front();
+        notFull.wakeOne();
+        return true;
+    }
+
+    // no batches are pushed after close()
+    void close()
+    {
+        QMutexLocker locker(&mutex);
+        closed = true;
+        notEmpty.wakeAll();
+    }
+
+private:
+    size_t capacity;
+    std::deque<Batch> batches;
+    bool closed = false;
+
+    QMutex mutex;
+    QWaitCondition notFull, notEmpty;
+};
+
+/*!
+ * \brief The ReaderTask class parses one measurement file, assembles the windows of the classifier and queues them in batches.
+ * The file parsers use the global channel count MVector::nChannels: the task reading the first file sets it,
+ * files with another channel count are rejected by their reader after the header, before any values are parsed.
+ * The classes declared in the file are collected, not added to the unsynchronised global class set.
+ */
+class ReaderTask : public QRunnable
+{
+public:
+    ReaderTask(Classifier *classifier, FileResult *file, BatchQueue &queue, int batchSize, bool setsChannelCount):
+        classifier(classifier),
+        file(file),
+        queue(queue),
+        batchSize(static_cast<size_t>(batchSize)),
+        setsChannelCount(setsChannelCount)
+    {}
+
+    void run() override
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        std::vector<std::vector<double>> inputs;
+        try {
+            FileReader generalReader(file->filename);
+            std::unique_ptr<FileReader> reader(generalReader.getSpecificReader());
+
+            if (setsChannelCount)
+                QObject::connect(reader.get(), &FileReader::resetNChannels, [](uint value){
+                    MVector::nChannels = value;
+                });
+            else
+                reader->setExpectedNChannels(static_cast<uint>(MVector::nChannels));
+            reader->setRegisterClasses(false);
+            reader->readFile();
+            file->classes = reader->getClasses();
+
+            MeasurementData *data = reader->getMeasurementData();
+            int nFuncs = data->getFunctionalisation().getFuncMap(data->getSensorFailures()).size();
+            if (nFuncs != classifier->getN())
+                throw std::runtime_error("Functionalisation has " + std::to_string(nFuncs) + " channels, the classifier takes " + std::to_string(classifier->getN()) + ".");
+
+            QList<uint> timestamps;
+            inputs = ClassifierEvaluation::measurementInputs(classifier, data, &file->labels, &timestamps);
+
+            // annotated intervals: runs of consecutive vectors with the same user annotation
+            QHash<uint, int> intervalOf;
+            Annotation previous;
+            for (auto it = data->getAbsoluteData().begin(); it != data->getAbsoluteData().end(); ++it)
+            {
+                const Annotation &annotation = it.value().userAnnotation;
+                if (!annotation.isEmpty())
+                {
+                    if (previous.isEmpty() || annotation != previous)
+                        file->nIntervals++;
+                    intervalOf[it.key()] = file->nIntervals - 1;
+                }
+                previous = annotation;
+            }
+            for (uint timestamp : timestamps)
+                file->intervals.push_back(intervalOf.value(timestamp, -1));
+        } catch (const std::exception &e) {
+            file->setError(e.what());
+        }
+
+        file->predictions.resize(inputs.size());
+        file->readTime = timer.nsecsElapsed() * 1e-6;
+
+        for (size_t offset=0; offset<inputs.size(); offset+=batchSize)
+        {
+            Batch batch;
+            batch.file = file;
+            batch.offset = offset;
+            batch.inputs.assign(std::make_move_iterator(inputs.begin() + static_cast<long>(offset)),
+                                std::make_move_iterator(inputs.begin() + static_cast<long>(qMin(inputs.size(), offset + batchSize))));
+            queue.push(std::move(batch));
+        }
+    }
+
+private:
+    Classifier *classifier;
+    FileResult *file;
+    BatchQueue &queue;
+    size_t batchSize;
+    bool setsChannelCount;
+};
+
+/*!
+ * \brief The InferenceTask class classifies batches of the queue until it is closed and empty.
+ */
+class InferenceTask : public QRunnable
+{
+public:
+    InferenceTask(Classifier *classifier, BatchQueue &queue, int batchSize):
+        classifier(classifier),
+        queue(queue),
+        batchSize(batchSize)
+    {}
+
+    void run() override
+    {
+        Batch batch;
+        while (queue.pop(batch))
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            try {
+                QList<Annotation> annotations = classifier->getAnnotations(batch.inputs, batchSize);
+                for (int i=0; i<annotations.size(); i++)
+                    batch.file->predictions[batch.offset + static_cast<size_t>(i)] = annotations[i];
+            } catch (const std::exception &e) {
+                batch.file->setError(e.what());
+            }
+
+            batch.file->inferenceTime += timer.nsecsElapsed();
+        }
+    }
+
+private:
+    Classifier *classifier;
+    BatchQueue &queue;
+    int batchSize;
+};
+
+/*!
+ * \brief The ClassMetrics class counts the predictions of annotated samples: exact matches, the confusion of annotated & predicted classes
+ * and true positives, false positives and false negatives per class.
+ * For multi-label samples each annotated class is counted with each predicted class in the confusion matrix.
+ */
+class ClassMetrics
+{
+public:
+    explicit ClassMetrics(const QStringList &classNames):
+        classNames(classNames)
+    {}
+
+    void add(const QStringList &truth, const QStringList &prediction)
+    {
+        nSamples++;
+        if (truth == prediction)
+            nCorrect++;
+
+        for (const QString &name : truth)
+        {
+            addClass(name);
+            for (const QString &predicted : prediction)
+                confusion[name][predicted]++;
+
+            if (prediction.contains(name))
+                truePositives[name]++;
+            else
+                falseNegatives[name]++;
+        }
+        for (const QString &predicted : prediction)
+        {
+            addClass(predicted);
+            if (!truth.contains(predicted))
+                falsePositives[predicted]++;
+        }
+    }
+
+    int getNSamples() const
+    {
+        return nSamples;
+    }
+
+    double getAccuracy() const
+    {
+        return nSamples > 0 ? static_cast<double>(nCorrect) / nSamples : 0.0;
+    }
+
+    /*!
+     * \brief toJson returns the accuracy, the confusion matrix (rows: annotated class, columns: predicted class) and precision, recall & f1 per class.
+     * The macro averages are taken over the classes annotated at least once.
+     */
+    QJsonObject toJson() const
+    {
+        QJsonObject result;
+        result["nSamples"] = nSamples;
+        result["accuracy"] = getAccuracy();
+
+        QJsonArray classes, matrix;
+        for (const QString &row : classNames)
+        {
+            classes.append(row);
+
+            QJsonArray counts;
+            for (const QString &column : classNames)
+                counts.append(confusion.value(row).value(column));
+            matrix.append(counts);
+        }
+        result["classes"] = classes;
+        result["confusionMatrix"] = matrix;
+
+        QJsonObject perClass;
+        double precisionSum = 0.0, recallSum = 0.0, f1Sum = 0.0;
+        int nAnnotatedClasses = 0;
+        for (const QString &name : classNames)
+        {
+            int tp = truePositives.value(name);
+            int fp = falsePositives.value(name);
+            int fn = falseNegatives.value(name);
+
+            double precision = tp + fp > 0 ? static_cast<double>(tp) / (tp + fp) : 0.0;
+            double recall = tp + fn > 0 ? static_cast<double>(tp) / (tp + fn) : 0.0;
+            double f1 = precision + recall > 0.0 ? 2 * precision * recall / (precision + recall) : 0.0;
+
+            QJsonObject metrics;
+            metrics["precision"] = precision;
+            metrics["recall"] = recall;
+            metrics["f1"] = f1;
+            metrics["support"] = tp + fn;
+            perClass[name] = metrics;
+
+            if (tp + fn > 0)
+            {
+                precisionSum += precision;
+                recallSum += recall;
+                f1Sum += f1;
+                nAnnotatedClasses++;
+            }
+        }
+        result["perClass"] = perClass;
+        result["macroPrecision"] = nAnnotatedClasses > 0 ? precisionSum / nAnnotatedClasses : 0.0;
+        result["macroRecall"] = nAnnotatedClasses > 0 ? recallSum / nAnnotatedClasses : 0.0;
+        result["macroF1"] = nAnnotatedClasses > 0 ? f1Sum / nAnnotatedClasses : 0.0;
+
+        return result;
+    }
+
+private:
+    QStringList classNames;     // classes of the classifier, followed by classes only found in the samples
+    QHash<QString, QHash<QString, int>> confusion;
+    QHash<QString, int> truePositives, falsePositives, falseNegatives;
+    int nSamples = 0;
+    int nCorrect = 0;
+
+    void addClass(const QString &name)
+    {
+        if (!classNames.contains(name))
+            classNames << name;
+    }
+};
+
+}
+
+/*!
+ * \class ClassifierEvaluation
+ * \brief Evaluates a classifier on many measurement files: the detected annotations are compared with the user annotations
+ * per window and per annotated interval, the run of consecutive vectors with the same user annotation.
+ * A window is labelled with the user annotation of its latest vector, an interval is predicted by the most frequent prediction of its windows.
+ *
+ * Reading and inference are pipelined: \a settings.nReaders threads parse the files and queue their windows in batches of \a settings.batchSize,
+ * while the inference threads classify the queued batches of all files. The classifier has to support concurrent calls of getAnnotations().
+ * TorchScript classifiers parallelise each call as well, so their intra-op threads should be reduced when many inference threads are used.
+ */
+ClassifierEvaluation::ClassifierEvaluation(Classifier *classifier, Settings settings):
+    classifier(classifier),
+    settings(settings)
+{
+    Q_ASSERT(classifier != nullptr);
+    Q_ASSERT("Invalid batch size!" && settings.batchSize > 0);
+}
+
+/*!
+ * \brief ClassifierEvaluation::run evaluates the classifier on \a filenames and returns the results:
+ * accuracy, confusion matrix and per-class precision & recall of the windows and intervals, timings and a summary per file.
+ * Files that can't be read or classified are reported with their error and excluded from the metrics.
+ */
+QJsonObject ClassifierEvaluation::run(const QStringList &filenames)
+{
+    QElapsedTimer wallTimer;
+    wallTimer.start();
+
+    int nInferenceThreads = inferenceThreadCount();
+    int nReaders = qMax(1, settings.nReaders);
+    BatchQueue queue(static_cast<size_t>(settings.queueCapacity > 0 ? settings.queueCapacity : 4 * nInferenceThreads));
+
+    std::vector<FileResult> files(static_cast<size_t>(filenames.size()));
+    for (int i=0; i<filenames.size(); i++)
+        files[static_cast<size_t>(i)].filename = filenames[i];
+
+    QThreadPool inferencePool, readerPool;
+    inferencePool.setMaxThreadCount(nInferenceThreads);
+    readerPool.setMaxThreadCount(nReaders);
+
+    for (int i=0; i<nInferenceThreads; i++)
+        inferencePool.start(new InferenceTask(classifier, queue, settings.batchSize));
+
+    // the first file sets the channel count of the parsers before the others are read in parallel
+    if (!files.empty())
+    {
+        ReaderTask firstTask(classifier, &files.front(), queue, settings.batchSize, true);
+        firstTask.run();
+    }
+    for (size_t i=1; i<files.size(); i++)
+        readerPool.start(new ReaderTask(classifier, &files[i], queue, settings.batchSize, false));
+
+    readerPool.waitForDone();
+    queue.close();
+    inferencePool.waitForDone();
+
+    // classes of the files, registered in the calling thread
+    for (const FileResult &file : files)
+        for (const aClass &fileClass : file.classes)
+            if (!aClass::staticClassSet.contains(fileClass))
+                aClass::staticClassSet << fileClass;
+
+    double wallTime = wallTimer.nsecsElapsed() * 1e-6;
+
+    // metrics
+    ClassMetrics vectorMetrics(classifier->getClassNames());
+    ClassMetrics intervalMetrics(classifier->getClassNames());
+    QJsonArray fileReports;
+    int nFailed = 0, nWindows = 0, nIntervals = 0, nUnclassifiedIntervals = 0;
+    double readTime = 0.0, inferenceTime = 0.0;
+
+    for (FileResult &file : files)
+    {
+        QJsonObject report;
+        report["file"] = file.filename;
+        report["readTimeMs"] = file.readTime;
+        report["inferenceTimeMs"] = file.inferenceTime * 1e-6;
+        readTime += file.readTime;
+        inferenceTime += file.inferenceTime * 1e-6;
+
+        QString error = file.getError();
+        if (!error.isEmpty())
+        {
+            qWarning().noquote() << "Evaluation of" << file.filename << "failed:" << error;
+            report["error"] = error;
+            fileReports.append(report);
+            nFailed++;
+            continue;
+        }
+
+        ClassMetrics fileVectorMetrics(classifier->getClassNames());
+        ClassMetrics fileIntervalMetrics(classifier->getClassNames());
+
+        // votes of the windows of each interval
+        std::vector<QStringList> intervalLabels(static_cast<size_t>(file.nIntervals));
+        std::vector<QList<QPair<QStringList, int>>> intervalVotes(static_cast<size_t>(file.nIntervals));
+
+        for (size_t i=0; i<file.predictions.size(); i++)
+        {
+            if (file.labels[static_cast<int>(i)].isEmpty())
+                continue;
+
+            QStringList truth = labelNames(file.labels[static_cast<int>(i)]);
+            QStringList prediction = predictionNames(file.predictions[i]);
+            vectorMetrics.add(truth, prediction);
+            fileVectorMetrics.add(truth, prediction);
+
+            int interval = file.intervals[i];
+            if (interval < 0)
+                continue;
+
+            auto &votes = intervalVotes[static_cast<size_t>(interval)];
+            auto vote = std::find_if(votes.begin(), votes.end(), [&prediction](const QPair<QStringList, int> &v){ return v.first == prediction; });
+            if (vote == votes.end())
+                votes << qMakePair(prediction, 1);
+            else
+                vote->second++;
+            intervalLabels[static_cast<size_t>(interval)] = truth;
+        }
+
+        // ties: the prediction seen first in the interval
+        for (size_t interval=0; interval<intervalVotes.size(); interval++)
+        {
+            const auto &votes = intervalVotes[interval];
+            if (votes.isEmpty())
+            {
+                nUnclassifiedIntervals++;
+                continue;
+            }
+
+            auto best = std::max_element(votes.begin(), votes.end(), [](const QPair<QStringList, int> &a, const QPair<QStringList, int> &b){ return a.second < b.second; });
+            intervalMetrics.add(intervalLabels[interval], best->first);
+            fileIntervalMetrics.add(intervalLabels[interval], best->first);
+        }
+
+        report["nWindows"] = static_cast<int>(file.predictions.size());
+        report["nLabelled"] = fileVectorMetrics.getNSamples();
+        report["vectorAccuracy"] = fileVectorMetrics.getAccuracy();
+        report["nIntervals"] = file.nIntervals;
+        report["intervalAccuracy"] = fileIntervalMetrics.getAccuracy();
+        fileReports.append(report);
+
+        nWindows += static_cast<int>(file.predictions.size());
+        nIntervals += file.nIntervals;
+    }
+
+    QJsonObject perInterval = intervalMetrics.toJson();
+    perInterval["nIntervals"] = nIntervals;
+    perInterval["nUnclassified"] = nUnclassifiedIntervals;
+
+    QJsonObject result;
+    result["model"] = classifier->getName();
+    result["version"] = QString(GIT_VERSION);
+    result["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    result["nFiles"] = filenames.size();
+    result["nFilesFailed"] = nFailed;
+    result["nWindows"] = nWindows;
+    result["batchSize"] = settings.batchSize;
+    result["nReaders"] = nReaders;
+    result["nInferenceThreads"] = nInferenceThreads;
+    result["wallTimeMs"] = wallTime;
+    result["readTimeMs"] = readTime;
+    result["inferenceTimeMs"] = inferenceTime;
+    result["windowsPerSecond"] = wallTime > 0.0 ? 1e3 * nWindows / wallTime : 0.0;
+    result["perVector"] = vectorMetrics.toJson();
+    result["perInterval"] = perInterval;
+    result["files"] = fileReports;
+
+    qDebug().noquote() << "Evaluated" << filenames.size() - nFailed << "of" << filenames.size() << "files in" << QString::number(wallTime, 'f', 0) << "ms: vector accuracy"
+                       << QString::number(vectorMetrics.getAccuracy(), 'f', 3) << ", interval accuracy" << QString::number(intervalMetrics.getAccuracy(), 'f', 3);
+
+    return result;
+}
+
+int ClassifierEvaluation::inferenceThreadCount() const
+{
+    if (settings.nInferenceThreads > 0)
+        return settings.nInferenceThreads;
+
+    return qMax(1, QThread::idealThreadCount() - qMax(1, settings.nReaders));
+}
+
+/*!
+ * \brief ClassifierEvaluation::measurementFiles returns the files of \a paths, directories are replaced by the data files (*.csv, *.txt) they contain.
+ */
+QStringList ClassifierEvaluation::measurementFiles(const QStringList &paths)
+{
+    QStringList files;
+    for (const QString &path : paths)
+    {
+        QFileInfo fileInfo(path);
+        if (!fileInfo.isDir())
+        {
+            files << path;
+            continue;
+        }
+
+        for (const QFileInfo &entry : QDir(path).entryInfoList(QStringList{"*.csv", "*.txt"}, QDir::Files, QDir::Name))
+            files << entry.absoluteFilePath();
+    }
+
+    return files;
+}
+
+/*!
+ * \brief ClassifierEvaluation::measurementInputs returns the inputs of \a classifier for the measurement \a data: windows of its func vectors ending every window stride vectors.
+ * If \a labels is set, the user annotation of the latest vector of each window is appended to it, if \a timestamps is set its timestamp.
+ */
+std::vector<std::vector<double>> ClassifierEvaluation::measurementInputs(Classifier *classifier, MeasurementData *data, QList<Annotation> *labels, QList<uint> *timestamps)
+{
+    std::vector<std::vector<double>> inputs;
+    FuncWindowBuffer window;
+    window.reset(classifier->getN(), classifier->getWindowLength());
+
+    Functionalisation functionalisation = data->getFunctionalisation();
+    std::vector<bool> sensorFailures = data->getSensorFailures();
+
+    auto addInput = [&](uint timestamp, MVector vector){
+        window.push(vector.getFuncVector(functionalisation, sensorFailures, classifier->getInputFunctionType()).getVector());
+        if (window.getSize() < classifier->getWindowLength() || (window.getNPushed() - static_cast<quint64>(classifier->getWindowLength())) % static_cast<quint64>(classifier->getWindowStride()) != 0)
+            return;
+
+        inputs.emplace_back(static_cast<size_t>(classifier->getInputWidth()));
+        window.assemble(classifier->getWindowLength(), classifier->getWindowSlopes(), inputs.back().data());
+
+        if (labels != nullptr)
+            *labels << vector.userAnnotation;
+        if (timestamps != nullptr)
+            *timestamps << timestamp;
+    };
+
+    if (classifier->getIsInputAbsolute())
+    {
+        const auto &absoluteData = data->getAbsoluteData();
+        for (auto it = absoluteData.begin(); it != absoluteData.end(); ++it)
+            addInput(it.key(), it.value());
+    }
+    else
+    {
+        auto relativeData = data->getRelativeData();
+        for (auto it = relativeData.begin(); it != relativeData.end(); ++it)
+            addInput(it.key(), it.value());
+    }
+
+    return inputs;
+}
+
+/*!
+ * \brief ClassifierEvaluation::predictionNames returns the sorted names of the predicted classes of \a annotation.
+ */
+QStringList ClassifierEvaluation::predictionNames(const Annotation &annotation)
+{
+    QStringList names;
+    for (const aClass &aclass : annotation.getPredClasses())
+        names << aclass.getName();
+    names.sort();
+    return names;
+}
+
+/*!
+ * \brief ClassifierEvaluation::labelNames returns the sorted names of the classes of the user annotation \a annotation.
+ */
+QStringList ClassifierEvaluation::labelNames(const Annotation &annotation)
+{
+    QStringList names;
+    for (const aClass &aclass : annotation.getClasses())
+        names << aclass.getName();
+    names.sort();
+    return names;
+}
@@ -0,0 +1,38 @@
+#ifndef CLASSIFIEREVALUATION_H
+#define CLASSIFIEREVALUATION_H
+
+#include <QtCore>
+
+#include <vector>
+
+#include "classifier.h"
+#include "measurementdata.h"
+#include "defaultSettings.h"
+
+class ClassifierEvaluation
+{
+public:
+    struct Settings{
+        int batchSize = DEFAULT_CLASSIFIER_BATCH_SIZE;
+        int nReaders = 2;               // files parsed in parallel
+        int nInferenceThreads = 0;      // threads classifying batches, 0: ideal thread count minus the readers
+        int queueCapacity = 0;          // batches read ahead of the inference, 0: 4 per inference thread
+    };
+
+    explicit ClassifierEvaluation(Classifier *classifier, Settings settings = Settings());
+
+    QJsonObject run(const QStringList &filenames);
+
+    static QStringList measurementFiles(const QStringList &paths);
+    static std::vector<std::vector<double>> measurementInputs(Classifier *classifier, MeasurementData *data, QList<Annotation> *labels = nullptr, QList<uint> *timestamps = nullptr);
+    static QStringList predictionNames(const Annotation &annotation);
+    static QStringList labelNames(const Annotation &annotation);
+
+private:
+    Classifier *classifier;
+    Settings settings;
+
+    int inferenceThreadCount() const;
+};
+
+#endif // CLASSIFIEREVALUATION_H
@@ -4,6 +4,11 @@
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QAbstractButton>
+#include <QStatusBar>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
 
 #include "../widgets/functionalisationdialog.h"
 #include "../widgets/sourcedialog.h"
@@ -17,9 +22,40 @@
 #include "datasource.h"
 #include "usbdatasource.h"
 #include "fakedatasource.h"
+#include "replaydatasource.h"
+#include "serialjournaldatasource.h"
+#include "stressdatasource.h"
+#include "classifierbenchmark.h"
+#include "fitterbenchmark.h"
 #include "mvector.h"
 #include "enosecolor.h"
 
+namespace {
+
+/*!
+ * \brief writeJsonReport writes \a report to \a filename, to stdout if \a filename is empty.
+ */
+void writeJsonReport(const QJsonObject &report, QString filename)
+{
+    QByteArray json = QJsonDocument(report).toJson();
+    if (filename.isEmpty())
+    {
+        QTextStream(stdout) << json;
+        return;
+    }
+
+    QFile outputFile(filename);
+    if (!outputFile.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Could not write results to" << filename;
+        return;
+    }
+    outputFile.write(json);
+    qDebug() << "Results written to" << filename;
+}
+
+}
+
 Controler::Controler(QObject *parent) :
     QObject(parent),
     w(new MainWindow),
@@ -67,6 +103,7 @@ Controler::Controler(QObject *parent) :
     // graph connections:
     // data
     connect(mData, &MeasurementData::vectorAdded, w, &MainWindow::addVector);    // add new vector to graphs
+    connect(mData, &MeasurementData::vectorsAdded, w, &MainWindow::addVectors);  // add vectors drained from source to graphs
     connect(mData, &MeasurementData::dataSet, w, &MainWindow::setData);
     connect(mData, &MeasurementData::dataCleared, w, &MainWindow::clearGraphs);
     connect(mData, &MeasurementData::classListChanged, this, &Controler::saveClassList);
@@ -144,11 +181,19 @@ Controler::Controler(QObject *parent) :
 
     // classifier widget
     connect(mData, &MeasurementData::selectionVectorChanged, this, [=](const AbsoluteMVector &vector, const MVector &stdDevVector, const std::vector<bool> &sensorFailures, const Functionalisation &functionalisation){
-        classifyVector(vector);
+        if (classifier != nullptr && classifier->getWindowLength() == 1 && !classifier->getWindowSlopes())
+            classifyVector(vector);
+        else
+            classifySelectionWindow();
     });
     connect(mData, &MeasurementData::vectorAdded, this, [=](uint timestamp, AbsoluteMVector vector, Functionalisation functionalisation , std::vector<bool> sensorFailures, bool yRescale){
-        if (w->isLiveClassification() && source->measIsRunning() && mData->getSelectionMap().size() == 0)
-            classifyVector(vector);
+        addLiveVector(vector, w->isLiveClassification() && source->measIsRunning() && mData->getSelectionMap().size() == 0);
+    });
+    connect(mData, &MeasurementData::vectorsAdded, this, [=](const QMap<uint, AbsoluteMVector> &vectors, const Functionalisation &functionalisation, const std::vector<bool> &sensorFailures){
+        // only the latest vector is shown in the classifier widget
+        bool classify = w->isLiveClassification() && source->measIsRunning() && mData->getSelectionMap().size() == 0;
+        for (auto it = vectors.constBegin(); it != vectors.constEnd(); ++it)
+            addLiveVector(it.value(), classify && it.key() == vectors.lastKey());
     });
     connect(w, &MainWindow::selectionCleared, w, &MainWindow::clearClassifierWidgetAnnotation);
 
@@ -182,10 +227,29 @@ Controler::~Controler()
 
     mData->deleteLater();
 
-    if (source != nullptr)
-        source->deleteLater();
-    if (sourceThread != nullptr)
-        sourceThread->deleteLater();
+    // pipelines delete their sources
+    if (sourcePipeline != nullptr)
+        sourcePipeline->deleteLater();
+    for (auto pipeline : devicePipelines)
+        pipeline->deleteLater();
+    // simulator thread quits when simulator is deleted
+    if (deviceSimulator != nullptr)
+        deviceSimulator->deleteLater();
+    stopClassification();
+    if (liveClassifier != nullptr)
+        liveClassifier->stop();
+
+    // the event loop stopped: threads finishing now are not deleted by deleteLater
+    for (QPointer<QThread> thread : classifierThreads)
+        if (!thread.isNull())
+        {
+            thread->wait();
+            delete thread;
+        }
+    for (Classifier *usedClassifier : classifierThreads.uniqueKeys())
+        if (usedClassifier != classifier)
+            delete usedClassifier;
+
     if (classifier != nullptr)
         classifier->deleteLater();
 }
@@ -219,7 +283,7 @@ bool Controler::dirIsWriteable(QDir dir)
 void Controler::initialize()
 {
     loadCLArguments();
-    if (!parseResult.curveFit)
+    if (!parseResult.isHeadless())
         loadAutosave();
 }
 
@@ -237,17 +301,80 @@ void Controler::loadCLArguments()
             return;
         }
         AutomatedFitWorker fitWorker(mData, parseResult.timeout, parseResult.nCores, parseResult.tExposition, parseResult.tRecovery, parseResult.tOffset);
+        fitWorker.setTargetError(parseResult.fitTargetError);
+        fitWorker.setSeed(parseResult.fitSeed);
+        fitWorker.setTimingsFile(parseResult.fitTimingsFile);
+        fitWorker.setWarmStart(!parseResult.fitColdStart);
         fitWorker.fit();
 
         QFileInfo fileInfo(parseResult.filename);
         fitWorker.save(fileInfo.path() + "/" + "cf_" + fileInfo.fileName());
         QApplication::instance()->quit();
     }
+    // benchmark classifier
+    else if (!parseResult.benchmarkClassifier.isEmpty())
+    {
+        if (parseResult.filename != "")
+            loadData(parseResult.filename);
+
+        runClassifierBenchmark();
+        QApplication::instance()->quit();
+        return;
+    }
+    // benchmark curve fit solvers
+    else if (parseResult.benchmarkFitter)
+    {
+        runFitterBenchmark();
+        QApplication::instance()->quit();
+        return;
+    }
+    // evaluate classifier on many measurement files
+    else if (!parseResult.evaluateClassifier.isEmpty())
+    {
+        bool evaluated = evaluateClassifier();
+        QApplication::exit(evaluated ? 0 : 1);
+        return;
+    }
+    // compare int8 & float classifier on a validation file
+    else if (!parseResult.compareQuantized.isEmpty())
+    {
+        if (parseResult.filename != "")
+            loadData(parseResult.filename);
+
+        bool compared = compareQuantizedClassifier();
+        QApplication::exit(compared ? 0 : 1);
+        return;
+    }
+    // convert classifier for the built-in MLP backend
+    else if (!parseResult.exportMlp.isEmpty())
+    {
+        bool passed = exportMlpClassifier();
+        QApplication::exit(passed ? 0 : 1);
+        return;
+    }
     // load file
     else if (parseResult.filename != "")
     {
         loadData(parseResult.filename);
     }
+
+    // stress test
+    if (parseResult.stressRate > 0)
+        startStressTest();
+
+    // replay measurement
+    else if (parseResult.replayFile.endsWith(SERIAL_JOURNAL_EXTENSION))
+        setJournalReplaySource(parseResult.replayFile, parseResult.replaySpeed);
+    else if (!parseResult.replayFile.isEmpty())
+        setReplaySource(parseResult.replayFile, parseResult.replaySpeed);
+
+    // additional devices
+    for (QString deviceString : parseResult.devices)
+        addDevice(deviceString);
+
+    // simulated device
+    if (!parseResult.simulateProtocol.isEmpty())
+        startDeviceSimulator();
 }
 
 void Controler::loadAutosave()
@@ -325,6 +452,27 @@ void Controler::loadSettings()
 
     mData->setLimits(lowerLimit, upperLimit, useLimits);
 
+    // load base vector settings
+    baselineSettings.nVectors = static_cast<int>(DataSource::nBaseVectors);
+    baselineSettings.mode = BaselineEstimator::modeFromString(settings.value(BASELINE_MODE_KEY, DEFAULT_BASELINE_MODE).toString());
+    baselineSettings.trackDrift = settings.value(BASELINE_DRIFT_KEY, DEFAULT_BASELINE_DRIFT).toBool();
+
+    // load classifier settings
+    classifierBatchSize = qMax(1, settings.value(CLASSIFIER_BATCH_SIZE_KEY, DEFAULT_CLASSIFIER_BATCH_SIZE).toInt());
+    classificationCache.setCapacity(qMax(0, settings.value(CLASSIFICATION_CACHE_SIZE_KEY, DEFAULT_CLASSIFICATION_CACHE_SIZE).toInt()));
+    classifierSettings.freeze = settings.value(CLASSIFIER_FREEZE_KEY, DEFAULT_CLASSIFIER_FREEZE).toBool();
+    classifierSettings.optimize = settings.value(CLASSIFIER_OPTIMIZE_KEY, DEFAULT_CLASSIFIER_OPTIMIZE).toBool();
+    classifierSettings.nWarmupRuns = qMax(0, settings.value(CLASSIFIER_WARMUP_RUNS_KEY, DEFAULT_CLASSIFIER_WARMUP_RUNS).toInt());
+    classifierSettings.quantization = settings.value(CLASSIFIER_QUANTIZATION_KEY, DEFAULT_CLASSIFIER_QUANTIZATION).toString();
+    classifierIntraOpThreads = settings.value(CLASSIFIER_INTRA_OP_THREADS_KEY, DEFAULT_CLASSIFIER_INTRA_OP_THREADS).toInt();
+    classifierInterOpThreads = settings.value(CLASSIFIER_INTER_OP_THREADS_KEY, DEFAULT_CLASSIFIER_INTER_OP_THREADS).toInt();
+    ensembleMergeRule = ClassifierEnsemble::mergeRuleFromString(settings.value(ENSEMBLE_MERGE_RULE_KEY, DEFAULT_ENSEMBLE_MERGE_RULE).toString());
+
+#ifdef TORCH_BACKEND
+    // thread counts have to be set before libtorch is used the first time
+    TorchClassifier::setThreadCounts(classifierIntraOpThreads, classifierInterOpThreads);
+#endif
+
     // load classList
     QString classListString = settings.value(SMELL_LIST_KEY, DEFAULT_SMELL_LIST).toString();
     QStringList classList = classListString.split(SMELL_SEPARATOR);
@@ -371,6 +519,15 @@ void Controler::setGeneralSettings()
     dialog.setPresetDir(presetDir);
     dialog.setRunAutoSaveEnabled(runningAutoSaveEnabled);
     dialog.setRunAutoSaveInterval(runningAutoSaveInterval);
+    dialog.setBaselineMode(baselineSettings.mode);
+    dialog.setTrackDrift(baselineSettings.trackDrift);
+    dialog.setFreezeClassifier(classifierSettings.freeze);
+    dialog.setOptimizeClassifier(classifierSettings.optimize);
+    dialog.setClassifierWarmupRuns(classifierSettings.nWarmupRuns);
+    dialog.setClassifierQuantization(classifierSettings.quantization);
+    dialog.setIntraOpThreads(classifierIntraOpThreads);
+    dialog.setInterOpThreads(classifierInterOpThreads);
+    dialog.setEnsembleMergeRule(ensembleMergeRule);
 
     if (dialog.exec())
     {
@@ -417,6 +574,38 @@ void Controler::setGeneralSettings()
         if (newRunningAutoSaveEnabled != runningAutoSaveEnabled)
             setRunningAutoSave(newRunningAutoSaveEnabled);
 
+        // --- base vector ---
+        baselineSettings.mode = dialog.getBaselineMode();
+        baselineSettings.trackDrift = dialog.getTrackDrift();
+        settings.setValue(BASELINE_MODE_KEY, BaselineEstimator::modeToString(baselineSettings.mode));
+        settings.setValue(BASELINE_DRIFT_KEY, baselineSettings.trackDrift);
+
+        if (source != nullptr)
+            applyBaselineSettings(source);
+        for (auto pipeline : devicePipelines)
+            applyBaselineSettings(pipeline->getSource());
+
+        // --- classifier ---
+        // freezing & warm-up apply to the next classifier loaded
+        classifierSettings.freeze = dialog.getFreezeClassifier();
+        classifierSettings.optimize = dialog.getOptimizeClassifier();
+        classifierSettings.nWarmupRuns = dialog.getClassifierWarmupRuns();
+        classifierSettings.quantization = dialog.getClassifierQuantization();
+        classifierIntraOpThreads = dialog.getIntraOpThreads();
+        classifierInterOpThreads = dialog.getInterOpThreads();
+        settings.setValue(CLASSIFIER_FREEZE_KEY, classifierSettings.freeze);
+        settings.setValue(CLASSIFIER_OPTIMIZE_KEY, classifierSettings.optimize);
+        settings.setValue(CLASSIFIER_WARMUP_RUNS_KEY, classifierSettings.nWarmupRuns);
+        settings.setValue(CLASSIFIER_QUANTIZATION_KEY, classifierSettings.quantization);
+        settings.setValue(CLASSIFIER_INTRA_OP_THREADS_KEY, classifierIntraOpThreads);
+        settings.setValue(CLASSIFIER_INTER_OP_THREADS_KEY, classifierInterOpThreads);
+        ensembleMergeRule = dialog.getEnsembleMergeRule();
+        settings.setValue(ENSEMBLE_MERGE_RULE_KEY, ClassifierEnsemble::mergeRuleToString(ensembleMergeRule));
+
+#ifdef TORCH_BACKEND
+        TorchClassifier::setThreadCounts(classifierIntraOpThreads, classifierInterOpThreads);
+#endif
+
         // qDebug() << "Keys after general settings dialog:\n"  << settings.allKeys().join("; ");
     }
 }
@@ -593,7 +782,7 @@ void Controler::parseArguments()
     parser.setApplicationDescription("eNoseAnnotator " + QString(GIT_VERSION));
     parser.addHelpOption();
     parser.addVersionOption();
-    parser.addPositionalArgument("filename", QCoreApplication::translate("main", "Measurement file (.csv) to open"));
+    parser.addPositionalArgument("filename", QCoreApplication::translate("main", "Measurement file (.csv) to open, files or directories to evaluate a classifier on"));
 
     QCommandLineOption curveFitOption(QStringList() << "curve-fit",
             QCoreApplication::translate("main", "Fit curves to exposition"));
@@ -611,9 +800,105 @@ void Controler::parseArguments()
     QCommandLineOption tRecoveryOption(QStringList{"t_recovery"}, "time of exposition in seconds", "tExposition", "-1");
     parser.addOption(tRecoveryOption);
 
+    QCommandLineOption fitTargetErrorOption(QStringList{"fit-target-error"}, "rms error at which the random restarts of a channel fit stop, 0: all restarts", "targetError", QString::number(CVWIZ_DEFAULT_TARGET_ERROR));
+    parser.addOption(fitTargetErrorOption);
+
+    QCommandLineOption fitSeedOption(QStringList{"fit-seed"}, "seed of the random restarts of the curve fit", "seed", QString::number(LEAST_SQUARES_SEED));
+    parser.addOption(fitSeedOption);
+
+    QCommandLineOption fitTimingsOption(QStringList{"fit-timings"}, "save the timings of the curve fit tasks to file", "filename");
+    parser.addOption(fitTimingsOption);
+
+    QCommandLineOption fitColdStartOption(QStringList{"fit-cold-start"}, "fit every channel from random restarts instead of starting from the fit of a channel with the same functionalisation");
+    parser.addOption(fitColdStartOption);
+
     QCommandLineOption tExpositionOption(QStringList{"t_exposition"}, "max time of recovery in seconds", "tRecovery", QString::number(CVWIZ_DEFAULT_RECOVERY_TIME));
     parser.addOption(tExpositionOption);
 
+    QCommandLineOption replayOption(QStringList{"replay"}, "replay measurement file or serial journal as data source", "filename");
+    parser.addOption(replayOption);
+
+    QCommandLineOption replaySpeedOption(QStringList{"replay-speed"}, "replay speed relative to real time, 0 replays as fast as possible", "speed", "1");
+    parser.addOption(replaySpeedOption);
+
+    QCommandLineOption captureOption(QStringList{"capture-serial"}, "capture the raw data received from usb devices to serial journals in the directory. Journals (" SERIAL_JOURNAL_EXTENSION ") can be replayed with --replay", "directory");
+    parser.addOption(captureOption);
+
+    QCommandLineOption binaryProtocolOption(QStringList{"binary-protocol"}, "request the binary frame protocol from usb devices. Devices not supporting it keep sending ASCII lines");
+    parser.addOption(binaryProtocolOption);
+
+    QCommandLineOption stressOption(QStringList{"stress"}, "stress test with synthetic readings at the given rate", "rateInHz", "0");
+    parser.addOption(stressOption);
+
+    QCommandLineOption stressChannelsOption(QStringList{"stress-channels"}, "number of channels of the stress test", "nChannels", QString::number(MVector::nChannels));
+    parser.addOption(stressChannelsOption);
+
+    QCommandLineOption stressAttributesOption(QStringList{"stress-attributes"}, "number of sensor attributes of the stress test", "nAttributes", "2");
+    parser.addOption(stressAttributesOption);
+
+    QCommandLineOption stressEventsOption(QStringList{"stress-events"}, "measurement events per second of the stress test", "eventRate", "0");
+    parser.addOption(stressEventsOption);
+
+    QCommandLineOption stressDurationOption(QStringList{"stress-duration"}, "duration of the stress test in seconds, 0 runs until closed", "durationInS", "0");
+    parser.addOption(stressDurationOption);
+
+    QCommandLineOption simulateOption(QStringList{"simulate-device"}, "simulate a usb device speaking firmware protocol v1 or v2 on a pseudo-terminal and acquire it as additional device", "protocol");
+    parser.addOption(simulateOption);
+
+    QCommandLineOption simulateRateOption(QStringList{"simulate-rate"}, "measurement lines per second sent by the simulated device", "rateInHz", "1");
+    parser.addOption(simulateRateOption);
+
+    QCommandLineOption simulateChannelsOption(QStringList{"simulate-channels"}, "number of channels of the simulated device", "nChannels", QString::number(MVector::nChannels));
+    parser.addOption(simulateChannelsOption);
+
+    QCommandLineOption simulateEventsOption(QStringList{"simulate-events"}, "event lines per second sent by the simulated device", "eventRate", "0");
+    parser.addOption(simulateEventsOption);
+
+    QCommandLineOption simulateBinaryOption(QStringList{"simulate-binary"}, "simulated device supports the binary frame protocol, implies --binary-protocol. Latency is only traced for ASCII lines");
+    parser.addOption(simulateBinaryOption);
+
+    QCommandLineOption benchmarkOption(QStringList{"benchmark-classifier"}, "benchmark the latency of a classifier without gui and quit. Inputs are taken from the measurement file if given, synthetic inputs otherwise", "model");
+    parser.addOption(benchmarkOption);
+
+    QCommandLineOption benchmarkFitterOption(QStringList{"benchmark-fitter"}, "benchmark the dlib and the compile-time model solvers of the curve fit on synthetic curves without gui and quit");
+    parser.addOption(benchmarkFitterOption);
+
+    QCommandLineOption benchmarkOutputOption(QStringList{"benchmark-output"}, "json file the results of the classifier or fitter benchmark, comparison or evaluation are written to, stdout if not set", "filename");
+    parser.addOption(benchmarkOutputOption);
+
+    QCommandLineOption benchmarkBatchSizesOption(QStringList{"benchmark-batch-sizes"}, "comma separated batch sizes of the classifier benchmark", "batchSizes", "1,8,64,256");
+    parser.addOption(benchmarkBatchSizesOption);
+
+    QCommandLineOption benchmarkThreadsOption(QStringList{"benchmark-threads"}, "comma separated intra-op thread counts of the classifier benchmark, 0: libtorch default", "threadCounts", "0");
+    parser.addOption(benchmarkThreadsOption);
+
+    QCommandLineOption benchmarkIterationsOption(QStringList{"benchmark-iterations"}, "timed batches per batch size and thread count", "nIterations", "200");
+    parser.addOption(benchmarkIterationsOption);
+
+    QCommandLineOption benchmarkVectorsOption(QStringList{"benchmark-vectors"}, "number of synthetic inputs", "nVectors", "1000");
+    parser.addOption(benchmarkVectorsOption);
+
+    QCommandLineOption exportMlpOption(QStringList{"export-mlp"}, "convert a TorchScript classifier (.pt) into a classifier of the built-in MLP backend (.mlp), check that both classify synthetic inputs the same way and quit", "model");
+    parser.addOption(exportMlpOption);
+
+    QCommandLineOption exportMlpOutputOption(QStringList{"export-mlp-output"}, "file the converted classifier is written to, the model file with the extension .mlp if not set", "filename");
+    parser.addOption(exportMlpOutputOption);
+
+    QCommandLineOption compareQuantizedOption(QStringList{"compare-quantized"}, "compare the int8 quantized TorchScript classifier to the float classifier on the measurement file and quit: accuracy against the user annotations, agreement and speedup are written as json to the benchmark output", "model");
+    parser.addOption(compareQuantizedOption);
+
+    QCommandLineOption evaluateOption(QStringList{"evaluate-classifier"}, "evaluate a classifier on the measurement files and directories given as arguments and quit: accuracy, confusion matrices and per-class precision & recall per vector and per annotated interval are written as json to the benchmark output", "model");
+    parser.addOption(evaluateOption);
+
+    QCommandLineOption evaluationReadersOption(QStringList{"evaluation-readers"}, "number of files read in parallel by the classifier evaluation", "nReaders", "2");
+    parser.addOption(evaluationReadersOption);
+
+    QCommandLineOption evaluationThreadsOption(QStringList{"evaluation-threads"}, "number of threads classifying in the classifier evaluation, 0: ideal thread count minus readers", "nThreads", "0");
+    parser.addOption(evaluationThreadsOption);
+
+    QCommandLineOption deviceOption(QStringList{"d", "device"}, "additional device acquired in parallel, can be repeated. Use \"fake\" as port for a fake data source", "port[:nChannels]");
+    parser.addOption(deviceOption);
+
     // parse launch arguments
     parser.process(*QApplication::instance());
 
@@ -621,8 +906,24 @@ void Controler::parseArguments()
     const QStringList posArgs = parser.positionalArguments();
     if (posArgs.size() > 0)
         parseResult.filename = posArgs[0];
+    parseResult.filenames = posArgs;
 
     parseResult.curveFit = parser.isSet(curveFitOption);
+    parseResult.devices = parser.values(deviceOption);
+    parseResult.replayFile = parser.value(replayOption);
+    parseResult.captureDir = parser.value(captureOption);
+    parseResult.simulateProtocol = parser.value(simulateOption).toLower();
+    parseResult.simulateBinary = parser.isSet(simulateBinaryOption);
+    parseResult.binaryProtocol = parser.isSet(binaryProtocolOption) || parseResult.simulateBinary;
+    parseResult.benchmarkClassifier = parser.value(benchmarkOption);
+    parseResult.benchmarkOutput = parser.value(benchmarkOutputOption);
+    parseResult.benchmarkFitter = parser.isSet(benchmarkFitterOption);
+    parseResult.exportMlp = parser.value(exportMlpOption);
+    parseResult.exportMlpOutput = parser.value(exportMlpOutputOption);
+    parseResult.compareQuantized = parser.value(compareQuantizedOption);
+    parseResult.evaluateClassifier = parser.value(evaluateOption);
+    parseResult.fitTimingsFile = parser.value(fitTimingsOption);
+    parseResult.fitColdStart = parser.isSet(fitColdStartOption);
 
     bool ok;
     parseResult.timeout = parser.value(timeoutOption).toInt(&ok);
@@ -630,6 +931,60 @@ void Controler::parseArguments()
     parseResult.tOffset = parser.value(tOffsetOption).toInt(&ok);
     parseResult.tExposition = parser.value(tExpositionOption).toInt(&ok);
     parseResult.tRecovery = parser.value(tRecoveryOption).toInt(&ok);
+    if (ok)
+        parseResult.fitTargetError = parser.value(fitTargetErrorOption).toDouble(&ok);
+    if (ok)
+        parseResult.fitSeed = parser.value(fitSeedOption).toULongLong(&ok);
+    if (ok)
+        parseResult.replaySpeed = parser.value(replaySpeedOption).toDouble(&ok);
+    if (ok)
+        parseResult.stressRate = parser.value(stressOption).toDouble(&ok);
+    if (ok)
+        parseResult.stressChannels = parser.value(stressChannelsOption).toInt(&ok);
+    if (ok)
+        parseResult.stressAttributes = parser.value(stressAttributesOption).toInt(&ok);
+    if (ok)
+        parseResult.stressEventRate = parser.value(stressEventsOption).toDouble(&ok);
+    if (ok)
+        parseResult.stressDuration = parser.value(stressDurationOption).toInt(&ok);
+    if (ok)
+        parseResult.simulateRate = parser.value(simulateRateOption).toDouble(&ok);
+    if (ok)
+        parseResult.simulateChannels = parser.value(simulateChannelsOption).toInt(&ok);
+    if (ok)
+        parseResult.simulateEventRate = parser.value(simulateEventsOption).toDouble(&ok);
+    if (ok)
+    {
+        parseResult.benchmarkIterations = parser.value(benchmarkIterationsOption).toInt(&ok);
+        if (ok && parseResult.benchmarkIterations <= 0)
+            throw std::runtime_error("Invalid number of benchmark iterations: " + std::to_string(parseResult.benchmarkIterations) + ". It has to be positive.");
+    }
+    if (ok)
+    {
+        parseResult.benchmarkVectors = parser.value(benchmarkVectorsOption).toInt(&ok);
+        if (ok && parseResult.benchmarkVectors <= 0)
+            throw std::runtime_error("Invalid number of benchmark vectors: " + std::to_string(parseResult.benchmarkVectors) + ". It has to be positive.");
+    }
+    if (ok)
+        parseResult.evaluationReaders = parser.value(evaluationReadersOption).toInt(&ok);
+    if (ok)
+        parseResult.evaluationThreads = parser.value(evaluationThreadsOption).toInt(&ok);
+    if (ok)
+    {
+        parseResult.benchmarkBatchSizes.clear();
+        for (QString value : parser.value(benchmarkBatchSizesOption).split(",", QString::SkipEmptyParts))
+            if (ok)
+                parseResult.benchmarkBatchSizes << value.toInt(&ok);
+        ok = ok && !parseResult.benchmarkBatchSizes.isEmpty() && *std::min_element(parseResult.benchmarkBatchSizes.begin(), parseResult.benchmarkBatchSizes.end()) > 0;
+    }
+    if (ok)
+    {
+        parseResult.benchmarkThreads.clear();
+        for (QString value : parser.value(benchmarkThreadsOption).split(",", QString::SkipEmptyParts))
+            if (ok)
+                parseResult.benchmarkThreads << value.toInt(&ok);
+        ok = ok && !parseResult.benchmarkThreads.isEmpty();
+    }
     if (!ok)
         throw std::runtime_error("One or more parameters are invalid!");
 
@@ -703,6 +1058,10 @@ void Controler::clearData()
 {
     mData->clear();
     w->clearGraphs();
+
+    // windows do not span measurements
+    if (classifier != nullptr)
+        liveWindow.reset(classifier->getN(), classifier->getWindowLength());
 }
 
 void Controler::saveDataDir()
@@ -755,6 +1114,10 @@ void Controler::setSourceConnection()
         {
             dialog->setSourceType(DataSource::SourceType::FAKE);
         }
+        else if (source->sourceType() == DataSource::SourceType::REPLAY)
+        {
+            // replays are set by command line, the dialog can only replace them
+        }
         else
             Q_ASSERT ("Unknown source selected!" && false);
     }
@@ -786,9 +1149,9 @@ void Controler::setSourceConnection()
 
                 }
                 // delete old source
-                source->deleteLater();
+                sourcePipeline->deleteLater();
+                sourcePipeline = nullptr;
                 source = nullptr;
-                sourceThread = nullptr;
             }
 
             // sensor Id was changed
@@ -802,10 +1165,11 @@ void Controler::setSourceConnection()
         // -> init new source
         if (source == nullptr)
         {
-            sourceThread = new QThread();
             // usb source:
             if (sourceType == DataSource::SourceType::USB)
             {
+                usbSettings.journalFile = serialCaptureFile(usbSettings.portName);
+                usbSettings.binaryProtocol = parseResult.binaryProtocol;
                 source = new USBDataSource(usbSettings, DEVICE_TIMEOUT, nChannels);
             }
             // fake source:
@@ -814,14 +1178,8 @@ void Controler::setSourceConnection()
                 source = new FakeDatasource(DEVICE_TIMEOUT, nChannels);
             }
 
-            // run source in separate thread
-            source->moveToThread(sourceThread);
-
-            connect(sourceThread, SIGNAL(started()), source, SLOT(started())); // init source when thread was started
-            connect(source, SIGNAL(destroyed()), sourceThread, SLOT(quit()));   // end thread when source is deleted
-            connect(sourceThread, SIGNAL(finished()), sourceThread, SLOT(deleteLater())); // delete thread when finishes
-
-            sourceThread->start();
+            // run source in separate thread, add its readings to mData
+            sourcePipeline = new DevicePipeline(source, mData, this);
 
             // make connections
             makeSourceConnections();
@@ -872,8 +1230,7 @@ void Controler::openFlashDialog()
 
 void Controler::makeSourceConnections()
 {
-    connect(source, &DataSource::baseVectorSet, mData, &MeasurementData::setBaseVector);
-    connect(source, SIGNAL(vectorReceived(uint, AbsoluteMVector)), mData, SLOT(addVector(uint, AbsoluteMVector)));
+    // measurement data is passed through the source buffer and added in batches by sourcePipeline
 
 //        if (measInfoWidget->statusSet != DataSource::Status::RECEIVING_DATA)
 //        {
@@ -888,6 +1245,409 @@ void Controler::makeSourceConnections()
     connect(source, &DataSource::statusSet, w, &MainWindow::setStatus);
 
     connect(source, &DataSource::fanLevelSet, w, &MainWindow::setFanLevel);
+
+    connect(sourcePipeline, &DevicePipeline::healthUpdated, w, &MainWindow::setPipelineHealth);
+
+    applyBaselineSettings(source);
+}
+
+/*!
+ * \brief Controler::applyBaselineSettings sets the base vector settings of \a dataSource in the thread of the source.
+ */
+void Controler::applyBaselineSettings(DataSource *dataSource)
+{
+    QMetaObject::invokeMethod(dataSource, "setBaselineSettings", Qt::QueuedConnection, Q_ARG(BaselineEstimator::Settings, baselineSettings));
+}
+
+/*!
+ * \brief Controler::setReplaySource replaces source by a ReplayDataSource streaming the measurement in \a filename at \a speed times real time.
+ * A \a speed <= 0 replays as fast as possible. Functionalisation and sensor id of the file are applied to the current data.
+ */
+void Controler::setReplaySource(QString filename, double speed)
+{
+    ReplayDataSource *replaySource;
+    try {
+        replaySource = new ReplayDataSource(filename, speed, DEVICE_TIMEOUT);
+    } catch (std::runtime_error e) {
+        QMessageBox::critical(w, "Error loading replay", e.what());
+        return;
+    }
+
+    if (replaySource->getNChannels() != static_cast<int>(MVector::nChannels))
+    {
+        QMessageBox::critical(w, "Error loading replay", "The number of channels of " + filename + " differs from the number of channels of the current data.");
+        delete replaySource;
+        return;
+    }
+
+    // delete old source
+    if (source != nullptr)
+    {
+        if (source->measIsRunning())
+            QMetaObject::invokeMethod(source, "stop", Qt::QueuedConnection);
+
+        sourcePipeline->deleteLater();
+        sourcePipeline = nullptr;
+        source = nullptr;
+    }
+
+    source = replaySource;
+    sourcePipeline = new DevicePipeline(source, mData, this);
+    makeSourceConnections();
+
+    clearData();
+    mData->setFunctionalisation(replaySource->getFunctionalisation());
+    mData->setSensorId(replaySource->getSensorId());
+    mData->setDataChanged(false);
+    w->sensorConnected(replaySource->getSensorId());
+
+    qDebug().noquote() << "Replaying " << replaySource->getNVectors() << " vectors of " << filename << " at speed " << (speed > 0 ? QString::number(speed) : "max");
+}
+
+/*!
+ * \brief Controler::setJournalReplaySource replaces source by a SerialJournalDataSource replaying the serial journal \a filename at \a speed times real time.
+ * A \a speed <= 0 replays as fast as possible.
+ */
+void Controler::setJournalReplaySource(QString filename, double speed)
+{
+    SerialJournalDataSource *journalSource;
+    try {
+        journalSource = new SerialJournalDataSource(filename, speed, DEVICE_TIMEOUT, MVector::nChannels);
+    } catch (std::runtime_error e) {
+        QMessageBox::critical(w, "Error loading serial journal", e.what());
+        return;
+    }
+
+    // delete old source
+    if (source != nullptr)
+    {
+        if (source->measIsRunning())
+            QMetaObject::invokeMethod(source, "stop", Qt::QueuedConnection);
+
+        sourcePipeline->deleteLater();
+        sourcePipeline = nullptr;
+        source = nullptr;
+    }
+
+    source = journalSource;
+    sourcePipeline = new DevicePipeline(source, mData, this);
+    makeSourceConnections();
+
+    clearData();
+    w->sensorConnected(filename);
+
+    qDebug().noquote() << "Replaying " << journalSource->getNChunks() << " serial chunks of " << filename << " at speed " << (speed > 0 ? QString::number(speed) : "max");
+}
+
+/*!
+ * \brief Controler::serialCaptureFile returns the serial journal the data received on \a portName is captured to.
+ * Returns an empty string if no capture directory was set by the command line arguments.
+ */
+QString Controler::serialCaptureFile(QString portName)
+{
+    if (parseResult.captureDir.isEmpty())
+        return "";
+
+    QString deviceName = QFileInfo(portName).fileName();
+    deviceName.replace(QRegularExpression("[^A-Za-z0-9_-]"), "_");
+    return parseResult.captureDir + "/" + deviceName + "_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + SERIAL_JOURNAL_EXTENSION;
+}
+
+/*!
+ * \brief Controler::runClassifierBenchmark benchmarks the classifier set by the command line arguments and writes the results as json.
+ * The func vectors of the measurement file loaded are used as inputs, synthetic inputs of the model's input size if no file was loaded.
+ * The classifier is prepared as set in the general settings.
+ */
+void Controler::runClassifierBenchmark()
+{
+    // input size: func size of the measurement, model size for synthetic inputs
+    bool hasMeasurement = !mData->getAbsoluteData().isEmpty();
+    int nInputs = hasMeasurement ? mData->getFunctionalisation().getFuncMap(mData->getSensorFailures()).size() : 0;
+
+    bool loadOk;
+    QString errorString;
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+    std::unique_ptr<Classifier> model(loadModel(parseResult.benchmarkClassifier, nInputs, nullptr, &loadOk, &errorString));
+    double loadTime = loadTimer.nsecsElapsed() * 1e-6;
+    if (!loadOk)
+    {
+        qWarning().noquote() << "Error loading model:" << errorString;
+        return;
+    }
+
+    ClassifierBenchmark::Settings benchmarkSettings;
+    benchmarkSettings.batchSizes = parseResult.benchmarkBatchSizes;
+    benchmarkSettings.threadCounts = parseResult.benchmarkThreads;
+    benchmarkSettings.nIterations = parseResult.benchmarkIterations;
+    benchmarkSettings.nSyntheticVectors = parseResult.benchmarkVectors;
+    ClassifierBenchmark benchmark(model.get(), benchmarkSettings);
+
+    if (hasMeasurement)
+        benchmark.setInputs(ClassifierEvaluation::measurementInputs(model.get(), mData), parseResult.filename);
+    else
+    {
+        benchmark.generateInputs(benchmarkSettings.nSyntheticVectors);
+    }
+
+    QJsonObject result;
+    try {
+        result = benchmark.run();
+    } catch (std::exception& e) {
+        qWarning() << "Classifier benchmark failed:" << e.what();
+        return;
+    }
+
+    result["file"] = parseResult.benchmarkClassifier;
+    result["loadTimeMs"] = loadTime;
+#ifdef TORCH_BACKEND
+    // first forward pass after loading: the first warm-up run if warm-up runs are set, untimed by the benchmark otherwise
+    if (TorchClassifier *torchClassifier = qobject_cast<TorchClassifier*>(model.get()))
+        result["coldInferenceMs"] = torchClassifier->getFirstInferenceTime();
+#endif
+    result["freeze"] = classifierSettings.freeze;
+    result["optimize"] = classifierSettings.optimize;
+    result["warmupRuns"] = classifierSettings.nWarmupRuns;
+    result["quantization"] = classifierSettings.quantization;
+
+    writeJsonReport(result, parseResult.benchmarkOutput);
+}
+
+/*!
+ * \brief Controler::runFitterBenchmark compares the curve fit solvers on synthetic curves and writes the results as json.
+ * The restarts are seeded with --fit-seed.
+ */
+void Controler::runFitterBenchmark()
+{
+    FitterBenchmark::Settings benchmarkSettings;
+    benchmarkSettings.seed = parseResult.fitSeed;
+    FitterBenchmark benchmark(benchmarkSettings);
+
+    QJsonObject result;
+    try {
+        result = benchmark.run();
+    } catch (std::exception& e) {
+        qWarning() << "Fitter benchmark failed:" << e.what();
+        return;
+    }
+
+    writeJsonReport(result, parseResult.benchmarkOutput);
+}
+
+/*!
+ * \brief Controler::startStressTest replaces source by a StressDataSource as set by the command line arguments and starts a measurement as soon as it is connected.
+ * If a duration was set, the test is finished by finishStressTest after the duration.
+ */
+void Controler::startStressTest()
+{
+    StressDataSource::Settings stressSettings;
+    stressSettings.rate = parseResult.stressRate;
+    stressSettings.nChannels = parseResult.stressChannels;
+    stressSettings.nAttributes = parseResult.stressAttributes;
+    stressSettings.eventRate = parseResult.stressEventRate;
+
+    if (stressSettings.nChannels <= 0)
+    {
+        QMessageBox::critical(w, "Error starting stress test", "Invalid number of channels: " + QString::number(stressSettings.nChannels));
+        return;
+    }
+
+    // the channel count is shared by all data: only change it if no data or other devices use it
+    if (static_cast<size_t>(stressSettings.nChannels) != MVector::nChannels && (!mData->getAbsoluteData().isEmpty() || !devicePipelines.isEmpty()))
+    {
+        QMessageBox::critical(w, "Error starting stress test", "The stress test has " + QString::number(stressSettings.nChannels) + " channels, the data loaded " + QString::number(MVector::nChannels) + " channels.");
+        return;
+    }
+
+    // delete old source
+    if (source != nullptr)
+    {
+        if (source->measIsRunning())
+            QMetaObject::invokeMethod(source, "stop", Qt::QueuedConnection);
+
+        sourcePipeline->deleteLater();
+        sourcePipeline = nullptr;
+        source = nullptr;
+    }
+
+    clearData();
+    if (static_cast<size_t>(stressSettings.nChannels) != MVector::nChannels)
+    {
+        MVector::nChannels = stressSettings.nChannels;
+        mData->resetNChannels(MVector::nChannels);
+    }
+
+    // class of the measurement events generated, registered in the GUI thread
+    if (stressSettings.eventRate > 0)
+        aClass::staticClassSet.insert(aClass(STRESS_EVENT_CLASS));
+
+    source = new StressDataSource(stressSettings, DEVICE_TIMEOUT);
+    sourcePipeline = new DevicePipeline(source, mData, this);
+    makeSourceConnections();
+    w->sensorConnected(source->identifier());
+
+    qDebug().noquote() << "Stress test:" << stressSettings.toString();
+
+    // start measurement when connected
+    connect(source, &DataSource::statusSet, this, [this](DataSource::Status status){
+        if (status != DataSource::Status::CONNECTED || stressClock.isValid())
+            return;
+
+        QMetaObject::invokeMethod(source, "start", Qt::QueuedConnection);
+        stressClock.start();
+
+        if (parseResult.stressDuration > 0)
+            QTimer::singleShot(parseResult.stressDuration * 1000, this, &Controler::finishStressTest);
+    });
+}
+
+/*!
+ * \brief Controler::finishStressTest stops the stress test, prints a summary and quits the application.
+ * The exit code is 0 if the rate was sustained: all readings due were generated and all generated readings were added to the data.
+ */
+void Controler::finishStressTest()
+{
+    QMetaObject::invokeMethod(source, "stop", Qt::QueuedConnection);
+    double seconds = stressClock.elapsed() / 1000.0;
+
+    // wait until the source buffer was drained
+    QTimer::singleShot(5 * SOURCE_DRAIN_INTERVAL, this, [this, seconds](){
+        auto stressSource = static_cast<StressDataSource*>(source);
+        double rate = stressSource->getSettings().rate;
+
+        quint64 due = static_cast<quint64>(rate * seconds);
+        quint64 generated = stressSource->getNGenerated();
+        quint64 ingested = static_cast<quint64>(mData->getAbsoluteData().size());
+        quint64 overruns = source->getBufferOverruns();
+
+        bool sustained = generated >= 0.99 * due && ingested >= generated && overruns == 0;
+
+        qDebug().noquote() << "Stress test finished after" << seconds << "s:";
+        qDebug().noquote() << "\treadings due:\t" << due;
+        qDebug().noquote() << "\tgenerated:\t" << generated << "(" << generated / seconds << "/s )";
+        qDebug().noquote() << "\tingested:\t" << ingested << "(" << ingested / seconds << "/s )";
+        qDebug().noquote() << "\toverruns:\t" << overruns;
+        qDebug().noquote() << "\tbuffer high-water mark:\t" << source->getBufferHighWaterMark() << "/" << source->getBufferCapacity();
+        qDebug().noquote() << "\tload:\t" << sourcePipeline->getLoad().toString();
+        qDebug().noquote() << "\trate sustained:\t" << (sustained ? "yes" : "no");
+
+        QApplication::instance()->exit(sustained ? 0 : 1);
+    });
+}
+
+/*!
+ * \brief Controler::addDevice acquires data from an additional device in parallel to source.
+ * \a deviceString has the format <port>[:<nChannels>], the port "fake" adds a FakeDatasource.
+ * Data of additional devices is not shown in the main window, but autosaved in autosavePath.
+ * Measurements of additional devices are started as soon as they are connected and follow start, pause, stop and reset of the main window.
+ */
+DevicePipeline *Controler::addDevice(QString deviceString)
+{
+    QStringList parts = deviceString.split(":");
+    QString portName = parts[0];
+
+    int nChannels = MVector::nChannels;
+    if (parts.size() > 1)
+    {
+        bool ok;
+        nChannels = parts[1].toInt(&ok);
+        if (!ok || nChannels <= 0)
+            throw std::invalid_argument("Invalid number of channels for device " + deviceString.toStdString());
+    }
+
+    DataSource *deviceSource;
+    if (portName == "fake")
+    {
+        deviceSource = new FakeDatasource(DEVICE_TIMEOUT, nChannels);
+    }
+    else
+    {
+        USBDataSource::Settings usbSettings;
+        usbSettings.portName = portName;
+        usbSettings.hasEnvSensors = false;
+        usbSettings.journalFile = serialCaptureFile(portName);
+        usbSettings.binaryProtocol = parseResult.binaryProtocol;
+        deviceSource = new USBDataSource(usbSettings, DEVICE_TIMEOUT, nChannels);
+    }
+
+    MeasurementData *deviceData = new MeasurementData(this, nChannels);
+    DevicePipeline *pipeline = new DevicePipeline(deviceSource, deviceData, this);
+    deviceData->setParent(pipeline);
+
+    // unique names for autosave files
+    QString identifier = pipeline->identifier();
+    QSet<QString> identifiers;
+    for (auto otherPipeline : devicePipelines)
+        identifiers << otherPipeline->identifier();
+    int n = 1;
+    while (identifiers.contains(n > 1 ? identifier + "_" + QString::number(n) : identifier))
+        n++;
+    if (n > 1)
+        pipeline->setIdentifier(identifier + "_" + QString::number(n));
+
+    connect(deviceSource, &DataSource::error, this, [pipeline](QString errorString){
+        qWarning().noquote() << pipeline->identifier() << ": " << errorString;
+    });
+
+    applyBaselineSettings(deviceSource);
+    pipeline->setAutosaveDir(autosavePath);
+    pipeline->setAutoStart(true);
+
+    devicePipelines << pipeline;
+    qDebug().noquote() << "Added device " << pipeline->identifier() << " with " << nChannels << " channels";
+    return pipeline;
+}
+
+/*!
+ * \brief Controler::startDeviceSimulator simulates a usb device on a pseudo-terminal as set by the command line arguments and acquires it like a real device.
+ * The end-to-end latency from the generation of a line by the simulator to the MeasurementData of the device is reported by the simulator.
+ */
+void Controler::startDeviceSimulator()
+{
+    DeviceSimulator::Settings simulatorSettings;
+    if (parseResult.simulateProtocol == "v1")
+        simulatorSettings.protocol = DeviceSimulator::Protocol::V1;
+    else if (parseResult.simulateProtocol == "v2")
+        simulatorSettings.protocol = DeviceSimulator::Protocol::V2;
+    else
+        throw std::invalid_argument("Unknown protocol of simulated device: " + parseResult.simulateProtocol.toStdString());
+
+    simulatorSettings.rate = parseResult.simulateRate;
+    simulatorSettings.nChannels = parseResult.simulateChannels;
+    simulatorSettings.eventRate = parseResult.simulateEventRate;
+    simulatorSettings.binarySupported = parseResult.simulateBinary;
+
+    if (simulatorSettings.rate <= 0 || simulatorSettings.nChannels <= 0)
+        throw std::invalid_argument("Invalid rate or number of channels of simulated device!");
+
+    deviceSimulator = new DeviceSimulator(simulatorSettings);
+    try {
+        deviceSimulator->open();
+    } catch (std::runtime_error e) {
+        qWarning() << "Error starting device simulator: " << e.what();
+        delete deviceSimulator;
+        deviceSimulator = nullptr;
+        return;
+    }
+
+    // run simulator in separate thread
+    QThread *simulatorThread = new QThread();
+    deviceSimulator->moveToThread(simulatorThread);
+    connect(simulatorThread, &QThread::started, deviceSimulator, &DeviceSimulator::start);
+    connect(deviceSimulator, &QObject::destroyed, simulatorThread, &QThread::quit);
+    connect(simulatorThread, &QThread::finished, simulatorThread, &QThread::deleteLater);
+    simulatorThread->start();
+
+    QString slaveName = deviceSimulator->getSlaveName();
+    qDebug().noquote() << "Simulating device on " << slaveName << ": " << simulatorSettings.toString();
+
+    // acquire simulated device like a usb device
+    DevicePipeline *pipeline = addDevice(slaveName + ":" + QString::number(simulatorSettings.nChannels));
+    connect(pipeline->getData(), &MeasurementData::vectorsAdded, this, [this](const QMap<uint, AbsoluteMVector> &vectors, const Functionalisation &, const std::vector<bool> &){
+        for (const auto &vector : vectors)
+            if (vector.sensorAttributes.contains(DeviceSimulator::sequenceAttribute))
+                deviceSimulator->traceReceived(static_cast<quint64>(vector.sensorAttributes[DeviceSimulator::sequenceAttribute]));
+    });
 }
 
 void Controler::startMeasurement()
@@ -901,12 +1661,16 @@ void Controler::startMeasurement()
     case DataSource::Status::RECEIVING_DATA:
     case DataSource::Status::SET_BASEVECTOR:
         QMetaObject::invokeMethod(source, "pause", Qt::QueuedConnection);
+        for (auto pipeline : devicePipelines)
+            pipeline->pause();
         break;
 
     // measurement paused
     // -> resume measurement
     case DataSource::Status::PAUSED:
         QMetaObject::invokeMethod(source, "start", Qt::QueuedConnection);
+        for (auto pipeline : devicePipelines)
+            pipeline->start();
         break;
 
     // no measurement running
@@ -957,6 +1721,8 @@ void Controler::startMeasurement()
         mData->setDataChanged(false);
 
         QMetaObject::invokeMethod(source, "start", Qt::QueuedConnection);
+        for (auto pipeline : devicePipelines)
+            pipeline->start();    // additional devices already measuring keep their measurement
 //        qDebug() << "New measurement started!";
         break;
     }
@@ -973,6 +1739,8 @@ void Controler::stopMeasurement()
         Q_ASSERT("Error: Connection is not open!" && static_cast<USBDataSource*>(source)->getSerial()->isOpen());
 
     QMetaObject::invokeMethod(source, "stop", Qt::QueuedConnection);
+    for (auto pipeline : devicePipelines)
+        pipeline->stop();
 }
 
 void Controler::pauseMeasurement()
@@ -983,6 +1751,8 @@ void Controler::pauseMeasurement()
         Q_ASSERT("Error: Connection is not open!" && static_cast<USBDataSource*>(source)->getSerial()->isOpen());
 
     QMetaObject::invokeMethod(source, "pause", Qt::QueuedConnection);
+    for (auto pipeline : devicePipelines)
+        pipeline->pause();
 }
 
 void Controler::resetMeasurement()
@@ -993,6 +1763,8 @@ void Controler::resetMeasurement()
         Q_ASSERT("Error: Connection is not open!" && static_cast<USBDataSource*>(source)->getSerial()->isOpen());
 
     QMetaObject::invokeMethod(source, "reset", Qt::QueuedConnection);
+    for (auto pipeline : devicePipelines)
+        pipeline->reset();
 }
 
 void Controler::reconnectMeasurement()
@@ -1055,6 +1827,262 @@ void Controler::deleteGroundTruthOfSelection()
     mData->setUserAnnotationOfSelection(Annotation());
 }
 
+/*!
+ * \brief Controler::evaluateClassifier evaluates the classifier set by the command line arguments on the measurement files and directories given
+ * and writes the results as json. The input size of the classifier is checked per file. Returns true if at least one file was evaluated.
+ */
+bool Controler::evaluateClassifier()
+{
+    QStringList filenames = ClassifierEvaluation::measurementFiles(parseResult.filenames);
+    if (filenames.isEmpty())
+    {
+        qWarning() << "No measurement files to evaluate: pass the files or directories as arguments.";
+        return false;
+    }
+
+    bool loadOk;
+    QString errorString;
+    std::unique_ptr<Classifier> model(loadModel(parseResult.evaluateClassifier, 0, nullptr, &loadOk, &errorString));
+    if (!loadOk)
+    {
+        qWarning().noquote() << "Error loading model:" << errorString;
+        return false;
+    }
+
+    ClassifierEvaluation::Settings evaluationSettings;
+    evaluationSettings.batchSize = classifierBatchSize;
+    evaluationSettings.nReaders = parseResult.evaluationReaders;
+    evaluationSettings.nInferenceThreads = parseResult.evaluationThreads;
+    ClassifierEvaluation evaluation(model.get(), evaluationSettings);
+
+    QJsonObject result = evaluation.run(filenames);
+    result["file"] = parseResult.evaluateClassifier;
+    result["classifierSettings"] = classifierSettings.toString();
+
+    writeJsonReport(result, parseResult.benchmarkOutput);
+    return result["nFilesFailed"].toInt() < filenames.size();
+}
+
+/*!
+ * \brief Controler::compareQuantizedClassifier compares the int8 version of the TorchScript classifier set by the command line arguments to the float version
+ * on the measurement file loaded. Writes the accuracy of both against the user annotations, the agreement of their predictions and the speedup as json.
+ * The quantized engine is taken from the general settings, "auto" if quantization is switched off there.
+ * Returns true if the comparison was run.
+ */
+bool Controler::compareQuantizedClassifier()
+{
+#ifdef TORCH_BACKEND
+    if (mData->getAbsoluteData().isEmpty())
+    {
+        qWarning() << "No validation measurement loaded: pass the measurement file as argument.";
+        return false;
+    }
+
+    int nInputs = mData->getFunctionalisation().getFuncMap(mData->getSensorFailures()).size();
+
+    Classifier::Settings floatSettings = classifierSettings;
+    floatSettings.quantization = "off";
+    Classifier::Settings int8Settings = classifierSettings;
+    if (int8Settings.quantization == "off")
+        int8Settings.quantization = "auto";
+
+    bool floatLoadOk, int8LoadOk;
+    QString floatErrorString, int8ErrorString;
+    TorchClassifier floatModel(nullptr, parseResult.compareQuantized, &floatLoadOk, &floatErrorString, nInputs, floatSettings);
+    TorchClassifier int8Model(nullptr, parseResult.compareQuantized, &int8LoadOk, &int8ErrorString, nInputs, int8Settings);
+    if (!floatLoadOk || !int8LoadOk)
+    {
+        qWarning().noquote() << "Error loading model:" << floatErrorString + int8ErrorString;
+        return false;
+    }
+    if (!int8Model.getIsQuantized())
+    {
+        qWarning() << "Classifier could not be quantized.";
+        return false;
+    }
+
+    QList<Annotation> labels;
+    std::vector<std::vector<double>> inputs = ClassifierEvaluation::measurementInputs(&floatModel, mData, &labels);
+
+    // latency of live classification: one input per call; throughput of classifying the measurement: batches
+    std::vector<std::vector<double>> liveInputs(inputs.begin(), inputs.begin() + static_cast<long>(qMin(inputs.size(), static_cast<size_t>(parseResult.benchmarkIterations))));
+    auto timeCall = [](const std::function<void()> &call){
+        QElapsedTimer timer;
+        timer.start();
+        call();
+        return timer.nsecsElapsed() * 1e-6;
+    };
+
+    QList<Annotation> floatAnnotations, int8Annotations;
+    double floatLiveTime, int8LiveTime, floatBatchTime, int8BatchTime;
+    try {
+        floatLiveTime = timeCall([&](){ floatModel.getAnnotations(liveInputs, 1); });
+        int8LiveTime = timeCall([&](){ int8Model.getAnnotations(liveInputs, 1); });
+        floatBatchTime = timeCall([&](){ floatAnnotations = floatModel.getAnnotations(inputs, classifierBatchSize); });
+        int8BatchTime = timeCall([&](){ int8Annotations = int8Model.getAnnotations(inputs, classifierBatchSize); });
+    } catch (std::exception& e) {
+        qWarning() << "Classifier comparison failed:" << e.what();
+        return false;
+    }
+
+    // accuracy: predictions equal to the user annotation, inputs without user annotation are skipped
+    int nLabelled = 0, nFloatCorrect = 0, nInt8Correct = 0, nAgreeing = 0;
+    double maxDifference = 0.0, differenceSum = 0.0;
+    int nValues = 0;
+    for (int i=0; i<floatAnnotations.size(); i++)
+    {
+        QStringList floatPrediction = ClassifierEvaluation::predictionNames(floatAnnotations[i]);
+        QStringList int8Prediction = ClassifierEvaluation::predictionNames(int8Annotations[i]);
+        if (floatPrediction == int8Prediction)
+            nAgreeing++;
+
+        if (!labels[i].isEmpty())
+        {
+            QStringList label = ClassifierEvaluation::labelNames(labels[i]);
+
+            nLabelled++;
+            nFloatCorrect += floatPrediction == label;
+            nInt8Correct += int8Prediction == label;
+        }
+
+        QHash<QString, double> int8Values;
+        for (const aClass &aclass : int8Annotations[i].getClasses())
+            int8Values[aclass.getName()] = aclass.getValue();
+        for (const aClass &aclass : floatAnnotations[i].getClasses())
+        {
+            double difference = qAbs(aclass.getValue() - int8Values.value(aclass.getName(), 0.0));
+            maxDifference = qMax(maxDifference, difference);
+            differenceSum += difference;
+            nValues++;
+        }
+    }
+
+    QJsonObject result;
+    result["model"] = floatModel.getName();
+    result["file"] = parseResult.compareQuantized;
+    result["validationFile"] = parseResult.filename;
+    result["quantizedEngine"] = int8Model.getQuantizedEngine();
+    result["nInputs"] = static_cast<int>(inputs.size());
+    result["nLabelled"] = nLabelled;
+    result["predictionAgreement"] = inputs.empty() ? 0.0 : static_cast<double>(nAgreeing) / inputs.size();
+    result["maxProbabilityDifference"] = maxDifference;
+    result["meanProbabilityDifference"] = nValues > 0 ? differenceSum / nValues : 0.0;
+    if (nLabelled > 0)
+    {
+        double floatAccuracy = static_cast<double>(nFloatCorrect) / nLabelled;
+        double int8Accuracy = static_cast<double>(nInt8Correct) / nLabelled;
+        result["floatAccuracy"] = floatAccuracy;
+        result["int8Accuracy"] = int8Accuracy;
+        result["accuracyDelta"] = int8Accuracy - floatAccuracy;
+    }
+    result["floatLiveLatencyMs"] = liveInputs.empty() ? 0.0 : floatLiveTime / liveInputs.size();
+    result["int8LiveLatencyMs"] = liveInputs.empty() ? 0.0 : int8LiveTime / liveInputs.size();
+    result["liveSpeedup"] = int8LiveTime > 0.0 ? floatLiveTime / int8LiveTime : 0.0;
+    result["floatBatchTimeMs"] = floatBatchTime;
+    result["int8BatchTimeMs"] = int8BatchTime;
+    result["batchSpeedup"] = int8BatchTime > 0.0 ? floatBatchTime / int8BatchTime : 0.0;
+    result["batchSize"] = classifierBatchSize;
+
+    writeJsonReport(result, parseResult.benchmarkOutput);
+    return true;
+#else
+    qWarning() << "This version was built without libtorch: TorchScript classifiers can't be quantized.";
+    return false;
+#endif
+}
+
+/*!
+ * \brief Controler::loadModel loads the classifier \a filename with the backend matching its extension:
+ * MlpClassifier for MLP_CLASSIFIER_EXTENSION, TorchClassifier otherwise. Returns nullptr if the backend is not available.
+ * Errors are reported as by the classifier constructors: \a loadOk is set to false and \a errorString describes the problem.
+ */
+Classifier *Controler::loadModel(QString filename, int nInputs, QObject *parent, bool *loadOk, QString *errorString)
+{
+    if (filename.endsWith(MLP_CLASSIFIER_EXTENSION, Qt::CaseInsensitive))
+        return new MlpClassifier(parent, filename, loadOk, errorString, nInputs, classifierSettings);
+
+#ifdef TORCH_BACKEND
+    return new TorchClassifier(parent, filename, loadOk, errorString, nInputs, classifierSettings);
+#else
+    *loadOk = false;
+    *errorString += "This version was built without libtorch: TorchScript classifiers have to be converted with --export-mlp to be loaded.\n";
+    return nullptr;
+#endif
+}
+
+/*!
+ * \brief Controler::exportMlpClassifier converts the TorchScript classifier set by the command line arguments for the built-in MLP backend.
+ * The conversion is checked by classifying synthetic inputs with both models: the class probabilities have to agree within MLP_EXPORT_TOLERANCE
+ * and the predictions have to be the same. Returns true if the classifier was converted and passed the check.
+ */
+bool Controler::exportMlpClassifier()
+{
+#ifdef TORCH_BACKEND
+    QString mlpFilename = parseResult.exportMlpOutput;
+    if (mlpFilename.isEmpty())
+    {
+        QFileInfo fileInfo(parseResult.exportMlp);
+        mlpFilename = fileInfo.path() + "/" + fileInfo.completeBaseName() + MLP_CLASSIFIER_EXTENSION;
+    }
+
+    QString errorString;
+    if (!TorchClassifier::exportMlp(parseResult.exportMlp, mlpFilename, &errorString))
+    {
+        qWarning().noquote() << "Could not convert classifier:" << errorString;
+        return false;
+    }
+
+    bool torchLoadOk, mlpLoadOk;
+    QString torchErrorString, mlpErrorString;
+    // the float model is the reference of the conversion
+    Classifier::Settings floatSettings = classifierSettings;
+    floatSettings.quantization = "off";
+    TorchClassifier torchModel(nullptr, parseResult.exportMlp, &torchLoadOk, &torchErrorString, 0, floatSettings);
+    MlpClassifier mlpModel(nullptr, mlpFilename, &mlpLoadOk, &mlpErrorString, 0, classifierSettings);
+    if (!torchLoadOk || !mlpLoadOk)
+    {
+        qWarning().noquote() << "Error loading model:" << torchErrorString + mlpErrorString;
+        return false;
+    }
+
+    std::vector<std::vector<double>> inputs = ClassifierBenchmark::syntheticInputs(parseResult.benchmarkVectors, torchModel.getInputWidth());
+    QList<Annotation> torchAnnotations, mlpAnnotations;
+    try {
+        torchAnnotations = torchModel.getAnnotations(inputs, classifierBatchSize);
+        mlpAnnotations = mlpModel.getAnnotations(inputs, classifierBatchSize);
+    } catch (std::exception& e) {
+        qWarning() << "Classifier check failed:" << e.what();
+        return false;
+    }
+
+    double maxDifference = 0.0;
+    int nPredictionsDiffering = 0;
+    for (int i=0; i<torchAnnotations.size(); i++)
+    {
+        QHash<QString, double> mlpValues;
+        for (const aClass &aclass : mlpAnnotations[i].getClasses())
+            mlpValues[aclass.getName()] = aclass.getValue();
+
+        for (const aClass &aclass : torchAnnotations[i].getClasses())
+            maxDifference = qMax(maxDifference, qAbs(aclass.getValue() - mlpValues.value(aclass.getName(), -1.0)));
+
+        if (ClassifierEvaluation::predictionNames(torchAnnotations[i]) != ClassifierEvaluation::predictionNames(mlpAnnotations[i]))
+            nPredictionsDiffering++;
+    }
+
+    bool passed = maxDifference <= MLP_EXPORT_TOLERANCE && nPredictionsDiffering == 0;
+    qDebug().noquote() << "Converted" << parseResult.exportMlp << "to" << mlpFilename << ":" << inputs.size() << "inputs checked, max probability difference"
+                       << QString::number(maxDifference, 'g', 3) << "," << nPredictionsDiffering << "predictions differing ->" << (passed ? "passed" : "FAILED");
+    if (!passed)
+        qWarning() << "The converted classifier does not match the TorchScript model: activations called in forward() or unsupported layers are not converted.";
+
+    return passed;
+#else
+    qWarning() << "This version was built without libtorch: TorchScript classifiers can't be converted.";
+    return false;
+#endif
+}
+
 void Controler::loadClassifier()
 {
     QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
@@ -1063,12 +2091,18 @@ void Controler::loadClassifier()
     QString classiferPath = settings.value(CLASSIFIER_DIR_KEY, DEFAULT_CLASSIFIER_DIR).toString();
 
     // get path to classifier
-    QString filename = QFileDialog::getOpenFileName(w, tr("Load smell classifier"), classiferPath, "TorchScript Files (*.pt)");
-    if (filename == "")
+    // several files selected: load an ensemble of the classifiers
+#ifdef TORCH_BACKEND
+    QString filter = "Classifiers (*.pt *" MLP_CLASSIFIER_EXTENSION ");;TorchScript Files (*.pt);;MLP Classifiers (*" MLP_CLASSIFIER_EXTENSION ")";
+#else
+    QString filter = "MLP Classifiers (*" MLP_CLASSIFIER_EXTENSION ")";
+#endif
+    QStringList filenames = QFileDialog::getOpenFileNames(w, tr("Load smell classifier"), classiferPath, filter);
+    if (filenames.isEmpty())
         return;
 
     // save classifier path
-    QStringList filePath = filename.split("/");
+    QStringList filePath = filenames.first().split("/");
     filePath.removeLast();
     settings.setValue(CLASSIFIER_DIR_KEY, filePath.join("/"));
 
@@ -1084,14 +2118,40 @@ void Controler::loadClassifier()
     auto sensorFailures = mData->getSensorFailures();
     auto funcMap = functionalisation.getFuncMap(sensorFailures);
 
-    classifier = new TorchClassifier(this, filename, &loadOk, &errorString, funcMap.size());
+    QList<Classifier*> models;
+    for (QString filename : filenames)
+    {
+        Classifier *model = loadModel(filename, funcMap.size(), this, &loadOk, &errorString);
+        if (model != nullptr)
+            models << model;
 
-    // loading classifier failed
-    if (!loadOk)
+        // loading classifier failed
+        if (!loadOk)
+        {
+            if (filenames.size() > 1)
+                errorString = filename + ":\n" + errorString;
+
+            QMessageBox::critical(w, "Error loading model", errorString);
+            qDeleteAll(models);
+            closeClassifier();
+            return;
+        }
+    }
+
+    if (models.size() == 1)
     {
-        QMessageBox::critical(w, "Error loading model", errorString);
-        closeClassifier();
-        return;
+        classifier = models.first();
+    }
+    else
+    {
+        try {
+            classifier = new ClassifierEnsemble(this, models, ensembleMergeRule);
+        } catch (std::invalid_argument& e) {
+            QMessageBox::critical(w, "Error loading ensemble", e.what());
+            qDeleteAll(models);
+            closeClassifier();
+            return;
+        }
     }
     // store changed status to reset after adding new classes
     // loading a classifier should not change the measurement!
@@ -1122,63 +2182,280 @@ void Controler::loadClassifier()
     QString presetName =  classifier->getPresetName();
 
     w->setClassifier(name, classNames, isInputAbsolute, presetName);
+
+    // inputs classified before by the same model are taken from the cache
+    classifier->setCache(&classificationCache);
+
+    liveWindow.reset(classifier->getN(), classifier->getWindowLength());
+
+    // live classification
+    // results queued by a previous classifier are ignored
+    quint64 generation = ++classifierGeneration;
+    liveClassifier = new LiveClassifier(classifier);
+    retainClassifier(liveClassifier->getThread());
+    connect(liveClassifier, &LiveClassifier::annotationReady, this, [this, generation](Annotation annotation){
+        if (generation == classifierGeneration)
+            w->setClassifierWidgetAnnotation(annotation);
+    });
+    connect(liveClassifier, &LiveClassifier::error, this, [this, generation](QString errorString){
+        if (generation != classifierGeneration)
+            return;
+
+        // a failing model fails for every vector: one dialog at a time, further errors are logged
+        if (liveErrorShown || (liveErrorTimer.isValid() && liveErrorTimer.elapsed() < LIVE_CLASSIFIER_ERROR_INTERVAL * 1000))
+        {
+            qWarning() << "Classifier error:" << errorString;
+            return;
+        }
+
+        QString error_message = errorString + QString("\nDo you want to close the classifier?");
+
+        liveErrorShown = true;
+        QMessageBox::StandardButton answer = QMessageBox::question(w, "Classifier error", error_message);
+        liveErrorShown = false;
+        liveErrorTimer.start();
+
+        if (answer == QMessageBox::StandardButton::Yes && generation == classifierGeneration)
+        {
+            closeClassifier();
+        }
+    });
 }
 
 void Controler::closeClassifier()
 {
-    delete classifier;
+    stopClassification();
+
+    if (liveClassifier != nullptr)
+    {
+        // deletes itself when its thread finished
+        qDebug().noquote() << liveClassifier->statistics();
+        liveClassifier->stop();
+        liveClassifier = nullptr;
+    }
+    classifierGeneration++;
+    liveErrorTimer.invalidate();
+
+    if (classifier != nullptr)
+        qDebug().noquote() << classificationCache.statistics();
+
+    if (auto ensemble = qobject_cast<ClassifierEnsemble*>(classifier))
+        qDebug().noquote() << ensemble->statistics();
+
+    // deleted when the last thread using it finished
+    if (!classifierThreads.contains(classifier))
+        delete classifier;
     classifier = nullptr;
 
     w->closeClassifier();
 }
 
-void Controler::classifyMeasurement()
+/*!
+ * \brief Controler::retainClassifier keeps the classifier until \a thread finished. Has to be called before \a thread can finish.
+ * A classifier closed while threads still use it is deleted when the last one finished.
+ */
+void Controler::retainClassifier(QThread *thread)
 {
-    // get measurement data
-    QMap<uint, AbsoluteMVector> measDataMap = mData->getAbsoluteData();
+    Classifier *usedClassifier = classifier;
+    classifierThreads.insert(usedClassifier, thread);
 
-    // classify
-    for (uint timestamp : measDataMap.keys())
-    {
-        MVector vector = classifier->getIsInputAbsolute() ? static_cast<MVector>(measDataMap[timestamp]) : static_cast<MVector>(measDataMap[timestamp].getRelativeVector());
-        auto funcVector = vector.getFuncVector(mData->getFunctionalisation(), mData->getSensorFailures(), classifier->getInputFunctionType());
-        try {
-            Annotation annotation = classifier->getAnnotation(funcVector.getVector());
-            mData->setDetectedAnnotation(annotation, timestamp);
-        } catch (std::invalid_argument& e) {
-            QString error_message = e.what() + QString("\nDo you want to close the classifier?");
+    connect(thread, &QThread::finished, this, [this, usedClassifier, thread](){
+        // threads deleted before are finished as well
+        auto it = classifierThreads.find(usedClassifier);
+        while (it != classifierThreads.end() && it.key() == usedClassifier)
+            it = it.value().isNull() || it.value() == thread ? classifierThreads.erase(it) : std::next(it);
 
-            QMessageBox::StandardButton answer = QMessageBox::question(w, "Classifier error", error_message);
-            if (answer == QMessageBox::StandardButton::Yes)
-            {
-                closeClassifier();
-            }
-
-            break;
-        }
-    }
+        if (usedClassifier != classifier && !classifierThreads.contains(usedClassifier))
+            delete usedClassifier;
+    });
 }
 
-void Controler::classifyVector(AbsoluteMVector vector)
+/*!
+ * \brief Controler::classifyMeasurement classifies a snapshot of the measurement data in a separate thread.
+ * The detected annotations are set at once when all vectors were classified. The classification can be cancelled in the progress dialog.
+ */
+void Controler::classifyMeasurement()
 {
-    if (classifier == nullptr)
+    if (classifier == nullptr || classificationWorker != nullptr)
         return;
 
-    MVector inputVector = classifier->getIsInputAbsolute() ? static_cast<MVector>(vector) : static_cast<MVector>(vector.getRelativeVector());
-    auto funcVector = vector.getFuncVector(mData->getFunctionalisation(), mData->getSensorFailures(), classifier->getInputFunctionType());
+    // snapshot of the classifier inputs
+    QMap<uint, MVector> inputData;
+    if (classifier->getIsInputAbsolute())
+    {
+        auto absoluteData = mData->getAbsoluteData();
+        for (auto it = absoluteData.constBegin(); it != absoluteData.constEnd(); ++it)
+            inputData.insert(it.key(), it.value());
+    }
+    else
+    {
+        auto relativeData = mData->getRelativeData();
+        for (auto it = relativeData.constBegin(); it != relativeData.constEnd(); ++it)
+            inputData.insert(it.key(), it.value());
+    }
 
-    try {
-        Annotation annotation = classifier->getAnnotation(funcVector.getVector());
-        w->setClassifierWidgetAnnotation(annotation);
-    } catch (std::invalid_argument& e) {
-        QString error_message = e.what() + QString("\nDo you want to close the classifier?");
+    if (inputData.isEmpty())
+        return;
+
+    // run worker in separate thread
+    ClassificationWorker *worker = new ClassificationWorker(classifier, inputData, mData->getFunctionalisation(), mData->getSensorFailures(), classifierBatchSize);
+    classificationWorker = worker;
+    classificationThread = new QThread(this);
+    worker->moveToThread(classificationThread);
+
+    connect(classificationThread, &QThread::started, worker, &ClassificationWorker::classify);
+    connect(classificationThread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(classificationThread, &QThread::finished, classificationThread, &QObject::deleteLater);
+
+    // progress dialog
+    classificationProgress = new QProgressDialog("Classifying measurement...", "Cancel", 0, 100, w);
+    classificationProgress->setWindowTitle("Classifier");
+    classificationProgress->setWindowModality(Qt::WindowModal);
+    classificationProgress->setMinimumDuration(500);
+    connect(worker, &ClassificationWorker::progressChanged, classificationProgress, &QProgressDialog::setValue);
+    connect(classificationProgress, &QProgressDialog::canceled, worker, &ClassificationWorker::cancel, Qt::DirectConnection);
+
+    // results
+    // signals queued before the worker was stopped are ignored
+    connect(worker, &ClassificationWorker::finished, this, [this, worker](QMap<uint, Annotation> annotations){
+        if (worker != classificationWorker)
+            return;
+
+        stopClassification();
+        mData->setDetectedAnnotations(annotations);
+
+        QString cacheStatistics = classificationCache.statistics();
+        qDebug().noquote() << cacheStatistics;
+        w->statusBar()->showMessage(cacheStatistics, 10000);
+
+        if (auto ensemble = qobject_cast<ClassifierEnsemble*>(classifier))
+            qDebug().noquote() << ensemble->statistics();
+    });
+    connect(worker, &ClassificationWorker::cancelled, this, [this, worker](){
+        if (worker == classificationWorker)
+            stopClassification();
+    });
+    connect(worker, &ClassificationWorker::error, this, [this, worker](QString errorString){
+        if (worker != classificationWorker)
+            return;
+
+        stopClassification();
+
+        QString error_message = errorString + QString("\nDo you want to close the classifier?");
 
         QMessageBox::StandardButton answer = QMessageBox::question(w, "Classifier error", error_message);
         if (answer == QMessageBox::StandardButton::Yes)
         {
             closeClassifier();
         }
+    });
+
+    retainClassifier(classificationThread);
+    classificationThread->start();
+}
+
+/*!
+ * \brief Controler::stopClassification stops a running classification after the current batch without waiting for its thread.
+ * Annotations of a classification stopped before it finished are discarded.
+ */
+void Controler::stopClassification()
+{
+    if (classificationWorker == nullptr)
+        return;
+
+    // worker stops after the current batch
+    classificationWorker->cancel();
+    classificationThread->quit();
+
+    classificationWorker = nullptr;
+    classificationThread = nullptr;
+
+    classificationProgress->deleteLater();
+    classificationProgress = nullptr;
+}
+
+/*!
+ * \brief Controler::classifyVector submits \a vector to the live classifier. The classifier widget is updated when the result is ready.
+ */
+void Controler::classifyVector(AbsoluteMVector vector)
+{
+    if (classifier == nullptr || liveClassifier == nullptr)
+        return;
+
+    liveClassifier->submit(getClassifierFuncVector(vector));
+}
+
+/*!
+ * \brief Controler::addLiveVector adds \a vector received to the live classification and submits it if \a classify is set.
+ * Classifiers with an input window get the window of the latest vectors received every window stride vectors.
+ */
+void Controler::addLiveVector(AbsoluteMVector vector, bool classify)
+{
+    if (classifier == nullptr || liveClassifier == nullptr)
+        return;
+
+    int windowLength = classifier->getWindowLength();
+    bool windowSlopes = classifier->getWindowSlopes();
+    if (windowLength == 1 && !windowSlopes)
+    {
+        if (classify)
+            classifyVector(vector);
+        return;
     }
+
+    std::vector<double> funcVector = getClassifierFuncVector(vector);
+    if (static_cast<int>(funcVector.size()) != liveWindow.getNChannels())
+        liveWindow.reset(static_cast<int>(funcVector.size()), windowLength);
+    liveWindow.push(funcVector);
+
+    if (!classify || liveWindow.getSize() < windowLength || (liveWindow.getNPushed() - static_cast<quint64>(windowLength)) % static_cast<quint64>(classifier->getWindowStride()) != 0)
+        return;
+
+    liveWindowInput.resize(static_cast<size_t>(FuncWindowBuffer::inputWidth(liveWindow.getNChannels(), windowLength, windowSlopes)));
+    liveWindow.assemble(windowLength, windowSlopes, liveWindowInput.data());
+    liveClassifier->submit(liveWindowInput);
+}
+
+/*!
+ * \brief Controler::classifySelectionWindow submits the window of vectors ending at the last vector selected to the live classifier.
+ * Nothing is classified if less vectors than the window length were measured until the end of the selection.
+ */
+void Controler::classifySelectionWindow()
+{
+    if (classifier == nullptr || liveClassifier == nullptr || mData->getSelectionMap().isEmpty())
+        return;
+
+    int windowLength = classifier->getWindowLength();
+    bool windowSlopes = classifier->getWindowSlopes();
+    const QMap<uint, AbsoluteMVector> &absoluteData = mData->getAbsoluteData();
+
+    auto end = absoluteData.upperBound(mData->getSelectionMap().lastKey());
+    if (std::distance(absoluteData.begin(), end) < windowLength)
+        return;
+
+    FuncWindowBuffer selectionWindow;
+    auto it = end;
+    std::advance(it, -windowLength);
+    for (; it != end; ++it)
+    {
+        std::vector<double> funcVector = getClassifierFuncVector(it.value());
+        if (selectionWindow.getCapacity() == 0)
+            selectionWindow.reset(static_cast<int>(funcVector.size()), windowLength);
+        selectionWindow.push(funcVector);
+    }
+
+    std::vector<double> input(static_cast<size_t>(FuncWindowBuffer::inputWidth(selectionWindow.getNChannels(), windowLength, windowSlopes)));
+    selectionWindow.assemble(windowLength, windowSlopes, input.data());
+    liveClassifier->submit(input);
+}
+
+/*!
+ * \brief Controler::getClassifierFuncVector returns the func vector of \a vector as input of the classifier: absolute or relative, with the classifier's input function.
+ */
+std::vector<double> Controler::getClassifierFuncVector(AbsoluteMVector vector) const
+{
+    MVector inputVector = classifier->getIsInputAbsolute() ? static_cast<MVector>(vector) : static_cast<MVector>(vector.getRelativeVector());
+    return inputVector.getFuncVector(mData->getFunctionalisation(), mData->getSensorFailures(), classifier->getInputFunctionType()).getVector();
 }
 
 void Controler::updateAutosave()
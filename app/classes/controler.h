@@ -2,13 +2,27 @@
 #define CONTROLER_H
 
 #include <QObject>
+#include <QElapsedTimer>
+#include <QProgressDialog>
+#include <QPointer>
 
 #include "../widgets/mainwindow.h"
 
 #include "measurementdata.h"
 #include "datasource.h"
+#include "devicepipeline.h"
+#include "devicesimulator.h"
 #include "mvector.h"
+#ifdef TORCH_BACKEND
 #include "torchclassifier.h"
+#endif
+#include "mlpclassifier.h"
+#include "classificationworker.h"
+#include "classificationcache.h"
+#include "classifierensemble.h"
+#include "classifierevaluation.h"
+#include "funcwindowbuffer.h"
+#include "liveclassifier.h"
 #include "classifier_definitions.h"
 #include "clouduploader.h"
 
@@ -18,12 +32,51 @@ public:
     ParseResult() {}
 
     QString filename;
+    QStringList filenames;      // all positional arguments
     bool curveFit = false;
     int timeout = -1;
     int nCores = -1;
     int tOffset = 0;
     int tExposition = -1;
     int tRecovery = CVWIZ_DEFAULT_RECOVERY_TIME;
+    double fitTargetError = CVWIZ_DEFAULT_TARGET_ERROR;
+    quint64 fitSeed = LEAST_SQUARES_SEED;
+    QString fitTimingsFile;
+    bool fitColdStart = false;
+    QStringList devices;
+    QString replayFile;
+    double replaySpeed = 1.0;
+    QString captureDir;
+    bool binaryProtocol = false;
+    double stressRate = 0.0;
+    int stressChannels = 64;
+    int stressAttributes = 2;
+    double stressEventRate = 0.0;
+    int stressDuration = 0;
+    QString simulateProtocol;
+    double simulateRate = 1.0;
+    int simulateChannels = 64;
+    double simulateEventRate = 0.0;
+    bool simulateBinary = false;
+    QString benchmarkClassifier;
+    QString benchmarkOutput;
+    bool benchmarkFitter = false;
+    QList<int> benchmarkBatchSizes{1, 8, 64, 256};
+    QList<int> benchmarkThreads{0};
+    int benchmarkIterations = 200;
+    int benchmarkVectors = 1000;
+    QString exportMlp;
+    QString exportMlpOutput;
+    QString compareQuantized;
+    QString evaluateClassifier;
+    int evaluationReaders = 2;
+    int evaluationThreads = 0;
+
+    // runs a command line task and quits without showing the gui
+    bool isHeadless() const
+    {
+        return curveFit || !benchmarkClassifier.isEmpty() || benchmarkFitter || !exportMlp.isEmpty() || !compareQuantized.isEmpty() || !evaluateClassifier.isEmpty();
+    }
 
     QString toString()
     {
@@ -32,6 +85,17 @@ public:
         resultString += "curveFit:\t" + QString::number(curveFit) + "\n";
         resultString += "timeout:\t" + QString::number(timeout) + "\n";
         resultString += "nCores:\t" + QString::number(nCores) + "\n";
+        resultString += "devices:\t" + devices.join(", ") + "\n";
+        resultString += "replayFile:\t" + replayFile + "\n";
+        resultString += "replaySpeed:\t" + QString::number(replaySpeed) + "\n";
+        resultString += "captureDir:\t" + captureDir + "\n";
+        resultString += "stressRate:\t" + QString::number(stressRate) + "\n";
+        resultString += "simulateProtocol:\t" + simulateProtocol + "\n";
+        resultString += "benchmarkClassifier:\t" + benchmarkClassifier + "\n";
+        resultString += "benchmarkFitter:\t" + QString::number(benchmarkFitter) + "\n";
+        resultString += "exportMlp:\t" + exportMlp + "\n";
+        resultString += "compareQuantized:\t" + compareQuantized + "\n";
+        resultString += "evaluateClassifier:\t" + evaluateClassifier + "\n";
 
         return resultString;
     }
@@ -81,16 +145,42 @@ private:
     QTimer autosaveTimer, runningAutoSaveTimer;
     uint runningAutoSaveInterval = 5;
     bool runningAutoSaveEnabled = false;
+    BaselineEstimator::Settings baselineSettings;
 
     MeasurementData *mData = nullptr;
     DataSource *source = nullptr;
-    QThread* sourceThread = nullptr;
-    TorchClassifier *classifier = nullptr;
+    DevicePipeline *sourcePipeline = nullptr;   // pipeline of source, adds to mData
+    QList<DevicePipeline*> devicePipelines;     // additional devices acquired in parallel, not shown in w
+    DeviceSimulator *deviceSimulator = nullptr; // simulated usb device for benchmarks
+    Classifier *classifier = nullptr;                           // single model or ensemble
+    int classifierBatchSize = DEFAULT_CLASSIFIER_BATCH_SIZE;    // inputs per forward pass when classifying a measurement
+    Classifier::Settings classifierSettings;                    // applied when a classifier is loaded
+    ClassificationCache classificationCache{DEFAULT_CLASSIFICATION_CACHE_SIZE};  // annotations of inputs classified, shared by all classifiers loaded
+    int classifierIntraOpThreads = DEFAULT_CLASSIFIER_INTRA_OP_THREADS;
+    int classifierInterOpThreads = DEFAULT_CLASSIFIER_INTER_OP_THREADS;
+    ClassifierEnsemble::MergeRule ensembleMergeRule = ClassifierEnsemble::mergeRuleFromString(DEFAULT_ENSEMBLE_MERGE_RULE);
+    QThread *classificationThread = nullptr;
+    ClassificationWorker *classificationWorker = nullptr;       // set while a measurement is classified
+    QProgressDialog *classificationProgress = nullptr;
+    LiveClassifier *liveClassifier = nullptr;                   // classifies the latest vector received in its own thread
+    quint64 classifierGeneration = 0;                           // incremented per classifier loaded or closed, results of other generations are dropped
+    QElapsedTimer liveErrorTimer;                               // time since the last error dialog of the live classification
+    bool liveErrorShown = false;                                // error dialog of the live classification open
+    QMultiMap<Classifier*, QPointer<QThread>> classifierThreads;   // threads using a classifier, a closed classifier is deleted when they finished
+    FuncWindowBuffer liveWindow;                                // latest func vectors received, for classifiers with an input window
+    std::vector<double> liveWindowInput;
     CloudUploader *uploader = nullptr;
 
     InputFunctionType inputFunctionType = InputFunctionType::medianAverage;
     ParseResult parseResult;
 
+    QElapsedTimer stressClock;  // valid while a stress test is running
+
+    void addLiveVector(AbsoluteMVector vector, bool classify);
+    void classifySelectionWindow();
+    std::vector<double> getClassifierFuncVector(AbsoluteMVector vector) const;
+    void retainClassifier(QThread *thread);
+
 private slots:
     void clearData();
 
@@ -112,6 +202,33 @@ private slots:
 
     void makeSourceConnections();
 
+    void applyBaselineSettings(DataSource *dataSource);
+
+    DevicePipeline *addDevice(QString deviceString);
+
+    void startDeviceSimulator();
+
+    void setReplaySource(QString filename, double speed);
+
+    void setJournalReplaySource(QString filename, double speed);
+
+    QString serialCaptureFile(QString portName);
+
+    void startStressTest();
+
+    void finishStressTest();
+
+    void runClassifierBenchmark();
+    void runFitterBenchmark();
+
+    bool exportMlpClassifier();
+
+    bool compareQuantizedClassifier();
+
+    bool evaluateClassifier();
+
+    Classifier *loadModel(QString filename, int nInputs, QObject *parent, bool *loadOk, QString *errorString);
+
     void startMeasurement();
 
     void stopMeasurement();
@@ -135,6 +252,8 @@ private slots:
 
     void classifyMeasurement();
 
+    void stopClassification();
+
     void classifyVector(AbsoluteMVector vector);
 
     void updateAutosave();
@@ -2,7 +2,6 @@
 
 CurveFitWorker::CurveFitWorker(MeasurementData* mData, QObject *parent):
     QObject(parent),
-    QRunnable(),
     sigmaError(MVector::nChannels, 0.),
     tau90(MVector::nChannels, 0.),
     f_t90(MVector::nChannels, 0.),
@@ -27,30 +26,420 @@ CurveFitWorker::CurveFitWorker(MeasurementData* mData, QObject *parent):
         fitData[timestamp] = relativeData[timestamp];
 }
 
-void CurveFitWorker::run()
+/*!
+ * \struct CurveFitWorker::WarmStart
+ * \brief Fit of the representative channel of a functionalisation group, seeding the fits of the other channels of the group.
+ */
+struct CurveFitWorker::WarmStart
 {
-    Q_ASSERT(ch < mData->nChannels());
+    std::vector<parameter_vector> parameters;   // start parameters of the first restarts of each solver
+    double relativeError = 0.;                  // rms error / plateau of the representative
+};
 
-    if (ch == 0)
-        emit started();
+/*!
+ * \struct CurveFitWorker::ChannelFit
+ * \brief State of the fit of one channel shared by its tasks: a set of restarts for each solver.
+ * A restart reaching the target error stops the restarts with higher indices of its solver,
+ * so the result only depends on the seed, not on the order the tasks are run in.
+ * Warm-started channels first run the restarts from the warm start parameters. The random fallback restarts are only submitted
+ * if none of them was accepted.
+ */
+struct CurveFitWorker::ChannelFit
+{
+    struct SolverFit{
+        std::shared_ptr<LeastSquaresFitter> fitter;
+        std::vector<LeastSquaresFitter::RestartResult> results;
+        std::atomic<int> end;               // restarts >= end are skipped
+        std::atomic<int> nWarmRemaining;    // warm-started restarts not finished
+    };
+
+    size_t channel;
+    std::vector<std::pair<double, double>> channelData;
+    qint64 priority;
+    SolverFit solve, solve_lm;
+    std::atomic<int> nRemaining;            // restarts not finished
+
+    int nWarmStarts = 0;                    // restarts starting from the warm start parameters
+    double warmStartLimit = 0.;             // rms error / plateau accepting a warm-started restart
+
+    // restarts run & their cost
+    std::atomic<int> nRestartsRun{0};
+    std::atomic<qint64> nSolverIterations{0};
+    std::atomic<qint64> restartTime{0};     // in ns, summed over the threads
+
+    SolverFit &solver(bool lm) { return lm ? solve_lm : solve; }
+};
+
+CurveFitWorker::~CurveFitWorker()
+{
+    cancel();
+    waitForDone();
+}
 
-    // select channel to be fitted
-    mutex.lock();
-    size_t channel = ch;
-    ch++;
-    mutex.unlock();
+/*!
+ * \brief CurveFitWorker::start fits all channels in the worker's own TaskExecutor.
+ * Each channel is a task graph: a setup task submits one task per restart and solver, the last restart submits the task selecting the best result.
+ * Restarts of channels with more samples have a higher priority, so the longest fits start first and no channel is left alone at the end.
+ * With warm start, only the representative of each functionalisation group is set up at first. Its result seeds the other channels of the group.
+ * Emits started(), progressChanged() after each channel and finished() & dataSet() after the last one. init() has to be called before.
+ */
+void CurveFitWorker::start()
+{
+    // stop a previous fit
+    cancel();
+    waitForDone();
+
+    int threadCount = nThreads > 0 ? nThreads : QThread::idealThreadCount();
+    if (executor == nullptr || executor->getNThreads() != threadCount)
+        executor.reset(new TaskExecutor(threadCount));
+    executor->clearTimings();
+
+    cancellationToken = CancellationToken();
+    channelsFinished = 0;
+    fitStatistics = FitStatistics();
+    determineGroups();
 
-    // fit channel
-    fitChannel(channel);
+    qDebug() << "thread count:\t" << QString::number(executor->getNThreads());
+    fitTimer.start();
+    emit started();
+
+    for (size_t channel=0; channel<mData->nChannels(); channel++)
+        if (!groupFollowers.contains(channel))
+            submitSetup(channel, WarmStart());
+}
+
+/*!
+ * \brief CurveFitWorker::determineGroups groups the channels by functionalisation if warm start is set.
+ * The representative of a group is the channel with the most samples in its range, the others are its followers.
+ * Failing channels and channels without samples are not grouped. Without a functionalisation (all channels share one value), no channels are grouped.
+ */
+void CurveFitWorker::determineGroups()
+{
+    groupFollowers.clear();
+    followers.clear();
+    if (!warmStart)
+        return;
+
+    auto functionalisation = mData->getFunctionalisation();
+    auto sensorFailures = mData->getSensorFailures();
+
+    // functionalisation not set: channels with one value do not respond alike
+    if (functionalisation.getFuncMap(sensorFailures).size() <= 1)
+        return;
+
+    QMap<int, QList<size_t>> groups;
+    for (size_t channel=0; channel<mData->nChannels(); channel++)
+        if (!sensorFailures[channel] && !dataRange[channel].empty())
+            groups[functionalisation[static_cast<int>(channel)]] << channel;
+
+    for (const QList<size_t> &group : groups)
+    {
+        size_t representative = group.first();
+        for (size_t channel : group)
+            if (dataRange[channel].size() > dataRange[representative].size())
+                representative = channel;
 
-    // signal progress
+        for (size_t channel : group)
+            if (channel != representative)
+            {
+                followers[representative] << channel;
+                groupFollowers << channel;
+            }
+    }
+}
+
+/*!
+ * \brief CurveFitWorker::cancel skips all tasks of the running fit not yet started. finished() is not emitted.
+ */
+void CurveFitWorker::cancel()
+{
+    cancellationToken.cancel();
+}
+
+/*!
+ * \brief CurveFitWorker::waitForDone blocks until the tasks of the fit are finished or skipped.
+ */
+void CurveFitWorker::waitForDone()
+{
+    if (executor != nullptr)
+        executor->waitForDone();
+}
+
+/*!
+ * \brief CurveFitWorker::getTimingStatistics summarises the task timings of the last fit.
+ */
+QString CurveFitWorker::getTimingStatistics() const
+{
+    return executor != nullptr ? executor->statistics() : "no fit run";
+}
+
+/*!
+ * \brief CurveFitWorker::getWarmStartStatistics summarises the restarts, solver iterations and restart time of the cold and warm-started channels of the last fit.
+ * The cold channels are mostly the group representatives, which have the most samples of their group, so the restart time of the warm-started channels
+ * as cold fits is estimated per sample: the restart time per sample of the cold channels times the samples of the warm-started channels.
+ * Solver iterations do not scale with the samples and are estimated per channel.
+ * Times are summed over the threads. The measured saving is the difference to the wall time of a fit with --fit-cold-start.
+ */
+QString CurveFitWorker::getWarmStartStatistics() const
+{
+    QMutexLocker locker(&mutex);
+    const FitStatistics &statistics = fitStatistics;
+
+    QString summary = QString("fit wall time %1 ms, %2 cold channels: %3 restarts, %4 solver iterations")
+            .arg(statistics.wallTime, 0, 'f', 1).arg(statistics.nColdChannels).arg(statistics.coldRestarts).arg(statistics.coldIterations);
+    if (statistics.nWarmChannels == 0 || statistics.nColdChannels == 0)
+        return summary + ", no warm-started channels";
+
+    if (statistics.coldSamples == 0 || statistics.warmSamples == 0)
+        return summary + QString(", %1 warm-started channels without samples").arg(statistics.nWarmChannels);
+
+    // cold cost of the warm-started channels: time per sample, iterations per channel
+    double estimatedTime = statistics.coldTime * 1e-6 * statistics.warmSamples / statistics.coldSamples;
+    double estimatedIterations = static_cast<double>(statistics.coldIterations) * statistics.nWarmChannels / statistics.nColdChannels;
+
+    return summary + QString(", %1 ms restart time for %2 samples; %3 warm-started channels (%4 of %5 solves without fallback): %6 restarts, "
+                             "%7 solver iterations, %8 ms restart time for %9 samples; estimated as cold fits: %10 solver iterations, %11 ms restart time "
+                             "(compare the wall time with --fit-cold-start for the measured saving)")
+            .arg(statistics.coldTime * 1e-6, 0, 'f', 1).arg(statistics.coldSamples)
+            .arg(statistics.nWarmChannels).arg(statistics.nWarmAccepted).arg(2 * statistics.nWarmChannels).arg(statistics.warmRestarts)
+            .arg(statistics.warmIterations).arg(statistics.warmTime * 1e-6, 0, 'f', 1).arg(statistics.warmSamples)
+            .arg(estimatedIterations, 0, 'f', 0).arg(estimatedTime, 0, 'f', 1);
+}
+
+/*!
+ * \brief CurveFitWorker::saveTimings saves the timings of the tasks of the last fit to \a filePath.
+ */
+bool CurveFitWorker::saveTimings(QString filePath) const
+{
+    return executor != nullptr && executor->saveTimings(filePath);
+}
+
+std::shared_ptr<LeastSquaresFitter> CurveFitWorker::createFitter() const
+{
+    switch (type) {
+    case LeastSquaresFitter::Type::SUPERPOS:
+        return std::make_shared<ADG_superpos_Fitter>();
+    default:
+        throw std::runtime_error("Unknown fitter type!");
+    }
+}
+
+void CurveFitWorker::submitSetup(size_t channel, const WarmStart &warmStart)
+{
+    executor->submit([this, channel, warmStart](){ setupChannel(channel, warmStart); }, std::numeric_limits<qint64>::max(), "setup ch" + QString::number(channel+1), cancellationToken);
+}
+
+/*!
+ * \brief CurveFitWorker::startFollowers sets up the followers of \a channel, warm-started by \a warmStart if it has parameters.
+ */
+void CurveFitWorker::startFollowers(size_t channel, const WarmStart &warmStart)
+{
+    for (size_t follower : followers.value(channel))
+        submitSetup(follower, warmStart);
+}
+
+/*!
+ * \brief CurveFitWorker::setupChannel prepares the restarts of both solvers for \a channel and submits them.
+ * With \a warmStart parameters, the first restarts start from them and nWarmStartRestarts random restarts are the fallback.
+ * Failing channels and channels without a range finish immediately.
+ */
+void CurveFitWorker::setupChannel(size_t channel, WarmStart warmStart)
+{
+    // failing channel: ignore
+    if (mData->getSensorFailures()[channel])
+    {
+        setFitValid(channel, false);
+        qDebug() << "Skipping channel " << channel+1 << " (channel failure)";
+        startFollowers(channel, WarmStart());
+        channelFinished();
+        return;
+    }
+
+    auto channelData = dataRange[channel];
+
+    // no jump found or detected range too small:
+    // ignore
+    if ((channelData.empty() && channelData.size() < 0.15 * fitData.size()) || nIterations <= 0)
+    {
+        startFollowers(channel, WarmStart());
+        channelFinished();
+        return;
+    }
+
+    qDebug() << "Fitting channel " << channel+1 << (warmStart.parameters.empty() ? "" : "(warm start)");
+
+    auto channelFit = std::make_shared<ChannelFit>();
+    channelFit->channel = channel;
+    channelFit->channelData = channelData;
+    channelFit->priority = static_cast<qint64>(channelData.size()) * (nIterations + 1);
+    channelFit->nWarmStarts = static_cast<int>(warmStart.parameters.size());
+    channelFit->warmStartLimit = CVWIZ_WARM_START_TOLERANCE * warmStart.relativeError;
+
+    // warm start: random restarts only as fallback
+    int nRestarts = channelFit->nWarmStarts > 0 ? channelFit->nWarmStarts + qMin(nWarmStartRestarts, nIterations) : nIterations;
+
+    // independent restarts per channel & solver, reproducible for any number of threads
+    for (bool lm : {false, true})
+    {
+        ChannelFit::SolverFit &solverFit = channelFit->solver(lm);
+        solverFit.fitter = createFitter();
+        solverFit.fitter->setSeed(seed + 2 * channel + (lm ? 1 : 0));
+        solverFit.fitter->setTargetError(targetError);
+        solverFit.fitter->setStartParameters(warmStart.parameters);
+        solverFit.fitter->prepareRestarts(channelData, limitFactor, lm ? LeastSquaresFitter::Solver::LevenbergMarquardt : LeastSquaresFitter::Solver::LeastSquares);
+        solverFit.results.resize(static_cast<size_t>(nRestarts));
+        solverFit.end = nRestarts;
+        solverFit.nWarmRemaining = channelFit->nWarmStarts;
+    }
+
+    // cold: all restarts, warm: the fallback restarts are submitted by the last warm-started one
+    int nSubmitted = channelFit->nWarmStarts > 0 ? channelFit->nWarmStarts : nRestarts;
+    channelFit->nRemaining = 2 * nSubmitted;
+    for (bool lm : {false, true})
+        submitRestarts(channelFit, lm, 0, nSubmitted);
+}
+
+/*!
+ * \brief CurveFitWorker::submitRestarts submits the restarts [\a first, \a end) of the solver of \a channelFit selected by \a lm.
+ * Restarts with lower indices first: restarts stopped by a target error are skipped early.
+ */
+void CurveFitWorker::submitRestarts(std::shared_ptr<ChannelFit> channelFit, bool lm, int first, int end)
+{
+    for (int i=first; i<end; i++)
+        executor->submit([this, channelFit, lm, i](){ runRestart(channelFit, lm, i); }, channelFit->priority - i,
+                         QString("ch%1 %2 restart %3").arg(channelFit->channel+1).arg(lm ? "solve_lm" : "solve").arg(i), cancellationToken);
+}
+
+/*!
+ * \brief CurveFitWorker::warmStartAccepted returns true if the warm-started \a result is valid and its rms error relative to its plateau
+ * is within CVWIZ_WARM_START_TOLERANCE times the one of the representative.
+ */
+bool CurveFitWorker::warmStartAccepted(const ChannelFit &channelFit, const LeastSquaresFitter::RestartResult &result) const
+{
+    double plateau = std::abs(result.parameters(0) + result.parameters(3));
+    if (!result.valid || qFuzzyIsNull(plateau))
+        return false;
+
+    double rmsError = std::sqrt(result.error / channelFit.channelData.size());
+    return rmsError / plateau <= channelFit.warmStartLimit;
+}
+
+/*!
+ * \brief CurveFitWorker::runRestart runs restart \a index of the solver of \a channelFit selected by \a lm.
+ * The last warm-started restart of a solver submits its fallback restarts if no warm start was accepted.
+ * The last restart of a channel submits its selection.
+ */
+void CurveFitWorker::runRestart(std::shared_ptr<ChannelFit> channelFit, bool lm, int index)
+{
+    ChannelFit::SolverFit &solverFit = channelFit->solver(lm);
+    bool isWarmStart = index < channelFit->nWarmStarts;
+
+    if (index < solverFit.end)
+    {
+        try {
+            QElapsedTimer timer;
+            timer.start();
+            auto result = solverFit.fitter->runRestart(index);
+            solverFit.results[static_cast<size_t>(index)] = result;
+
+            channelFit->nRestartsRun++;
+            channelFit->nSolverIterations += result.nIterations;
+            channelFit->restartTime += timer.nsecsElapsed();
+
+            // target reached or warm start accepted: skip the following restarts
+            bool stop = solverFit.fitter->reachesTarget(result) || (isWarmStart && warmStartAccepted(*channelFit, result));
+            int end = solverFit.end;
+            while (stop && index + 1 < end && !solverFit.end.compare_exchange_weak(end, index + 1));
+        } catch (dlib::error exception) {
+            error("Error in channel " + QString::number(channelFit->channel) + ": " + QString(exception.what()));
+        }
+    }
+
+    // no warm start accepted: random restarts
+    if (isWarmStart && --solverFit.nWarmRemaining == 0 && solverFit.end > channelFit->nWarmStarts)
+    {
+        int end = solverFit.end;
+        channelFit->nRemaining += end - channelFit->nWarmStarts;
+        submitRestarts(channelFit, lm, channelFit->nWarmStarts, end);
+    }
+
+    if (--channelFit->nRemaining == 0)
+        executor->submit([this, channelFit](){ finishChannel(channelFit); }, std::numeric_limits<qint64>::max(), "select ch" + QString::number(channelFit->channel+1), cancellationToken);
+}
+
+/*!
+ * \brief CurveFitWorker::finishChannel selects the best result of each solver of \a channelFit and stores the better one.
+ * A valid result of a group representative warm-starts the other channels of its group.
+ */
+void CurveFitWorker::finishChannel(std::shared_ptr<ChannelFit> channelFit)
+{
+    channelFit->solve.fitter->setBestResult(channelFit->solve.results, channelFit->solve.end);
+    channelFit->solve_lm.fitter->setBestResult(channelFit->solve_lm.results, channelFit->solve_lm.end);
+
+    size_t channel = channelFit->channel;
+    bool valid = storeFitResult(channel, channelFit->channelData, channelFit->solve.fitter, channelFit->solve_lm.fitter);
+
+    WarmStart warmStart;
+    if (valid && followers.contains(channel))
+    {
+        parameter_vector parameters;
+        for (long i=0; i<parameters.size(); i++)
+            parameters(i) = parameterData[static_cast<int>(i)][channel];
+        warmStart.parameters.push_back(parameters);
+
+        double plateau = std::abs(parameters(0) + parameters(3));
+        warmStart.relativeError = qFuzzyIsNull(plateau) ? 0. : sigmaError[channel] / plateau;
+    }
+    startFollowers(channel, warmStart);
+
+    {
+        QMutexLocker locker(&mutex);
+        if (channelFit->nWarmStarts > 0)
+        {
+            fitStatistics.nWarmChannels++;
+            fitStatistics.warmRestarts += channelFit->nRestartsRun;
+            fitStatistics.warmIterations += channelFit->nSolverIterations;
+            fitStatistics.warmTime += channelFit->restartTime;
+            fitStatistics.warmSamples += channelFit->channelData.size();
+            fitStatistics.nWarmAccepted += (channelFit->solve.end <= channelFit->nWarmStarts) + (channelFit->solve_lm.end <= channelFit->nWarmStarts);
+        }
+        else
+        {
+            fitStatistics.nColdChannels++;
+            fitStatistics.coldRestarts += channelFit->nRestartsRun;
+            fitStatistics.coldIterations += channelFit->nSolverIterations;
+            fitStatistics.coldTime += channelFit->restartTime;
+            fitStatistics.coldSamples += channelFit->channelData.size();
+        }
+    }
+
+    channelFinished();
+}
+
+void CurveFitWorker::setFitValid(size_t channel, bool value)
+{
+    // std::vector<bool> packs the flags of several channels into one word
+    QMutexLocker locker(&mutex);
+    fitValid[channel] = value;
+}
+
+/*!
+ * \brief CurveFitWorker::channelFinished signals the progress. After the last channel finished() and dataSet() are emitted.
+ */
+void CurveFitWorker::channelFinished()
+{
     mutex.lock();
     channelsFinished++;
     emit progressChanged(channelsFinished);
+    bool allFinished = channelsFinished == mData->nChannels();
+    if (allFinished)
+        fitStatistics.wallTime = fitTimer.nsecsElapsed() * 1e-6;
     mutex.unlock();
 
-    if (channelsFinished == mData->nChannels())
+    if (allFinished)
     {
+        qDebug().noquote() << getWarmStartStatistics();
+
         QStringList header = getTableHeader();
         QStringList tooltips = getTooltips();
         auto data = getData();
@@ -62,19 +451,10 @@ void CurveFitWorker::run()
 
 void CurveFitWorker::init()
 {
-    // reset ch
-    ch = 0;
     channelsFinished = 0;
 
     // reset parameters
-    std::unique_ptr<LeastSquaresFitter> fitter;
-    switch (type) {
-    case LeastSquaresFitter::Type::SUPERPOS:
-        fitter.reset(new ADG_superpos_Fitter());
-        break;
-    default:
-        throw std::runtime_error("Unknown fitter type!");
-    }
+    auto fitter = createFitter();
 
     parameterNames = fitter->getParameterNames();
     fitTooltips = fitter->getTooltips();
@@ -265,95 +645,52 @@ void CurveFitWorker::determineChannelRanges()
 }
 
 /*!
- * \brief CurveFitWorker::fitChannel fits LeastSquaresFitter to \param channel.
- * Two fitting algorithms are used multiple times. The best valid result is used and its parameters and metrics are stored.
- * If there is no valid result, fitValid is set to false. Channels with failures are ignored and fitValid also is set to false.
- * \param channel
+ * \brief CurveFitWorker::storeFitResult compares the results of \a fitter and \a fitter_lm for \a channel and stores the parameters and metrics of the better valid one.
+ * If there is no valid result, fitValid is set to false. Returns true if a valid result was stored.
  */
-void CurveFitWorker::fitChannel(size_t channel)
+bool CurveFitWorker::storeFitResult(size_t channel, const std::vector<std::pair<double, double> > &channelData, std::shared_ptr<LeastSquaresFitter> fitter, std::shared_ptr<LeastSquaresFitter> fitter_lm)
 {
-    // failing channel: ignore
-    if (mData->getSensorFailures()[channel])
-    {
-        fitValid[channel] = false;
-        qDebug() << "Skipping channel " << channel+1 << " (channel failure)";
-
-        return;
-    }
-
-    qDebug() << "Fitting channel " << channel+1;
-
-    // init fitter
-    std::shared_ptr<LeastSquaresFitter> fitter, fitter_lm;
-    switch (type) {
-    case LeastSquaresFitter::Type::SUPERPOS:
-        fitter.reset(new ADG_superpos_Fitter());
-        fitter_lm.reset(new ADG_superpos_Fitter());
-        break;
-    default:
-        throw std::runtime_error("Unknown fitter type!");
+    double solve_error = fitter->residual_sum_of_sqares(channelData);
+    double solve_lm_error = fitter_lm->residual_sum_of_sqares(channelData);
+
+    // validate parameters:
+    // invalid results should be ignored in the fitting process,
+    // however edge cases may produce invalid parameters
+    double lastVal = channelData.back().second;
+    bool solve_valid = fitter->parameters_valid(limitFactor * lastVal);
+    bool solve_lm_valid = fitter_lm->parameters_valid(limitFactor * lastVal);
+
+    std::shared_ptr<LeastSquaresFitter> bestFitter;
+    double bestError = qInf();
+    if ( solve_valid && solve_lm_valid ) {   // parameters of both fitters valid
+        bestFitter = solve_error < solve_lm_error ? fitter : fitter_lm;
+        bestError = solve_error < solve_lm_error ? solve_error : solve_lm_error;
+    } else if ( solve_valid ) { // only fitter params valid
+        bestFitter = fitter;
+        bestError = solve_error;
+    } else if ( solve_lm_valid ) {  // only fitter_lm params valid
+        bestFitter = fitter_lm;
+        bestError = solve_lm_error;
+    } else {    // invalid results -> return
+        setFitValid(channel, false);
+        return false;
     }
 
-    auto channelData = dataRange[channel];
-//    for (auto pair : channelData)
-//        qDebug() << pair.first << ", " << pair.second;
+    auto params = bestFitter->getParams();
 
-    // no jump found or detected range too small:
-    // ignore
-    if (!channelData.empty() || !(channelData.size() < 0.15 * fitData.size()))
+    for (size_t i=0; i<params.size(); i++)
     {
-
-        try {
-            // fit curve to channelData:
-            // usage of two algorithms (solve vs solvs_lm)
-            // results are compared afterwards
-            fitter->solve(channelData, nIterations, limitFactor);
-            double solve_error = fitter->residual_sum_of_sqares(channelData);
-
-            fitter_lm->solve_lm(channelData, nIterations, limitFactor);
-            double solve_lm_error = fitter_lm->residual_sum_of_sqares(channelData);
-
-            // validate parameters:
-            // invalid results should be ignored in the fitting process,
-            // however edge cases may produce invalid parameters
-            double lastVal = channelData.back().second;
-            bool solve_valid = fitter->parameters_valid(limitFactor * lastVal);
-            bool solve_lm_valid = fitter_lm->parameters_valid(limitFactor * lastVal);
-
-            std::shared_ptr<LeastSquaresFitter> bestFitter;
-            double bestError = qInf();
-            if ( solve_valid && solve_lm_valid ) {   // parameters of both fitters valid
-                bestFitter = solve_error < solve_lm_error ? fitter : fitter_lm;
-                bestError = solve_error < solve_lm_error ? solve_error : solve_lm_error;
-            } else if ( solve_valid ) { // only fitter params valid
-                bestFitter = fitter;
-                bestError = solve_error;
-            } else if ( solve_lm_valid ) {  // only fitter_lm params valid
-                bestFitter = fitter_lm;
-                bestError = solve_lm_error;
-            } else {    // invalid results -> return
-                fitValid[channel] = false;
-                return;
-            }
-
-            auto params = bestFitter->getParams();
-
-            for (size_t i=0; i<params.size(); i++)
-            {
-                parameterData[i][channel] = params[i];
-            }
-            sigmaError[channel] = std::sqrt(bestError / channelData.size());
-            tau90[channel] = bestFitter->tau_90();
-            f_t90[channel] = bestFitter->f_t_90();
-            nSamples[channel] = channelData.size();
-
-            // after curve fit:
-            // recovery time
-            determineTRecovery(channel);
-        } catch (dlib::error exception) {
-            error("Error in channel " + QString::number(channel) + ": " + QString(exception.what()));
-        }
+        parameterData[i][channel] = params[i];
     }
+    sigmaError[channel] = std::sqrt(bestError / channelData.size());
+    tau90[channel] = bestFitter->tau_90();
+    f_t90[channel] = bestFitter->f_t_90();
+    nSamples[channel] = channelData.size();
+
+    // after curve fit:
+    // recovery time
+    determineTRecovery(channel);
+    return true;
 }
 
 /*!
@@ -580,6 +917,46 @@ void CurveFitWorker::setLimitFactor(const double &value)
     }
 }
 
+/*!
+ * \brief CurveFitWorker::setTargetError sets the rms error at which the random restarts of a channel fit stop. 0: all restarts are run.
+ */
+void CurveFitWorker::setTargetError(double value)
+{
+    targetError = value;
+}
+
+/*!
+ * \brief CurveFitWorker::setSeed sets the seed of the random restarts. Each channel and solver derives its own seed from it.
+ */
+void CurveFitWorker::setSeed(quint64 value)
+{
+    seed = value;
+}
+
+/*!
+ * \brief CurveFitWorker::setNThreads sets the number of threads fitting the channels. 0: ideal thread count. Applies to the next start().
+ */
+void CurveFitWorker::setNThreads(int value)
+{
+    nThreads = value;
+}
+
+/*!
+ * \brief CurveFitWorker::setWarmStart sets if the channels of a functionalisation group start from the fit of its representative. Applies to the next start().
+ */
+void CurveFitWorker::setWarmStart(bool value)
+{
+    warmStart = value;
+}
+
+/*!
+ * \brief CurveFitWorker::setNWarmStartRestarts sets the number of random restarts of a warm-started channel if no warm start is accepted.
+ */
+void CurveFitWorker::setNWarmStartRestarts(int value)
+{
+    nWarmStartRestarts = value;
+}
+
 QStringList CurveFitWorker::getTableHeader() const
 {
     // get data from the worker and emit
@@ -726,6 +1103,7 @@ AutomatedFitWorker::AutomatedFitWorker(MeasurementData *mData, int timeout, int
     QObject(parent),
     mData(mData),
     timeoutInS(timeout),
+    nCores(nCores),
     t_exposition(t_exposition),
     t_offset(t_offset)
 {
@@ -740,8 +1118,8 @@ AutomatedFitWorker::AutomatedFitWorker(MeasurementData *mData, int timeout, int
     if (timeoutInS < 0)
         timeoutInS = mData->nChannels() * 10;
     // nCores: all available
-    if (nCores < 0)
-        nCores = QThread::idealThreadCount();
+    if (this->nCores < 0)
+        this->nCores = QThread::idealThreadCount();
 
     t_exposition_start = absoluteData.begin().key() + t_offset;
     t_exposition_end = t_exposition>=0 ? t_exposition_start + t_exposition : absoluteData.end().key();
@@ -766,16 +1144,13 @@ void AutomatedFitWorker::fit()
     connect( worker, &CurveFitWorker::finished, &loop, &QEventLoop::quit );
     connect( &timer, &QTimer::timeout, &loop, &QEventLoop::quit );
 
-    //  execute channel fits in the thread pool
-    worker->setAutoDelete(false);
-    QThreadPool::globalInstance()->setMaxThreadCount(nCores);
+    //  execute channel fits in the executor of the worker
+    worker->setNThreads(nCores);
     qDebug() << "\n--------\nStarting curve fit:";
-    qDebug() << "max thread count:\t" << QString::number(QThreadPool::globalInstance()->maxThreadCount());
     qDebug() << "t_offset:\t" << QString::number(t_offset);
     qDebug() << "t_exposition:\t" << QString::number(t_exposition);
     qDebug() << "t_recovery:\t" << QString::number(t_recovery);
-    for (size_t i=0; i<mData->nChannels(); i++)
-        QThreadPool::globalInstance()->start(worker);
+    worker->start();
 
     // start event loop & timeout timer
     timer.start(timeoutInS*1000);
@@ -784,10 +1159,42 @@ void AutomatedFitWorker::fit()
     if(timer.isActive())
         qDebug("Curve fit terminated successfully");
     else
+    {
+        // skip the remaining restarts, the running ones are finished
+        worker->cancel();
+        worker->waitForDone();
         qDebug("Error: Curve fit terminated due to timeout");
+    }
+    qDebug().noquote() << worker->getTimingStatistics();
+
+    if (!timingsFile.isEmpty())
+        worker->saveTimings(timingsFile);
 }
 
 void AutomatedFitWorker::save(QString fileName)
 {
     worker->save(fileName);
 }
+
+void AutomatedFitWorker::setTargetError(double value)
+{
+    worker->setTargetError(value);
+}
+
+void AutomatedFitWorker::setSeed(quint64 value)
+{
+    worker->setSeed(value);
+}
+
+void AutomatedFitWorker::setWarmStart(bool value)
+{
+    worker->setWarmStart(value);
+}
+
+/*!
+ * \brief AutomatedFitWorker::setTimingsFile sets the file the task timings of the fit are saved to. Empty: timings are not saved.
+ */
+void AutomatedFitWorker::setTimingsFile(QString value)
+{
+    timingsFile = value;
+}
@@ -4,15 +4,19 @@
 #include <QObject>
 #include <QtCore>
 
+#include <memory>
+
 #include "measurementdata.h"
+#include "taskexecutor.h"
 #include "defaultSettings.h"
 
-class CurveFitWorker: public QObject, public QRunnable
+class CurveFitWorker: public QObject
 {
     Q_OBJECT
 
 public:
     explicit CurveFitWorker(MeasurementData* mData, QObject *parent = nullptr);
+    ~CurveFitWorker();
 
     std::vector<double> getTau90() const;
 
@@ -24,13 +28,16 @@ public:
 
     std::vector<double> getF_tau90() const;
 
-    void run() override;
-
     void setT_recovery(int value);
 
+    void waitForDone();
+    QString getTimingStatistics() const;
+    QString getWarmStartStatistics() const;
+
 public Q_SLOTS:
     void init();
-    void fitChannel(size_t channel);
+    void start();
+    void cancel();
     void determineTRecovery(size_t channel, int tAverage=4);
     void setChannelRanges(uint start, uint end);
     void determineChannelRanges();
@@ -52,6 +59,12 @@ public Q_SLOTS:
 
     void setNIterations(const int &value);
     void setLimitFactor(const double &value);
+    void setTargetError(double value);
+    void setSeed(quint64 value);
+    void setNThreads(int value);
+    void setWarmStart(bool value);
+    void setNWarmStartRestarts(int value);
+    bool saveTimings(QString filePath) const;
 
     QStringList getHeader() const;
     QStringList getTableHeader() const;
@@ -72,9 +85,35 @@ Q_SIGNALS:
     void channelRangeProvided(int channel, QList<uint> channelRange);
 
 private:
-    size_t ch = 0;
+    struct ChannelFit;
+    struct WarmStart;
+
+    // restarts, solver iterations, restart time (ns) & samples of the cold & warm-started channels of a fit
+    struct FitStatistics
+    {
+        int nColdChannels = 0, nWarmChannels = 0;
+        int nWarmAccepted = 0;          // warm-started solves without random restarts
+        qint64 coldRestarts = 0, warmRestarts = 0;
+        qint64 coldIterations = 0, warmIterations = 0;
+        qint64 coldTime = 0, warmTime = 0;
+        qint64 coldSamples = 0, warmSamples = 0;
+        double wallTime = 0.;           // in ms
+    };
+
     int channelsFinished = 0;
-    QMutex mutex;
+    mutable QMutex mutex;
+
+    std::unique_ptr<TaskExecutor> executor;
+    CancellationToken cancellationToken;
+    int nThreads = 0;                   // threads of the executor, 0: ideal thread count
+
+    // warm start: representative channel of a functionalisation -> channels started from its fit
+    bool warmStart = CVWIZ_DEFAULT_WARM_START;
+    int nWarmStartRestarts = CVWIZ_DEFAULT_WARM_START_RESTARTS;
+    QMap<size_t, QList<size_t>> followers;
+    QSet<size_t> groupFollowers;
+    FitStatistics fitStatistics;
+    QElapsedTimer fitTimer;
 
     QStringList fitTooltips;
     QList<QString> parameterNames;
@@ -99,8 +138,23 @@ private:
     bool detectRecoveryStart = CVWIZ_DEFAULT_DETECT_RECOVERY_START;
     int nIterations = LEAST_SQUARES_N_FITS;
     double limitFactor = LEAST_SQUARES_LIMIT_FACTOR;
+    double targetError = CVWIZ_DEFAULT_TARGET_ERROR;
+    quint64 seed = LEAST_SQUARES_SEED;
 
     int t_recovery = 60*CVWIZ_DEFAULT_RECOVERY_TIME;
+
+    std::shared_ptr<LeastSquaresFitter> createFitter() const;
+    void determineGroups();
+    void submitSetup(size_t channel, const WarmStart &warmStart);
+    void startFollowers(size_t channel, const WarmStart &warmStart);
+    void setupChannel(size_t channel, WarmStart warmStart);
+    void submitRestarts(std::shared_ptr<ChannelFit> channelFit, bool lm, int first, int end);
+    bool warmStartAccepted(const ChannelFit &channelFit, const LeastSquaresFitter::RestartResult &result) const;
+    void runRestart(std::shared_ptr<ChannelFit> channelFit, bool lm, int index);
+    void finishChannel(std::shared_ptr<ChannelFit> channelFit);
+    bool storeFitResult(size_t channel, const std::vector<std::pair<double, double>> &channelData, std::shared_ptr<LeastSquaresFitter> fitter, std::shared_ptr<LeastSquaresFitter> fitter_lm);
+    void setFitValid(size_t channel, bool value);
+    void channelFinished();
 };
 
 class AutomatedFitWorker: public QObject
@@ -115,6 +169,11 @@ public slots:
     void fit();
     void save(QString fileName);
 
+    void setTargetError(double value);
+    void setSeed(quint64 value);
+    void setWarmStart(bool value);
+    void setTimingsFile(QString value);
+
 protected:
     MeasurementData* mData;
     CurveFitWorker* worker;
@@ -125,6 +184,7 @@ protected:
     uint t_exposition_start;
     uint t_exposition_end;
     uint t_recovery;
+    QString timingsFile;
 };
 
 #endif // CURVEFITWORKER_H
@@ -1,5 +1,16 @@
 #include "datasource.h"
 
+#include "defaultSettings.h"
+
+#include <chrono>
+
+#if defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <time.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
 /*!
  * \class DataSource
  * \brief Interface class for the connection with the eNoseSensor.
@@ -12,22 +23,30 @@
 
 DataSource::DataSource(int sensorTimeout, int sensorNChannels):
     timeout(sensorTimeout),
-    nChannels(sensorNChannels)
+    nChannels(sensorNChannels),
+    readingBuffer(SOURCE_BUFFER_CAPACITY)
 {
     qRegisterMetaType<Status>("Status");
     qRegisterMetaType<MVector>("MVector");
+    qRegisterMetaType<BaselineEstimator::Settings>("BaselineEstimator::Settings");
+
+    BaselineEstimator::Settings baselineSettings;
+    baselineSettings.nVectors = static_cast<int>(nBaseVectors);
+    baselineEstimator.setSettings(baselineSettings);
 }
 
 DataSource::~DataSource()
 {
-    timer->deleteLater();
+    if (timer != nullptr)
+        timer->deleteLater();
 }
 
 /*!
  * \brief DataSource::nBaseVectors defines how many vectors are used to calculate the base vector (R0).
  * Vectors used to calculate base vectors are not added to MeasurementData.
+ * The base vector after a reset is estimated from the first nBaseVectors vectors received.
  */
-const uint DataSource::nBaseVectors = 3;
+const uint DataSource::nBaseVectors = 4;
 
 DataSource::Status DataSource::status()
 {
@@ -68,8 +87,149 @@ void DataSource::setStatus(DataSource::Status newStatus)
     }
 }
 
+BaselineEstimator::Settings DataSource::getBaselineSettings() const
+{
+    return baselineEstimator.getSettings();
+}
+
+/*!
+ * \brief DataSource::setBaselineSettings sets how base vectors are estimated. Has to be called in the thread of the source, e.g. by a queued connection.
+ */
+void DataSource::setBaselineSettings(BaselineEstimator::Settings settings)
+{
+    baselineEstimator.setSettings(settings);
+}
+
 void DataSource::started()
 {
+    threadId = QThread::currentThreadId();
     timer = new QTimer();
     init();
 }
+
+/*!
+ * \brief DataSource::takeReading moves the oldest queued reading into \a reading.
+ * Returns false if no reading is queued. Must only be called from a single consumer thread.
+ */
+bool DataSource::takeReading(SourceReading &reading)
+{
+    return readingBuffer.pop(reading);
+}
+
+size_t DataSource::getBufferCapacity() const
+{
+    return readingBuffer.capacity();
+}
+
+size_t DataSource::getBufferSize() const
+{
+    return readingBuffer.size();
+}
+
+size_t DataSource::getBufferHighWaterMark() const
+{
+    return readingBuffer.highWaterMark();
+}
+
+/*!
+ * \brief DataSource::getBufferOverruns returns the number of readings dropped because the consumer did not keep up.
+ */
+quint64 DataSource::getBufferOverruns() const
+{
+    return readingBuffer.overruns();
+}
+
+/*!
+ * \brief DataSource::publishVector queues \a vector received at \a timestamp for the consumer.
+ * Call this from the source thread when a new vector was received and the measurement was started before.
+ */
+void DataSource::publishVector(uint timestamp, const AbsoluteMVector &vector)
+{
+    pendingReading.type = SourceReading::Type::Vector;
+    pendingReading.timestamp = timestamp;
+    pendingReading.queueTime = monotonicTime();
+    pendingReading.vector = vector;
+
+    if (readingBuffer.push(pendingReading))
+        nPublished++;
+}
+
+/*!
+ * \brief DataSource::publishBaseVector queues \a baseVector set at \a timestamp for the consumer and emits baseVectorSet.
+ */
+void DataSource::publishBaseVector(uint timestamp, const AbsoluteMVector &baseVector)
+{
+    pendingReading.type = SourceReading::Type::BaseVector;
+    pendingReading.timestamp = timestamp;
+    pendingReading.queueTime = monotonicTime();
+    pendingReading.vector = baseVector;
+
+    if (!readingBuffer.push(pendingReading))
+        qWarning() << "Source buffer overrun: base vector at " << timestamp << " dropped";
+
+    emit baseVectorSet(timestamp, baseVector);
+}
+
+/*!
+ * \brief DataSource::getCounters returns the health counters of the source. Can be called from any thread.
+ */
+SourceCounters DataSource::getCounters() const
+{
+    SourceCounters counters;
+    counters.nReceived = nReceived;
+    counters.nVectors = nPublished;
+    counters.nParseErrors = nParseErrors;
+    counters.nIgnored = nIgnored;
+    counters.nOverruns = readingBuffer.overruns();
+    counters.nReconnects = nReconnects;
+
+    return counters;
+}
+
+/*!
+ * \brief DataSource::monotonicTime returns the time of a monotonic clock in ns, used to measure the queue latency of readings.
+ */
+qint64 DataSource::monotonicTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*!
+ * \brief DataSource::getThreadCpuTime returns the CPU time in ns consumed by the thread the source runs in.
+ * Returns -1 if the source was not started yet or if thread CPU times are not supported on this platform.
+ */
+qint64 DataSource::getThreadCpuTime() const
+{
+    Qt::HANDLE id = threadId.load();
+    if (id == nullptr)
+        return -1;
+
+#if defined(Q_OS_LINUX)
+    clockid_t clockId;
+    if (pthread_getcpuclockid(reinterpret_cast<pthread_t>(id), &clockId) != 0)
+        return -1;
+
+    timespec cpuTime;
+    if (clock_gettime(clockId, &cpuTime) != 0)
+        return -1;
+
+    return static_cast<qint64>(cpuTime.tv_sec) * 1000000000 + cpuTime.tv_nsec;
+#elif defined(Q_OS_WIN)
+    HANDLE threadHandle = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(reinterpret_cast<quintptr>(id)));
+    if (threadHandle == NULL)
+        return -1;
+
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    bool ok = GetThreadTimes(threadHandle, &creationTime, &exitTime, &kernelTime, &userTime);
+    CloseHandle(threadHandle);
+    if (!ok)
+        return -1;
+
+    // FILETIME is in units of 100 ns
+    quint64 kernel = (static_cast<quint64>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+    quint64 user = (static_cast<quint64>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+    return static_cast<qint64>((kernel + user) * 100);
+#else
+    return -1;
+#endif
+}
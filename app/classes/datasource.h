@@ -2,6 +2,39 @@
 #define DATASOURCE_H
 
 #include "mvector.h"
+#include "spscringbuffer.h"
+#include "baselineestimator.h"
+
+/*!
+ * \brief The SourceReading struct is the unit passed from the source thread to the consumer through DataSource::takeReading.
+ * Base vectors are passed in the same queue as measurement vectors in order to preserve their order.
+ */
+struct SourceReading
+{
+    enum class Type {
+        Vector,
+        BaseVector
+    };
+
+    Type type = Type::Vector;
+    uint timestamp = 0;
+    qint64 queueTime = 0;   // DataSource::monotonicTime() when the reading was queued
+    AbsoluteMVector vector;
+};
+
+/*!
+ * \brief The SourceCounters struct holds the totals counted by a DataSource since it was created.
+ * Together with the counters of DevicePipeline they tell where readings get lost when the host can not keep up.
+ */
+struct SourceCounters
+{
+    quint64 nReceived = 0;      // measurement lines or frames received from the sensor
+    quint64 nVectors = 0;       // vectors queued for the consumer
+    quint64 nParseErrors = 0;   // malformed lines or frames
+    quint64 nIgnored = 0;       // measurement values received while no measurement was running
+    quint64 nOverruns = 0;      // readings dropped because the source buffer was full
+    quint64 nReconnects = 0;    // connections lost by a timeout or I/O error or reconnected
+};
 
 class DataSource : public QObject
 {
@@ -24,7 +57,8 @@ public:
     enum class SourceType {
         USB,
         BLUETOOTH,
-        FAKE
+        FAKE,
+        REPLAY
     };
 
     // constants
@@ -46,16 +80,25 @@ public:
     int getTimeout() const;
     void setTimeout(int value);
 
-signals:
-    /*! \fn void DataSource::vectorReceived(uint timestamp, MVector vector)
-     *
-       This signal is emitted if a new vector was received and the measurement was started before.
-     */
-    void vectorReceived (uint timestamp, AbsoluteMVector vector);
+    bool takeReading(SourceReading &reading);
+
+    size_t getBufferCapacity() const;
+    size_t getBufferSize() const;
+    size_t getBufferHighWaterMark() const;
+    quint64 getBufferOverruns() const;
+
+    qint64 getThreadCpuTime() const;
 
+    SourceCounters getCounters() const;
+    static qint64 monotonicTime();
+
+    BaselineEstimator::Settings getBaselineSettings() const;
+
+signals:
     /*! \fn void DataSource::baseVectorSet(uint timestamp, MVector vector)
 
        This signal is emitted after a new base vector was calculated. This happens at the start of a new measurement and after a reset was triggered.
+       The base vector is also queued as a SourceReading, consumers of measurement data should use takeReading.
      */
     void baseVectorSet (uint timestamp, MVector vector);
 
@@ -81,6 +124,8 @@ public slots:
     virtual void reset() = 0;
     virtual void reconnect() = 0;
 
+    void setBaselineSettings(BaselineEstimator::Settings settings);
+
 private slots:
     void started();
 
@@ -102,9 +147,28 @@ protected:
      */
     QTimer* timer = nullptr;
 
-    QMap<uint, MVector> baselevelVectorMap; // used to store the first nBaseVectors vectors in order to calculate the base vector
+    BaselineEstimator baselineEstimator;    // estimates the base vector from the vectors received after a reset
+
+    // health counters, incremented in the source thread & read by getCounters()
+    std::atomic<quint64> nReceived{0};
+    std::atomic<quint64> nParseErrors{0};
+    std::atomic<quint64> nIgnored{0};
+    std::atomic<quint64> nReconnects{0};
 
     void setStatus(Status status);
+
+    void publishVector(uint timestamp, const AbsoluteMVector &vector);
+    void publishBaseVector(uint timestamp, const AbsoluteMVector &baseVector);
+
+private:
+    /*!
+     * \brief readingBuffer passes measurements from the source thread to the consumer without locking or signal queuing.
+     */
+    SpscRingBuffer<SourceReading> readingBuffer;
+    SourceReading pendingReading;   // reused in order to avoid allocations in the source thread
+    std::atomic<quint64> nPublished{0};
+
+    std::atomic<Qt::HANDLE> threadId{nullptr};  // native id of the thread the source runs in, set when started
 };
 
 Q_DECLARE_METATYPE(DataSource::Status);
@@ -28,6 +28,35 @@
 #define LOWER_LIMIT_KEY "settings/lowerLimit"
 #define DEFAULT_LOWER_LIMIT 300.0
 
+// base vector estimation
+#define BASELINE_MODE_KEY "settings/baselineMode"
+#define DEFAULT_BASELINE_MODE "mean"
+#define BASELINE_DRIFT_KEY "settings/baselineDriftTracking"
+#define DEFAULT_BASELINE_DRIFT false
+
+// classifier
+#define CLASSIFIER_BATCH_SIZE_KEY "settings/classifierBatchSize"
+#define DEFAULT_CLASSIFIER_BATCH_SIZE 256   // inputs per forward pass when classifying a whole measurement
+#define CLASSIFICATION_CACHE_SIZE_KEY "settings/classificationCacheSize"
+#define DEFAULT_CLASSIFICATION_CACHE_SIZE 20000 // annotations cached, 0: no caching
+#define ENSEMBLE_MERGE_RULE_KEY "settings/ensembleMergeRule"
+#define DEFAULT_ENSEMBLE_MERGE_RULE "mean"
+#define CLASSIFIER_FREEZE_KEY "settings/classifierFreeze"
+#define DEFAULT_CLASSIFIER_FREEZE true
+#define CLASSIFIER_OPTIMIZE_KEY "settings/classifierOptimize"
+#define DEFAULT_CLASSIFIER_OPTIMIZE false
+#define CLASSIFIER_WARMUP_RUNS_KEY "settings/classifierWarmupRuns"
+#define DEFAULT_CLASSIFIER_WARMUP_RUNS 3
+#define CLASSIFIER_INTRA_OP_THREADS_KEY "settings/classifierIntraOpThreads"
+#define DEFAULT_CLASSIFIER_INTRA_OP_THREADS 0   // 0: libtorch default
+#define CLASSIFIER_INTER_OP_THREADS_KEY "settings/classifierInterOpThreads"
+#define DEFAULT_CLASSIFIER_INTER_OP_THREADS 0   // 0: libtorch default
+#define CLASSIFIER_QUANTIZATION_KEY "settings/classifierQuantization"
+#define DEFAULT_CLASSIFIER_QUANTIZATION "off"   // int8 quantisation of TorchScript classifiers: "off" or the quantized backend ("auto", "fbgemm" or "qnnpack")
+#define LIVE_CLASSIFIER_ERROR_INTERVAL 30       // min time in s between two error dialogs of the live classification
+#define MLP_CLASSIFIER_EXTENSION ".mlp"         // classifiers of the built-in MLP backend
+#define MLP_EXPORT_TOLERANCE 1e-4               // max difference of the class probabilities of a converted classifier to the TorchScript model
+
 // colors
 # define GRAPH_BACKGROUND_COLOR QColor(255,250,240)
 
@@ -40,6 +69,10 @@
 #define CVWIZ_DEFAULT_DETECT_EXPOSITION_START true
 #define CVWIZ_DEFAULT_DETECT_RECOVERY_START false
 #define CVWIZ_DEFAULT_RECOVERY_TIME 30
+#define CVWIZ_DEFAULT_TARGET_ERROR 0.0      // rms residual stopping the random restarts of a channel fit, 0: all restarts
+#define CVWIZ_DEFAULT_WARM_START true       // channels of a functionalisation start from the fit of the channel with the most samples
+#define CVWIZ_DEFAULT_WARM_START_RESTARTS 3 // random restarts of a warm-started channel if its warm start is not accepted
+#define CVWIZ_WARM_START_TOLERANCE 2.0      // max rms error / plateau of an accepted warm start relative to the one of the representative
 #define CVWIZ_DEBUG_MODE false  // true: curve fit executed in a single thread and additional debugging info activated
 
 // functionalisation
@@ -53,6 +86,34 @@
 // devices
 #define DEVICE_TIMEOUT 6
 
+// source buffering
+#define SOURCE_BUFFER_CAPACITY 1024     // readings queued between source thread and controler
+#define SOURCE_DRAIN_INTERVAL 100       // in ms
+#define SOURCE_DRAIN_MAX_BATCH 512      // max readings handled per drain
+
+// replay
+#define REPLAY_MAX_BATCH 256    // max vectors replayed per event loop iteration when replaying as fast as possible
+
+// stress test
+#define STRESS_TIMER_INTERVAL 1     // in ms
+#define STRESS_MAX_BATCH 1000       // max readings generated per timer event
+#define STRESS_EVENT_CLASS "measurement event"  // class of the measurement events generated
+
+// serial capture journal
+#define SERIAL_JOURNAL_EXTENSION ".journal"
+#define SERIAL_JOURNAL_FLUSH_INTERVAL 200   // in ms, max time captured bytes are kept in memory
+#define SERIAL_JOURNAL_MAX_BATCH 256        // max chunks replayed per timer event when replaying as fast as possible
+
+// device simulator
+#define SIMULATOR_MAX_BATCH 1000            // max lines generated per timer event
+#define SIMULATOR_MAX_PENDING (1 << 20)     // max bytes buffered while the pty is full, further lines are dropped
+#define SIMULATOR_TRACE_CAPACITY 100000     // number of send times kept for latency tracing
+#define SIMULATOR_REPORT_INTERVAL 10        // in s
+
+// multiple devices
+#define DEVICE_LOAD_REPORT_INTERVAL 10  // in s
+#define DEVICE_AUTOSAVE_INTERVAL 1      // in min, for devices not shown in the main window
+
 // uploader
 #define UPLOADER_CMD_TIMEOUT 90*1000
 #define UPLOADER_CMD_SYNC_PERIOD 2*60000
@@ -0,0 +1,370 @@
+#include "devicepipeline.h"
+
+#include "defaultSettings.h"
+
+/*!
+ * \class DevicePipeline
+ * \brief Runs a DataSource in its own thread and adds its readings to a MeasurementData.
+ * Each device connected at the same time gets its own pipeline consisting of source thread, source buffer, MeasurementData and autosave file.
+ * The CPU cost of source thread and consumer is measured and reported periodically,
+ * as well as the health of the pipeline: readings received, lost or delayed between sensor and MeasurementData.
+ * The pipeline takes ownership of the source, but not of the MeasurementData.
+ */
+DevicePipeline::DevicePipeline(DataSource *source, MeasurementData *data, QObject *parent):
+    QObject(parent),
+    source(source),
+    sourceThread(new QThread()),
+    mData(data)
+{
+    Q_ASSERT(source != nullptr && data != nullptr);
+    qRegisterMetaType<DeviceLoad>("DeviceLoad");
+    qRegisterMetaType<PipelineHealth>("PipelineHealth");
+
+    load.identifier = source->identifier();
+    health.identifier = load.identifier;
+
+    // run source in separate thread
+    source->moveToThread(sourceThread);
+
+    connect(sourceThread, SIGNAL(started()), source, SLOT(started())); // init source when thread was started
+    connect(source, SIGNAL(destroyed()), sourceThread, SLOT(quit()));   // end thread when source is deleted
+    connect(sourceThread, SIGNAL(finished()), sourceThread, SLOT(deleteLater())); // delete thread when finishes
+
+    sourceThread->start();
+
+    // drain source buffer
+    connect(&drainTimer, &QTimer::timeout, this, &DevicePipeline::drain);
+    drainTimer.setSingleShot(false);
+    drainTimer.start(SOURCE_DRAIN_INTERVAL);
+
+    // load reports
+    connect(&loadTimer, &QTimer::timeout, this, &DevicePipeline::updateLoad);
+    loadTimer.setSingleShot(false);
+    loadTimer.start(DEVICE_LOAD_REPORT_INTERVAL * 1000);
+    loadIntervalTimer.start();
+
+    // autosave
+    connect(&autosaveTimer, &QTimer::timeout, this, &DevicePipeline::autosave);
+    autosaveTimer.setSingleShot(false);
+
+    connect(source, &DataSource::statusSet, this, &DevicePipeline::handleStatus);
+}
+
+DevicePipeline::~DevicePipeline()
+{
+    drainTimer.stop();
+    loadTimer.stop();
+    autosaveTimer.stop();
+
+    // thread quits when source is deleted
+    source->deleteLater();
+}
+
+DataSource *DevicePipeline::getSource() const
+{
+    return source;
+}
+
+MeasurementData *DevicePipeline::getData() const
+{
+    return mData;
+}
+
+/*!
+ * \brief DevicePipeline::identifier returns the name used in load reports and autosave files. Defaults to the identifier of the source.
+ */
+QString DevicePipeline::identifier() const
+{
+    return load.identifier;
+}
+
+void DevicePipeline::setIdentifier(const QString &value)
+{
+    load.identifier = value;
+    health.identifier = value;
+}
+
+QString DevicePipeline::getAutosaveFile() const
+{
+    return autosaveFile;
+}
+
+/*!
+ * \brief DevicePipeline::setAutosaveDir sets the directory the data of this device is saved to every DEVICE_AUTOSAVE_INTERVAL minutes.
+ * Each measurement started by start() is saved to a new file named after the device and the start time.
+ * Autosaving is disabled for empty \a value.
+ */
+void DevicePipeline::setAutosaveDir(const QString &value)
+{
+    autosaveDir = value;
+
+    if (autosaveDir.isEmpty())
+        autosaveTimer.stop();
+    else if (!autosaveTimer.isActive())
+        autosaveTimer.start(DEVICE_AUTOSAVE_INTERVAL * 60 * 1000);
+}
+
+bool DevicePipeline::getAutoStart() const
+{
+    return autoStart;
+}
+
+/*!
+ * \brief DevicePipeline::setAutoStart sets if a new measurement is started as soon as the source is connected.
+ */
+void DevicePipeline::setAutoStart(bool value)
+{
+    autoStart = value;
+
+    if (autoStart && source->status() == DataSource::Status::CONNECTED)
+        start();
+}
+
+DeviceLoad DevicePipeline::getLoad() const
+{
+    return load;
+}
+
+/*!
+ * \brief DevicePipeline::getHealth returns the health of the pipeline as of the last report.
+ */
+PipelineHealth DevicePipeline::getHealth() const
+{
+    return health;
+}
+
+/*!
+ * \brief DevicePipeline::start resumes a paused measurement or starts a new one.
+ * The data of the previous measurement is autosaved and cleared when a new measurement is started.
+ */
+void DevicePipeline::start()
+{
+    auto status = source->status();
+    if (status == DataSource::Status::CONNECTED)
+    {
+        autosave();
+        mData->clear();
+        mData->setSensorId(identifier());
+
+        if (!autosaveDir.isEmpty())
+        {
+            QString deviceName = identifier();
+            deviceName.replace(QRegularExpression("[^A-Za-z0-9_-]"), "_");
+            autosaveFile = autosaveDir + "/" + deviceName + "_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".csv";
+        }
+
+        QMetaObject::invokeMethod(source, "start", Qt::QueuedConnection);
+    }
+    else if (status == DataSource::Status::PAUSED)
+        QMetaObject::invokeMethod(source, "start", Qt::QueuedConnection);
+}
+
+void DevicePipeline::pause()
+{
+    auto status = source->status();
+    if (status == DataSource::Status::RECEIVING_DATA || status == DataSource::Status::SET_BASEVECTOR)
+        QMetaObject::invokeMethod(source, "pause", Qt::QueuedConnection);
+}
+
+void DevicePipeline::stop()
+{
+    auto status = source->status();
+    if (status == DataSource::Status::RECEIVING_DATA || status == DataSource::Status::PAUSED)
+    {
+        QMetaObject::invokeMethod(source, "stop", Qt::QueuedConnection);
+        autosave();
+    }
+}
+
+void DevicePipeline::reset()
+{
+    auto status = source->status();
+    if (status == DataSource::Status::RECEIVING_DATA || status == DataSource::Status::PAUSED)
+        QMetaObject::invokeMethod(source, "reset", Qt::QueuedConnection);
+}
+
+void DevicePipeline::autosave()
+{
+    if (autosaveFile.isEmpty() || !mData->isChanged() || mData->getAbsoluteData().isEmpty())
+        return;
+
+    try {
+        mData->saveData(autosaveFile);
+        // keep data marked as changed: autosave does not replace saving the measurement
+        mData->setDataChanged(true);
+    } catch (std::runtime_error e) {
+        qWarning() << identifier() << ": Error creating autosave: " << e.what();
+    }
+}
+
+void DevicePipeline::handleStatus(DataSource::Status status)
+{
+    if (autoStart && status == DataSource::Status::CONNECTED)
+        start();
+}
+
+/*!
+ * \brief DevicePipeline::drain takes up to SOURCE_DRAIN_MAX_BATCH readings from the source buffer and adds them to the MeasurementData in batches.
+ * Base vectors are set in the order in which they were received, so that vectors are added relative to the correct base vector.
+ * If more readings are buffered, draining continues after pending events were processed.
+ */
+void DevicePipeline::drain()
+{
+    drainScheduled = false;
+
+    QElapsedTimer drainTime;
+    drainTime.start();
+
+    QMap<uint, AbsoluteMVector> batch;
+    SourceReading reading;
+    qint64 drainStart = DataSource::monotonicTime();
+
+    int nTaken = 0;
+    for (; nTaken<SOURCE_DRAIN_MAX_BATCH && source->takeReading(reading); nTaken++)
+    {
+        qint64 latency = drainStart - reading.queueTime;
+        latencySum += latency;
+        latencyMax = qMax(latencyMax, latency);
+        nLatencies++;
+
+        if (reading.type == SourceReading::Type::BaseVector)
+        {
+            // add vectors received before the new base vector
+            if (!batch.isEmpty())
+            {
+                addBatch(batch);
+                batch.clear();
+            }
+            mData->setBaseVector(reading.timestamp, reading.vector);
+        }
+        // keep first reading of each timestamp
+        else if (!batch.contains(reading.timestamp))
+        {
+            batch.insert(reading.timestamp, reading.vector);
+        }
+        else
+        {
+            nDuplicates++;
+        }
+    }
+
+    if (!batch.isEmpty())
+        addBatch(batch);
+
+    quint64 overruns = source->getBufferOverruns();
+    if (overruns > reportedOverruns)
+    {
+        qWarning() << identifier() << ": Source buffer overrun: " << overruns - reportedOverruns << " readings dropped (capacity: " << source->getBufferCapacity() << ")";
+        reportedOverruns = overruns;
+    }
+
+    consumerTime += drainTime.nsecsElapsed();
+
+    if (nTaken == SOURCE_DRAIN_MAX_BATCH && !drainScheduled)
+    {
+        drainScheduled = true;
+        QTimer::singleShot(0, this, &DevicePipeline::drain);
+    }
+}
+
+/*!
+ * \brief DevicePipeline::addBatch adds \a batch to the MeasurementData. Vectors at seconds already taken are counted as duplicates.
+ */
+void DevicePipeline::addBatch(const QMap<uint, AbsoluteMVector> &batch)
+{
+    int nAdded = mData->addVectors(batch);
+    nVectors += static_cast<quint64>(nAdded);
+    nDuplicates += static_cast<quint64>(batch.size() - nAdded);
+}
+
+/*!
+ * \brief DevicePipeline::updateLoad calculates the CPU load of the last report interval and emits loadUpdated.
+ */
+void DevicePipeline::updateLoad()
+{
+    qint64 interval = loadIntervalTimer.nsecsElapsed();
+    loadIntervalTimer.restart();
+    if (interval <= 0)
+        return;
+
+    qint64 sourceCpuTime = source->getThreadCpuTime();
+    if (sourceCpuTime >= 0 && prevSourceCpuTime >= 0)
+        load.sourceLoad = 100.0 * (sourceCpuTime - prevSourceCpuTime) / interval;
+    else
+        load.sourceLoad = -1.0;
+    prevSourceCpuTime = sourceCpuTime;
+
+    load.consumerLoad = 100.0 * consumerTime / interval;
+    load.nVectors = nVectors;
+
+    consumerTime = 0;
+    nVectors = 0;
+
+    updateHealth(interval);
+
+    if (source->measIsRunning())
+    {
+        qDebug().noquote() << load.toString();
+        qDebug().noquote() << health.toString();
+    }
+
+    emit loadUpdated(load);
+    emit healthUpdated(health);
+}
+
+/*!
+ * \brief DevicePipeline::updateHealth calculates the rates & latencies of the last report \a interval in ns.
+ */
+void DevicePipeline::updateHealth(qint64 interval)
+{
+    SourceCounters counters = source->getCounters();
+    double seconds = interval * 1e-9;
+
+    quint64 dropped = counters.nIgnored + counters.nOverruns + nDuplicates;
+    quint64 prevDropped = prevCounters.nIgnored + prevCounters.nOverruns + prevDuplicates;
+
+    health.counters = counters;
+    health.nDuplicates = nDuplicates;
+    health.receivedRate = (counters.nReceived - prevCounters.nReceived) / seconds;
+    health.vectorRate = (counters.nVectors - prevCounters.nVectors) / seconds;
+    health.errorRate = (counters.nParseErrors - prevCounters.nParseErrors) / seconds;
+    health.dropRate = (dropped - prevDropped) / seconds;
+    health.meanLatency = nLatencies > 0 ? latencySum * 1e-6 / nLatencies : 0.0;
+    health.maxLatency = latencyMax * 1e-6;
+
+    prevCounters = counters;
+    prevDuplicates = nDuplicates;
+    latencySum = 0;
+    latencyMax = 0;
+    nLatencies = 0;
+}
+
+QString DeviceLoad::toString() const
+{
+    QString sourceLoadString = sourceLoad >= 0 ? QString::number(sourceLoad, 'f', 2) + "%" : "n/a";
+
+    return identifier + ":\tsource thread: " + sourceLoadString + ",\tconsumer: " + QString::number(consumerLoad, 'f', 2) + "%,\tvectors: " + QString::number(nVectors);
+}
+
+QString PipelineHealth::toString() const
+{
+    QStringList healthList;
+    healthList << "received: " + QString::number(counters.nReceived) + " (" + QString::number(receivedRate, 'f', 1) + "/s)";
+    healthList << "vectors: " + QString::number(counters.nVectors) + " (" + QString::number(vectorRate, 'f', 1) + "/s)";
+    healthList << "parse errors: " + QString::number(counters.nParseErrors) + " (" + QString::number(errorRate, 'f', 1) + "/s)";
+    healthList << "ignored: " + QString::number(counters.nIgnored);
+    healthList << "duplicates: " + QString::number(nDuplicates);
+    healthList << "overruns: " + QString::number(counters.nOverruns);
+    healthList << "reconnects: " + QString::number(counters.nReconnects);
+    healthList << "queue latency: " + QString::number(meanLatency, 'f', 2) + " ms (max " + QString::number(maxLatency, 'f', 2) + " ms)";
+
+    return identifier + ":\t" + healthList.join(",\t");
+}
+
+/*!
+ * \brief PipelineHealth::toStatusString returns a short summary for the status bar.
+ */
+QString PipelineHealth::toStatusString() const
+{
+    return QString::number(vectorRate, 'f', 1) + " vectors/s, " + QString::number(dropRate, 'f', 1) + " dropped/s, " + QString::number(errorRate, 'f', 1) + " errors/s, latency " + QString::number(meanLatency, 'f', 1) + " ms";
+}
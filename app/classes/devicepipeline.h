@@ -0,0 +1,127 @@
+#ifndef DEVICEPIPELINE_H
+#define DEVICEPIPELINE_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "datasource.h"
+#include "measurementdata.h"
+
+/*!
+ * \brief The DeviceLoad struct describes the CPU cost of a DevicePipeline during the last report interval.
+ * Loads are in percent of one core.
+ */
+struct DeviceLoad
+{
+    QString identifier;
+    double sourceLoad = -1.0;   // source thread, -1 if not available on this platform
+    double consumerLoad = 0.0;  // draining & adding vectors in the thread of the pipeline
+    quint64 nVectors = 0;       // vectors added in the report interval
+
+    QString toString() const;
+};
+
+/*!
+ * \brief The PipelineHealth struct combines the counters of the source with the readings lost or delayed by the consumer.
+ * Rates are per second during the last report interval, latencies in ms from queuing a reading in the source to draining it.
+ */
+struct PipelineHealth
+{
+    QString identifier;
+    SourceCounters counters;    // totals since the source was created
+    quint64 nDuplicates = 0;    // vectors dropped because their second was already taken
+
+    double receivedRate = 0.0;
+    double vectorRate = 0.0;
+    double errorRate = 0.0;
+    double dropRate = 0.0;      // ignored, duplicated & overrun readings
+    double meanLatency = 0.0;
+    double maxLatency = 0.0;
+
+    QString toString() const;
+    QString toStatusString() const;
+};
+
+Q_DECLARE_METATYPE(DeviceLoad);
+Q_DECLARE_METATYPE(PipelineHealth);
+
+class DevicePipeline : public QObject
+{
+    Q_OBJECT
+public:
+    DevicePipeline(DataSource *source, MeasurementData *data, QObject *parent = nullptr);
+    ~DevicePipeline();
+
+    DataSource *getSource() const;
+    MeasurementData *getData() const;
+    QString identifier() const;
+    void setIdentifier(const QString &value);
+
+    QString getAutosaveFile() const;
+    void setAutosaveDir(const QString &value);
+
+    bool getAutoStart() const;
+    void setAutoStart(bool value);
+
+    DeviceLoad getLoad() const;
+    PipelineHealth getHealth() const;
+
+signals:
+    /*!
+     * \brief loadUpdated is emitted every DEVICE_LOAD_REPORT_INTERVAL seconds.
+     */
+    void loadUpdated(DeviceLoad load);
+
+    /*!
+     * \brief healthUpdated is emitted every DEVICE_LOAD_REPORT_INTERVAL seconds.
+     */
+    void healthUpdated(PipelineHealth health);
+
+public slots:
+    void start();
+    void pause();
+    void stop();
+    void reset();
+
+    void autosave();
+
+private slots:
+    void drain();
+    void updateLoad();
+    void handleStatus(DataSource::Status status);
+
+private:
+    DataSource *source;
+    QThread *sourceThread;
+    MeasurementData *mData;
+
+    QTimer drainTimer, loadTimer, autosaveTimer;
+    QString autosaveDir, autosaveFile;
+    bool autoStart = false;
+
+    quint64 reportedOverruns = 0;
+    bool drainScheduled = false;
+
+    // load measurement
+    QElapsedTimer loadIntervalTimer;
+    qint64 prevSourceCpuTime = -1;  // in ns
+    qint64 consumerTime = 0;        // in ns
+    quint64 nVectors = 0;
+    DeviceLoad load;
+
+    // health measurement
+    quint64 nDuplicates = 0;
+    qint64 latencySum = 0;          // in ns
+    qint64 latencyMax = 0;          // in ns
+    quint64 nLatencies = 0;
+    SourceCounters prevCounters;
+    quint64 prevDuplicates = 0;
+    PipelineHealth health;
+
+    void addBatch(const QMap<uint, AbsoluteMVector> &batch);
+    void updateHealth(qint64 interval);
+};
+
+#endif // DEVICEPIPELINE_H
@@ -0,0 +1,406 @@
+#include "devicesimulator.h"
+
+#include <QtCore>
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(Q_OS_UNIX)
+    #include <fcntl.h>
+    #include <stdlib.h>
+    #include <termios.h>
+    #include <unistd.h>
+    #include <errno.h>
+#endif
+
+#include "defaultSettings.h"
+#include "binaryframedecoder.h"
+
+const QString DeviceSimulator::sequenceAttribute = "seq";
+
+/*!
+ * \class DeviceSimulator
+ * \brief Simulates an eNose sensor connected by USB on a pseudo-terminal, so USBDataSource can be benchmarked without hardware.
+ * The USB settings are pointed at the slave end returned by getSlaveName().
+ *
+ * The simulator speaks the firmware protocol: GET_INFO is answered with V<version>;<MAC>,
+ * measurement lines (count=,var1=... for V1, start;... for V2) are sent at the configured rate,
+ * the fan level is sent after start and after GET_INFO, event lines at the configured event rate.
+ * Like the sensor, the simulator sends measurement lines all the time, whether a client reads them or not.
+ *
+ * If binarySupported is set, BINARY_ON is answered with BINARY_OK and the simulator sends binary frames (see BinaryFrameDecoder) until the next GET_INFO.
+ *
+ * If traceLatency is set, V1 lines contain their sequence number as sensor attribute "seq".
+ * Consumers pass the sequence numbers of vectors received to traceReceived in order to measure the end-to-end latency from the generation of the line.
+ * Only available on Unix systems: open() throws std::runtime_error otherwise.
+ */
+DeviceSimulator::DeviceSimulator(DeviceSimulator::Settings settings, QObject *parent):
+    QObject(parent),
+    settings(settings),
+    randomGenerator(settings.seed),
+    noiseDistribution(0.0, 1.0),
+    channelBase(settings.nChannels)
+{
+    Q_ASSERT("Invalid simulator settings!" && settings.rate > 0 && settings.nChannels > 0);
+
+    std::uniform_real_distribution<double> baseDistribution(0.0, 1.0);
+    for (int i=0; i<settings.nChannels; i++)
+        channelBase[i] = 5000.0 + 20000.0 * baseDistribution(randomGenerator);
+}
+
+DeviceSimulator::~DeviceSimulator()
+{
+    close();
+}
+
+/*!
+ * \brief DeviceSimulator::open creates the pseudo-terminal pair. Throws std::runtime_error if the pty can not be created.
+ * Has to be called before the simulator is moved to another thread.
+ */
+void DeviceSimulator::open()
+{
+#if defined(Q_OS_UNIX)
+    masterFd = ::posix_openpt(O_RDWR | O_NOCTTY);
+    if (masterFd < 0 || ::grantpt(masterFd) != 0 || ::unlockpt(masterFd) != 0)
+    {
+        close();
+        throw std::runtime_error("Cannot create pseudo-terminal: " + std::string(strerror(errno)));
+    }
+
+    slaveName = QString(::ptsname(masterFd));
+    slaveFd = ::open(slaveName.toStdString().c_str(), O_RDWR | O_NOCTTY);
+    if (slaveFd < 0)
+    {
+        close();
+        throw std::runtime_error("Cannot open " + slaveName.toStdString() + ": " + std::string(strerror(errno)));
+    }
+
+    // raw mode: no echo of commands, no line ending conversion
+    struct termios tio;
+    ::tcgetattr(slaveFd, &tio);
+    ::cfmakeraw(&tio);
+    ::tcsetattr(slaveFd, TCSANOW, &tio);
+
+    ::fcntl(masterFd, F_SETFL, ::fcntl(masterFd, F_GETFL) | O_NONBLOCK);
+#else
+    throw std::runtime_error("The device simulator is only available on Unix systems!");
+#endif
+}
+
+void DeviceSimulator::close()
+{
+#if defined(Q_OS_UNIX)
+    if (slaveFd >= 0)
+        ::close(slaveFd);
+    if (masterFd >= 0)
+        ::close(masterFd);
+#endif
+    slaveFd = -1;
+    masterFd = -1;
+}
+
+QString DeviceSimulator::getSlaveName() const
+{
+    return slaveName;
+}
+
+DeviceSimulator::Settings DeviceSimulator::getSettings() const
+{
+    return settings;
+}
+
+quint64 DeviceSimulator::getNLinesSent() const
+{
+    return nLinesSent.load();
+}
+
+quint64 DeviceSimulator::getNBytesSent() const
+{
+    return nBytesSent.load();
+}
+
+/*!
+ * \brief DeviceSimulator::getNLinesDropped returns the number of lines dropped because the client did not read the pty.
+ */
+quint64 DeviceSimulator::getNLinesDropped() const
+{
+    return nLinesDropped.load();
+}
+
+/*!
+ * \brief DeviceSimulator::monotonicTime returns the time of a monotonic clock in ns. Used for latency tracing across threads.
+ */
+qint64 DeviceSimulator::monotonicTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*!
+ * \brief DeviceSimulator::start starts sending lines. Creates the timers and notifiers in the thread of the simulator.
+ */
+void DeviceSimulator::start()
+{
+    Q_ASSERT("Simulator was not opened!" && masterFd >= 0);
+
+    if (generationTimer == nullptr)
+    {
+        readNotifier = new QSocketNotifier(masterFd, QSocketNotifier::Read, this);
+        connect(readNotifier, &QSocketNotifier::activated, this, &DeviceSimulator::handleReadable);
+
+        writeNotifier = new QSocketNotifier(masterFd, QSocketNotifier::Write, this);
+        writeNotifier->setEnabled(false);
+        connect(writeNotifier, &QSocketNotifier::activated, this, &DeviceSimulator::flush);
+
+        generationTimer = new QTimer(this);
+        generationTimer->setTimerType(Qt::PreciseTimer);
+        connect(generationTimer, &QTimer::timeout, this, &DeviceSimulator::generateDue);
+
+        reportTimer = new QTimer(this);
+        connect(reportTimer, &QTimer::timeout, this, &DeviceSimulator::logReport);
+    }
+
+    sampleIndex = 0;
+    eventIndex = 0;
+    clock.start();
+
+    sendFanLevel();
+
+    generationTimer->start(qBound(1, static_cast<int>(1000.0 / settings.rate), 100));
+    reportTimer->start(SIMULATOR_REPORT_INTERVAL * 1000);
+}
+
+void DeviceSimulator::stop()
+{
+    if (generationTimer != nullptr)
+    {
+        generationTimer->stop();
+        reportTimer->stop();
+    }
+}
+
+/*!
+ * \brief DeviceSimulator::handleReadable reads commands sent by the client.
+ */
+void DeviceSimulator::handleReadable()
+{
+#if defined(Q_OS_UNIX)
+    char buffer[256];
+    ssize_t n;
+    while ((n = ::read(masterFd, buffer, sizeof(buffer))) > 0)
+        commandBuffer.append(buffer, static_cast<int>(n));
+
+    int end;
+    while ((end = commandBuffer.indexOf('\n')) >= 0)
+    {
+        processCommand(commandBuffer.left(end).trimmed());
+        commandBuffer.remove(0, end + 1);
+    }
+#endif
+}
+
+void DeviceSimulator::processCommand(const QByteArray &command)
+{
+    if (command == "GET_INFO")
+    {
+        binaryMode = false;
+        sendLine("V" + settings.firmwareVersion().toUtf8() + ";" + settings.macAddress.toUtf8() + "\n");
+        sendFanLevel();
+    }
+    else if (command == "BINARY_ON" && settings.binarySupported)
+    {
+        sendLine("BINARY_OK\n");
+        binaryMode = true;
+    }
+    else if (!command.isEmpty())
+        qDebug() << "Device simulator: Unknown command" << command;
+}
+
+void DeviceSimulator::sendFanLevel()
+{
+    if (binaryMode)
+    {
+        sendLine(BinaryFrameDecoder::encodeFanLevel(settings.fanLevel));
+        return;
+    }
+    sendLine("fan:" + (settings.fanLevel > 0 ? QByteArray::number(settings.fanLevel) : QByteArray("off")) + "\n");
+}
+
+/*!
+ * \brief DeviceSimulator::generateDue sends all measurement and event lines due since the start.
+ * At most SIMULATOR_MAX_BATCH lines are generated per call.
+ */
+void DeviceSimulator::generateDue()
+{
+    double elapsed = clock.nsecsElapsed() * 1e-9;
+
+    quint64 due = static_cast<quint64>(elapsed * settings.rate) + 1;
+    for (int n=0; sampleIndex < due && n < SIMULATOR_MAX_BATCH; n++)
+    {
+        sendLine(measurementLine(sampleIndex));
+        sampleIndex++;
+    }
+
+    quint64 eventsDue = static_cast<quint64>(elapsed * settings.eventRate);
+    for (; eventIndex < eventsDue; eventIndex++)
+        sendLine(binaryMode ? BinaryFrameDecoder::encodeFrame(BinaryFrameDecoder::FrameType::Event, QByteArray()) : QByteArray("event\n"));
+}
+
+QByteArray DeviceSimulator::measurementLine(quint64 sequence)
+{
+    QByteArray line;
+    line.reserve(16 * settings.nChannels + 64);
+
+    double temperature = 25.0 + noiseDistribution(randomGenerator) * 0.1;
+    double humidity = 40.0 + noiseDistribution(randomGenerator) * 0.5;
+
+    // binary frames carry no sequence number to be traced
+    if (binaryMode)
+    {
+        frameValues.resize(static_cast<size_t>(settings.nChannels));
+        for (int i=0; i<settings.nChannels; i++)
+            frameValues[i] = channelBase[i] * (1.0 + 0.001 * noiseDistribution(randomGenerator));
+        return BinaryFrameDecoder::encodeMeasurement(static_cast<quint32>(sequence), frameValues, settings.hasEnvSensors, temperature, humidity);
+    }
+
+    if (settings.protocol == Protocol::V1)
+    {
+        line += "count=" + QByteArray::number(sequence);
+        for (int i=0; i<settings.nChannels; i++)
+        {
+            double value = channelBase[i] * (1.0 + 0.001 * noiseDistribution(randomGenerator));
+            line += ",var" + QByteArray::number(i+1) + "=" + QByteArray::number(value, 'f', 2);
+        }
+        if (settings.hasEnvSensors)
+            line += ",temperature=" + QByteArray::number(temperature, 'f', 2) + ",humidity=" + QByteArray::number(humidity, 'f', 2);
+        if (settings.traceLatency)
+            line += "," + sequenceAttribute.toUtf8() + "=" + QByteArray::number(sequence);
+    }
+    else
+    {
+        // temperature & humidity are always sent
+        line += "start";
+        for (int i=0; i<settings.nChannels; i++)
+        {
+            double value = channelBase[i] * (1.0 + 0.001 * noiseDistribution(randomGenerator));
+            line += ";" + QByteArray::number(value, 'f', 2);
+        }
+        line += ";" + QByteArray::number(temperature, 'f', 2) + ";" + QByteArray::number(humidity, 'f', 2);
+    }
+    line += "\n";
+
+    if (settings.traceLatency && settings.protocol == Protocol::V1)
+    {
+        QMutexLocker locker(&traceMutex);
+        sendTimes[sequence] = monotonicTime();
+        sendOrder.enqueue(sequence);
+        while (sendOrder.size() > SIMULATOR_TRACE_CAPACITY)
+            sendTimes.remove(sendOrder.dequeue());
+    }
+
+    return line;
+}
+
+/*!
+ * \brief DeviceSimulator::sendLine queues \a line and writes as much as possible to the pty.
+ * If more than SIMULATOR_MAX_PENDING bytes are queued because the client does not read, the line is dropped like on a sensor without flow control.
+ */
+void DeviceSimulator::sendLine(const QByteArray &line)
+{
+    if (outBuffer.size() > SIMULATOR_MAX_PENDING)
+    {
+        nLinesDropped++;
+        return;
+    }
+
+    outBuffer += line;
+    nLinesSent++;
+    flush();
+}
+
+void DeviceSimulator::flush()
+{
+#if defined(Q_OS_UNIX)
+    while (!outBuffer.isEmpty())
+    {
+        ssize_t n = ::write(masterFd, outBuffer.constData(), static_cast<size_t>(outBuffer.size()));
+        if (n <= 0)
+            break;
+
+        nBytesSent += static_cast<quint64>(n);
+        outBuffer.remove(0, static_cast<int>(n));
+    }
+#endif
+
+    // continue when the pty can be written again
+    if (writeNotifier != nullptr)
+        writeNotifier->setEnabled(!outBuffer.isEmpty());
+}
+
+/*!
+ * \brief DeviceSimulator::traceReceived records the latency of the measurement line with \a sequence. Thread-safe.
+ */
+void DeviceSimulator::traceReceived(quint64 sequence)
+{
+    qint64 now = monotonicTime();
+
+    QMutexLocker locker(&traceMutex);
+    auto iter = sendTimes.find(sequence);
+    if (iter == sendTimes.end())
+        return;
+
+    qint64 latency = now - iter.value();
+    sendTimes.erase(iter);
+
+    nTraced++;
+    latencySum += latency;
+    latencyMax = qMax(latencyMax, latency);
+}
+
+/*!
+ * \brief DeviceSimulator::report returns the lines sent and the latencies traced since the last report.
+ */
+QString DeviceSimulator::report()
+{
+    double elapsed = clock.isValid() ? clock.elapsed() / 1000.0 : 0.0;
+
+    QString reportString = "Device simulator " + slaveName + ":\tsent: " + QString::number(getNLinesSent()) + " lines";
+    if (elapsed > 0)
+        reportString += " (" + QString::number(getNBytesSent() / elapsed / 1024.0, 'f', 1) + " kB/s)";
+    reportString += ",\tdropped: " + QString::number(getNLinesDropped());
+
+    QMutexLocker locker(&traceMutex);
+    if (nTraced > 0)
+    {
+        reportString += ",\tlatency: mean " + QString::number(latencySum / nTraced * 1e-6, 'f', 3) + " ms, max " + QString::number(latencyMax * 1e-6, 'f', 3) + " ms (" + QString::number(nTraced) + " traced)";
+        nTraced = 0;
+        latencySum = 0.0;
+        latencyMax = 0;
+    }
+
+    return reportString;
+}
+
+void DeviceSimulator::logReport()
+{
+    qDebug().noquote() << report();
+}
+
+QString DeviceSimulator::Settings::firmwareVersion() const
+{
+    return protocol == Protocol::V1 ? "1.1.0" : "2.0.0";
+}
+
+QString DeviceSimulator::Settings::toString() const
+{
+    QStringList settingList;
+    settingList << "firmware: " + firmwareVersion();
+    settingList << "rate: " + QString::number(rate) + " Hz";
+    settingList << "channels: " + QString::number(nChannels);
+    settingList << "env sensors: " + QString(hasEnvSensors ? "yes" : "no");
+    settingList << "events: " + QString::number(eventRate) + "/s";
+    settingList << "fan: " + QString::number(fanLevel);
+    settingList << "binary: " + QString(binarySupported ? "yes" : "no");
+
+    return settingList.join(", ");
+}
@@ -0,0 +1,115 @@
+#ifndef DEVICESIMULATOR_H
+#define DEVICESIMULATOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QSocketNotifier>
+#include <QMutex>
+#include <QHash>
+#include <QQueue>
+
+#include <atomic>
+#include <random>
+
+class DeviceSimulator : public QObject
+{
+    Q_OBJECT
+public:
+    // firmware protocol spoken by the simulated device
+    enum class Protocol {
+        V1, // count=___,var1=____,...
+        V2  // start;____;...
+    };
+
+    struct Settings{
+        Protocol protocol = Protocol::V1;
+        double rate = 1.0;              // measurement lines per second
+        int nChannels = 64;
+        bool hasEnvSensors = true;      // add temperature & humidity to measurement lines
+        double eventRate = 0.0;         // event lines per second
+        int fanLevel = 2;               // 0: off
+        QString macAddress = "30:AE:A4:00:00:01";
+        bool traceLatency = true;       // add sequence number to V1 measurement lines
+        bool binarySupported = false;   // switch to binary frames on BINARY_ON
+        unsigned int seed = 0;
+
+        QString firmwareVersion() const;
+        QString toString() const;
+    };
+
+    explicit DeviceSimulator(Settings settings, QObject *parent = nullptr);
+    ~DeviceSimulator();
+
+    void open();
+
+    QString getSlaveName() const;
+    Settings getSettings() const;
+
+    quint64 getNLinesSent() const;
+    quint64 getNBytesSent() const;
+    quint64 getNLinesDropped() const;
+
+    void traceReceived(quint64 sequence);
+
+    QString report();
+
+    static qint64 monotonicTime();
+
+    static const QString sequenceAttribute;
+
+public slots:
+    void start();
+    void stop();
+
+private slots:
+    void handleReadable();
+    void generateDue();
+    void flush();
+    void logReport();
+
+private:
+    Settings settings;
+
+    int masterFd = -1;
+    int slaveFd = -1;   // kept open, so the master does not see a hangup while no client is connected
+    QString slaveName;
+
+    QSocketNotifier *readNotifier = nullptr;
+    QSocketNotifier *writeNotifier = nullptr;
+    QTimer *generationTimer = nullptr;
+    QTimer *reportTimer = nullptr;
+    QElapsedTimer clock;
+
+    QByteArray commandBuffer;   // received bytes of incomplete commands
+    QByteArray outBuffer;       // lines not yet written to the pty
+
+    quint64 sampleIndex = 0;    // measurement lines generated since start
+    quint64 eventIndex = 0;     // event lines generated since start
+    bool binaryMode = false;    // send binary frames instead of lines
+    std::vector<double> frameValues;
+
+    std::atomic<quint64> nLinesSent{0};
+    std::atomic<quint64> nBytesSent{0};
+    std::atomic<quint64> nLinesDropped{0};
+
+    // latency tracing
+    mutable QMutex traceMutex;
+    QHash<quint64, qint64> sendTimes;   // sequence number -> monotonic time in ns
+    QQueue<quint64> sendOrder;
+    quint64 nTraced = 0;
+    double latencySum = 0.0;            // in ns
+    qint64 latencyMax = 0;
+
+    std::mt19937 randomGenerator;
+    std::normal_distribution<double> noiseDistribution;
+    std::vector<double> channelBase;
+
+    void close();
+    void processCommand(const QByteArray &command);
+    void sendFanLevel();
+    void sendLine(const QByteArray &line);
+    QByteArray measurementLine(quint64 sequence);
+};
+
+#endif // DEVICESIMULATOR_H
@@ -74,7 +74,7 @@ void FakeDatasource::setNextStatus()
         //      emit base vector, receiving data -> error
         if (nextStatus == Status::RECEIVING_DATA)
         {
-            emit baseVectorSet(QDateTime::currentDateTime().toTime_t(), generateMeasurement(50.0));
+            publishBaseVector(QDateTime::currentDateTime().toTime_t(), generateMeasurement(50.0));
             nextStatus = Status::CONNECTION_ERROR;
             statusTimer->start(30000);
             measTimer->start(2000);
@@ -93,9 +93,9 @@ void FakeDatasource::setNextStatus()
 
 AbsoluteMVector FakeDatasource::generateMeasurement(double randRange)
 {
-    MVector vector;
+    MVector vector(nullptr, nChannels);
 
-    for (int i=0; i<MVector::nChannels; i++)
+    for (int i=0; i<nChannels; i++)
         vector[i] = 1000.0 + 50.0*i + randRange*(QRandomGenerator::global()->generateDouble() - 0.5);
     return vector;
 }
@@ -104,7 +104,7 @@ void FakeDatasource::emitMeasurement()
 {
     AbsoluteMVector vector = generateMeasurement();
 
-    emit vectorReceived(QDateTime::currentDateTime().toTime_t(), vector);
+    publishVector(QDateTime::currentDateTime().toTime_t(), vector);
 }
 
 void FakeDatasource::start()
@@ -0,0 +1,200 @@
+#include "fitterbenchmark.h"
+#include "modelfitter.h"
+
+#include <cmath>
+#include <random>
+
+/*!
+ * \class FitterBenchmark
+ * \brief Compares the dlib solvers of ADG_superpos_Fitter, which evaluate the virtual model per sample, to the compile-time ADGModel solved by ModelFitter.
+ * Both backends fit the same synthetic curves with the same random restarts. The results are the time of the restarts,
+ * the rms error of the best valid restart per curve & solver and the time of a residual evaluation, as a JSON object.
+ */
+FitterBenchmark::FitterBenchmark(Settings settings):
+    settings(settings)
+{
+}
+
+QJsonObject FitterBenchmark::run()
+{
+    generateCurves();
+
+    QJsonObject result;
+    result["version"] = QString(GIT_VERSION);
+    result["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    result["nCurves"] = settings.nCurves;
+    result["nSamples"] = settings.nSamples;
+    result["nRestarts"] = settings.nRestarts;
+    result["noise"] = settings.noise;
+    result["seed"] = QString::number(settings.seed);
+
+    std::vector<double> dlibErrors, compiledErrors;
+    QJsonObject dlibResult = runBackend(false, dlibErrors);
+    QJsonObject compiledResult = runBackend(true, compiledErrors);
+
+    // agreement of the best fits
+    double maxRmsDifference = 0.;
+    int nCompiledBetter = 0;
+    for (size_t i=0; i<dlibErrors.size(); i++)
+    {
+        if (std::isfinite(dlibErrors[i]) && std::isfinite(compiledErrors[i]))
+            maxRmsDifference = qMax(maxRmsDifference, std::abs(dlibErrors[i] - compiledErrors[i]));
+        if (compiledErrors[i] <= dlibErrors[i])
+            nCompiledBetter++;
+    }
+
+    result["dlib"] = dlibResult;
+    result["compiled"] = compiledResult;
+    result["restartSpeedup"] = compiledResult["timeMs"].toDouble() > 0. ? dlibResult["timeMs"].toDouble() / compiledResult["timeMs"].toDouble() : 0.;
+    result["evaluationSpeedup"] = compiledResult["evaluationUs"].toDouble() > 0. ? dlibResult["evaluationUs"].toDouble() / compiledResult["evaluationUs"].toDouble() : 0.;
+    result["maxRmsDifference"] = maxRmsDifference;
+    result["fitsCompiledAsGood"] = nCompiledBetter;
+
+    qDebug().noquote() << "restarts: dlib" << QString::number(dlibResult["timeMs"].toDouble(), 'f', 1) << "ms, compiled" << QString::number(compiledResult["timeMs"].toDouble(), 'f', 1)
+                       << "ms, speedup" << QString::number(result["restartSpeedup"].toDouble(), 'f', 2);
+
+    return result;
+}
+
+/*!
+ * \brief FitterBenchmark::generateCurves generates nCurves curves of the ADG model with random parameters and gaussian noise.
+ * Parameters cover a fast and a slow reaction of either sign, as seen in exposition measurements.
+ */
+void FitterBenchmark::generateCurves()
+{
+    std::mt19937 generator(static_cast<std::mt19937::result_type>(settings.seed));
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<double> normal(0.0, 1.0);
+
+    curves.clear();
+    for (int c=0; c<settings.nCurves; c++)
+    {
+        Curve curve;
+        double sign = unit(generator) < 0.5 ? -1. : 1.;
+        curve.parameters(0) = sign * (1. + 9. * unit(generator));     // alpha_1
+        curve.parameters(1) = 0.01 + 0.09 * unit(generator);          // beta_1
+        curve.parameters(2) = -5. * unit(generator);                  // t0_1
+        curve.parameters(3) = sign * (1. + 9. * unit(generator));     // alpha_2
+        curve.parameters(4) = 0.001 + 0.009 * unit(generator);        // beta_2
+        curve.parameters(5) = -5. * unit(generator);                  // t0_2
+
+        double plateau = std::abs(curve.parameters(0) + curve.parameters(3));
+        double values[ADGModel::nParameters];
+        for (int i=0; i<ADGModel::nParameters; i++)
+            values[i] = curve.parameters(i);
+
+        std::vector<double> t(static_cast<size_t>(settings.nSamples)), y(t.size()), buffer(ADGModel::nBuffers * t.size());
+        for (size_t i=0; i<t.size(); i++)
+            t[i] = i;
+        ADGModel::evaluate(t.data(), t.size(), values, y.data(), nullptr, buffer.data());
+
+        for (size_t i=0; i<t.size(); i++)
+            curve.samples.push_back(std::pair<double, double>(t[i], y[i] + settings.noise * plateau * normal(generator)));
+
+        curves.push_back(curve);
+    }
+}
+
+/*!
+ * \brief FitterBenchmark::runBackend runs the restarts of both solvers on all curves with the dlib solvers or, if \a compiled, ModelFitter.
+ * The rms errors of the best valid restart per curve & solver are appended to \a rmsErrors, infinity if no restart was valid.
+ */
+QJsonObject FitterBenchmark::runBackend(bool compiled, std::vector<double> &rmsErrors)
+{
+    QElapsedTimer timer;
+    qint64 totalTime = 0;
+    int nValid = 0, nFits = 0;
+    double rmsSum = 0.;
+
+    for (size_t c=0; c<curves.size(); c++)
+    {
+        const Curve &curve = curves[c];
+        for (LeastSquaresFitter::Solver solver : {LeastSquaresFitter::Solver::LeastSquares, LeastSquaresFitter::Solver::LevenbergMarquardt})
+        {
+            ADG_superpos_Fitter fitter;
+            fitter.setSeed(settings.seed + c);
+            fitter.setUseCompiledModel(compiled);
+            fitter.prepareRestarts(curve.samples, LEAST_SQUARES_LIMIT_FACTOR, solver);
+
+            double bestError = qInf();
+            timer.start();
+            for (int i=0; i<settings.nRestarts; i++)
+            {
+                auto result = fitter.runRestart(i);
+                if (result.valid && result.error < bestError)
+                    bestError = result.error;
+            }
+            totalTime += timer.nsecsElapsed();
+
+            double rmsError = std::sqrt(bestError / curve.samples.size());
+            rmsErrors.push_back(rmsError);
+            nFits++;
+            if (std::isfinite(rmsError))
+            {
+                nValid++;
+                rmsSum += rmsError;
+            }
+        }
+    }
+
+    QJsonObject result;
+    result["timeMs"] = totalTime * 1e-6;
+    result["restartsPerSecond"] = totalTime > 0 ? 1e9 * nFits * settings.nRestarts / totalTime : 0.;
+    result["validFits"] = nValid;
+    result["meanRmsError"] = nValid > 0 ? rmsSum / nValid : 0.;
+    result["evaluationUs"] = evaluationTime(compiled);
+    return result;
+}
+
+/*!
+ * \brief FitterBenchmark::evaluationTime returns the mean time in µs of one residual sum of squares over a curve at its true parameters.
+ */
+double FitterBenchmark::evaluationTime(bool compiled)
+{
+    QElapsedTimer timer;
+    qint64 totalTime = 0;
+    double checksum = 0.;
+
+    for (const Curve &curve : curves)
+    {
+        if (compiled)
+        {
+            std::vector<double> t, y;
+            for (auto sample : curve.samples)
+            {
+                t.push_back(sample.first);
+                y.push_back(sample.second);
+            }
+            ModelFitter<ADGModel> modelFitter(t.data(), y.data(), t.size());
+            ModelFitter<ADGModel>::Parameters parameters;
+            for (int i=0; i<ADGModel::nParameters; i++)
+                parameters[i] = curve.parameters(i);
+
+            timer.start();
+            for (int i=0; i<settings.nEvaluations; i++)
+                checksum += modelFitter.sumOfSquares(parameters);
+            totalTime += timer.nsecsElapsed();
+        }
+        else
+        {
+            ADG_superpos_Fitter fitter;
+            LeastSquaresFitter::RestartResult trueResult;
+            trueResult.valid = true;
+            trueResult.error = 0.;
+            trueResult.parameters = curve.parameters;
+            fitter.setBestResult({trueResult}, 1);
+
+            timer.start();
+            for (int i=0; i<settings.nEvaluations; i++)
+                checksum += fitter.residual_sum_of_sqares(curve.samples);
+            totalTime += timer.nsecsElapsed();
+        }
+    }
+
+    // keeps the evaluations from being optimised away
+    if (!std::isfinite(checksum))
+        qWarning() << "Non-finite residuals in the fitter benchmark";
+
+    int nEvaluations = settings.nEvaluations * static_cast<int>(curves.size());
+    return nEvaluations > 0 ? totalTime * 1e-3 / nEvaluations : 0.;
+}
@@ -0,0 +1,40 @@
+#ifndef FITTERBENCHMARK_H
+#define FITTERBENCHMARK_H
+
+#include <QtCore>
+
+#include <vector>
+
+#include "leastsquaresfitter.h"
+
+class FitterBenchmark
+{
+public:
+    struct Settings{
+        int nCurves = 16;
+        int nSamples = 600;                 // samples per curve, 1 per second
+        int nRestarts = LEAST_SQUARES_N_FITS;   // restarts per curve & solver
+        double noise = 0.01;                // standard deviation of the noise relative to the plateau
+        int nEvaluations = 1000;            // timed residual evaluations per curve
+        quint64 seed = LEAST_SQUARES_SEED;
+    };
+
+    explicit FitterBenchmark(Settings settings = Settings());
+
+    QJsonObject run();
+
+private:
+    struct Curve{
+        std::vector<std::pair<double, double>> samples;
+        parameter_vector parameters;        // parameters the curve was generated with
+    };
+
+    Settings settings;
+    std::vector<Curve> curves;
+
+    void generateCurves();
+    QJsonObject runBackend(bool compiled, std::vector<double> &rmsErrors);
+    double evaluationTime(bool compiled);
+};
+
+#endif // FITTERBENCHMARK_H
@@ -0,0 +1,157 @@
+#include "funcwindowbuffer.h"
+
+#include <algorithm>
+
+/*!
+ * \class FuncWindowBuffer
+ * \brief Keeps the latest func vectors in one preallocated ring per channel, so windows of classifier inputs can be assembled
+ * without storing or copying the history of the measurement.
+ *
+ * Window inputs are laid out channel-major: the values of channel c at the steps 0 (oldest) to length-1 (latest) are at c * length + step.
+ * If slopes are requested, the least-squares slope of each channel per step follows at nChannels * length + c.
+ * The static assemble() builds the same layout from a channel-major series, which is used to classify whole measurements.
+ */
+FuncWindowBuffer::FuncWindowBuffer()
+{
+}
+
+/*!
+ * \brief FuncWindowBuffer::reset clears the buffer and allocates rings of \a capacity vectors for \a nChannels channels.
+ */
+void FuncWindowBuffer::reset(int nChannels, int capacity)
+{
+    Q_ASSERT("Invalid window buffer capacity!" && capacity > 0);
+
+    this->nChannels = nChannels;
+    this->capacity = capacity;
+    size = 0;
+    head = 0;
+    nPushed = 0;
+
+    values.assign(static_cast<size_t>(nChannels) * static_cast<size_t>(capacity), 0.0);
+}
+
+/*!
+ * \brief FuncWindowBuffer::push adds \a funcVector as latest vector. The oldest vector is overwritten if the buffer is full.
+ */
+void FuncWindowBuffer::push(const std::vector<double> &funcVector)
+{
+    Q_ASSERT("Func vector size does not match the window buffer!" && static_cast<int>(funcVector.size()) == nChannels);
+
+    double *slot = values.data() + head;
+    for (int c=0; c<nChannels; c++)
+        slot[static_cast<size_t>(c) * static_cast<size_t>(capacity)] = funcVector[static_cast<size_t>(c)];
+
+    head = (head + 1) % capacity;
+    size = qMin(size + 1, capacity);
+    nPushed++;
+}
+
+int FuncWindowBuffer::getNChannels() const
+{
+    return nChannels;
+}
+
+int FuncWindowBuffer::getCapacity() const
+{
+    return capacity;
+}
+
+/*!
+ * \brief FuncWindowBuffer::getSize returns the number of vectors buffered, at most the capacity.
+ */
+int FuncWindowBuffer::getSize() const
+{
+    return size;
+}
+
+/*!
+ * \brief FuncWindowBuffer::getNPushed returns the number of vectors pushed since the last reset.
+ */
+quint64 FuncWindowBuffer::getNPushed() const
+{
+    return nPushed;
+}
+
+/*!
+ * \brief FuncWindowBuffer::assemble writes the window of the latest \a length vectors to \a input, followed by the slopes if \a slopes is set.
+ * \a input has to hold inputWidth(nChannels, length, slopes) values. At least \a length vectors have to be buffered.
+ */
+void FuncWindowBuffer::assemble(int length, bool slopes, double *input) const
+{
+    Q_ASSERT("Window is longer than the vectors buffered!" && length <= size);
+
+    // window starts at start and wraps at most once
+    int start = (head - length + capacity) % capacity;
+    int firstPart = qMin(length, capacity - start);
+
+    for (int c=0; c<nChannels; c++)
+    {
+        const double *ring = values.data() + static_cast<size_t>(c) * static_cast<size_t>(capacity);
+        double *channelInput = input + static_cast<size_t>(c) * static_cast<size_t>(length);
+
+        std::copy(ring + start, ring + start + firstPart, channelInput);
+        std::copy(ring, ring + length - firstPart, channelInput + firstPart);
+    }
+
+    if (slopes)
+        appendSlopes(nChannels, length, input);
+}
+
+/*!
+ * \brief FuncWindowBuffer::inputWidth returns the number of classifier inputs of a window of \a length vectors with \a nChannels channels.
+ */
+int FuncWindowBuffer::inputWidth(int nChannels, int length, bool slopes)
+{
+    return nChannels * length + (slopes ? nChannels : 0);
+}
+
+/*!
+ * \brief FuncWindowBuffer::assemble writes the window of \a length vectors ending at step \a end of \a series to \a input, followed by the slopes if \a slopes is set.
+ * \a series holds \a seriesLength steps per channel, channel-major. Overlapping windows of one series share its values, only the window itself is copied.
+ */
+void FuncWindowBuffer::assemble(const double *series, int seriesLength, int nChannels, int end, int length, bool slopes, double *input)
+{
+    Q_ASSERT("Window exceeds the series!" && end < seriesLength && end + 1 >= length);
+
+    int start = end + 1 - length;
+    for (int c=0; c<nChannels; c++)
+    {
+        const double *channelSeries = series + static_cast<size_t>(c) * static_cast<size_t>(seriesLength);
+        std::copy(channelSeries + start, channelSeries + end + 1, input + static_cast<size_t>(c) * static_cast<size_t>(length));
+    }
+
+    if (slopes)
+        appendSlopes(nChannels, length, input);
+}
+
+/*!
+ * \brief FuncWindowBuffer::appendSlopes writes the least-squares slope per step of each channel of the window in \a input behind the window.
+ */
+void FuncWindowBuffer::appendSlopes(int nChannels, int length, double *input)
+{
+    double *slopes = input + static_cast<size_t>(nChannels) * static_cast<size_t>(length);
+
+    if (length < 2)
+    {
+        std::fill(slopes, slopes + nChannels, 0.0);
+        return;
+    }
+
+    // steps are centered around their mean, so the slope is sum(dk * x_k) / sum(dk^2)
+    double meanStep = (length - 1) / 2.0;
+    double stepVariance = 0.0;
+    for (int k=0; k<length; k++)
+        stepVariance += (k - meanStep) * (k - meanStep);
+
+    for (int c=0; c<nChannels; c++)
+    {
+        const double *channelInput = input + static_cast<size_t>(c) * static_cast<size_t>(length);
+
+        double covariance = 0.0;
+        for (int k=0; k<length; k++)
+            covariance += (k - meanStep) * channelInput[k];
+
+        slopes[c] = covariance / stepVariance;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef FUNCWINDOWBUFFER_H
+#define FUNCWINDOWBUFFER_H
+
+#include <QtCore>
+
+#include <vector>
+
+class FuncWindowBuffer
+{
+public:
+    FuncWindowBuffer();
+
+    void reset(int nChannels, int capacity);
+    void push(const std::vector<double> &funcVector);
+
+    int getNChannels() const;
+    int getCapacity() const;
+    int getSize() const;
+    quint64 getNPushed() const;
+
+    void assemble(int length, bool slopes, double *input) const;
+
+    static int inputWidth(int nChannels, int length, bool slopes);
+    static void assemble(const double *series, int seriesLength, int nChannels, int end, int length, bool slopes, double *input);
+
+private:
+    int nChannels = 0;
+    int capacity = 0;
+    int size = 0;
+    int head = 0;               // slot of the next vector pushed
+    quint64 nPushed = 0;
+
+    std::vector<double> values; // one ring of capacity values per channel
+
+    static void appendSlopes(int nChannels, int length, double *input);
+};
+
+#endif // FUNCWINDOWBUFFER_H
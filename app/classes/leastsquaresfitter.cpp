@@ -3,6 +3,7 @@
 #include <cmath>
 #include <QtCore>
 
+#include "modelfitter.h"
 #include "defaultSettings.h"
 
 QMap<QString, LeastSquaresFitter::Type> LeastSquaresFitter::typeMap {{"Exposition", LeastSquaresFitter::Type::SUPERPOS}};
@@ -25,146 +26,178 @@ void LeastSquaresFitter::solve(const std::vector<std::pair<double, double> > &sa
 {
     if (CVWIZ_DEBUG_MODE)
         qDebug() << "solve";
-    // find y_max
-    double y_max = 0.;
-    for (auto pair : samples)
-    {
-        if (qAbs(pair.second) > qAbs(y_max))
-            y_max = pair.second;
-    }
 
-    // prepare sample_vector
-    std::vector<std::pair<input_vector, double>> sample_vector;
-    for (std::pair<double, double> sample : samples)
-    {
-        input_vector input;
-        input(0) = sample.first;
-
-        std::pair<input_vector, double> newPair(input, sample.second);
-
-        sample_vector.push_back(newPair);
-    }
-
-    double bestError = std::numeric_limits<double>::infinity();
-    parameter_vector best_parameters;
-    for (int i=0; i<nIterations; i++)
-    {
-        parameter_vector temp_params = getRandomParameterVector(samples);
-//        qDebug() << i << ")";
-//        qDebug() << parameters(0) << ", " << parameters(1) << ", " << parameters(2) << ", " <<  parameters(3) << parameters(4) << parameters(5) << parameters(6) << parameters(7);
-
-        // start solver
-        dlib::solve_least_squares(
-                    dlib::objective_delta_stop_strategy(1e-7, LEAST_SQUARES_MAX_ITERATIONS),
-                    [this](const std::pair<input_vector, double>& data, const parameter_vector& params) -> double
-                      { return residual(data, params);},
-                    [this](const std::pair<input_vector, double>& data, const parameter_vector& params) -> parameter_vector
-                      { return  residual_derivative(data, params);},
-                    sample_vector,
-                    temp_params
-        );
-
-//        qDebug() << parameters(0) << ", " << parameters(1) << ", " << parameters(2) << ", " <<  parameters(3) << parameters(4) << parameters(5) << parameters(6) << parameters(7);
-
-        double error = residual_sum_of_sqares(samples, temp_params);
-//        qDebug() << "Error:\t" << QString::number(error);
-
-        // check parameters
-        // skip if invalid
-        if (!parameters_valid(temp_params, limitFactor * y_max))
-        {
-            if (CVWIZ_DEBUG_MODE)
-                qDebug() << "\n!Parameters invalid!\nPlateau = " << QString::number(temp_params(0) + temp_params(3)) << "\nbeta_1 = " << QString::number(temp_params(1)) << "\nbeta_2 = " << QString::number(temp_params(4)) << "\n\t-> result ignored";
-            continue;
-        }
-
-        if (error < bestError)
-        {
-            if (CVWIZ_DEBUG_MODE) {
-                qDebug() << "\n!Improved error from " << QString::number(bestError) << " to " << QString::number(error) << "!";
-                qDebug() << "alpha_1 = " << QString::number(temp_params(0)) << "\tbeta_1 = " << QString::number(temp_params(1)) << "\tt0_1 = " << QString::number(temp_params(2)) << "\nalpha_2 = " << QString::number(temp_params(3)) << "\tbeta_2 = " << QString::number(temp_params(4)) << "\tt0_2 = " << QString::number(temp_params(5));
-            }
-            bestError = error;
-            best_parameters = temp_params;
-        }
-    }
-    params = best_parameters;
-    if (CVWIZ_DEBUG_MODE) {
-        qDebug() << "-> Best error:\t" << QString::number(bestError);
-        qDebug() << "alpha_1 = " << QString::number(params(0)) << "\tbeta_1 = " << QString::number(params(1)) << "\tt0_1 = " << QString::number(params(2)) << "\nalpha_2 = " << QString::number(params(3)) << "\tbeta_2 = " << QString::number(params(4)) << "\tt0_2 = " << QString::number(params(5));
-    }
+    prepareRestarts(samples, limitFactor, Solver::LeastSquares);
+    solveRestarts(nIterations);
 }
 
 void LeastSquaresFitter::solve_lm(const std::vector<std::pair<double, double> > &samples, int nIterations, double limitFactor)
 {
     if (CVWIZ_DEBUG_MODE)
         qDebug() << "solve_lm";
+
+    prepareRestarts(samples, limitFactor, Solver::LevenbergMarquardt);
+    solveRestarts(nIterations);
+}
+
+/*!
+ * \brief LeastSquaresFitter::prepareRestarts sets the \a samples and the \a solver of the following restarts.
+ * Results are valid if their plateau stays within \a limitFactor times the largest sample:
+ * the largest absolute sample for LeastSquares, the largest positive sample for LevenbergMarquardt.
+ */
+void LeastSquaresFitter::prepareRestarts(const std::vector<std::pair<double, double> > &samples, double limitFactor, Solver solver)
+{
     // find y_max
     double y_max = 0.;
     for (auto pair : samples)
     {
-        if (pair.second > y_max)
+        if (solver == Solver::LevenbergMarquardt ? pair.second > y_max : qAbs(pair.second) > qAbs(y_max))
             y_max = pair.second;
     }
 
-    // prepare sample_vector
-    std::vector<std::pair<input_vector, double>> sample_vector;
+    restartSamples = samples;
+    restartSampleVector.clear();
+    restartTimes.clear();
+    restartValues.clear();
     for (std::pair<double, double> sample : samples)
     {
         input_vector input;
         input(0) = sample.first;
+        restartSampleVector.push_back(std::pair<input_vector, double>(input, sample.second));
+        restartTimes.push_back(sample.first);
+        restartValues.push_back(sample.second);
+    }
+    restartYLimit = limitFactor * y_max;
+    restartSolver = solver;
+}
 
-        std::pair<input_vector, double> newPair(input, sample.second);
+/*!
+ * \brief LeastSquaresFitter::runRestart runs restart \a index of the prepared solver from random parameters and returns its result.
+ * Restart i draws its start parameters from its own generator seeded with (seed, i), so restarts can run in any order and any thread.
+ * The fitter parameters are not changed; several restarts of one fitter can run concurrently.
+ * Restarts with an index below the number of start parameters set start from these instead.
+ * Fitters with a compile-time model are solved by solveCompiled if selected by setUseCompiledModel, by dlib otherwise.
+ */
+LeastSquaresFitter::RestartResult LeastSquaresFitter::runRestart(int index)
+{
+    parameter_vector temp_params;
+    if (index < static_cast<int>(startParameters.size()))
+        temp_params = startParameters[static_cast<size_t>(index)];
+    else
+    {
+        std::seed_seq seedSequence{static_cast<quint32>(seed), static_cast<quint32>(seed >> 32), static_cast<quint32>(index)};
+        std::mt19937 generator(seedSequence);
+        temp_params = getRandomParameterVector(restartSamples, generator);
+    }
 
-        sample_vector.push_back(newPair);
+    RestartResult result;
+    if (!useCompiledModel || !solveCompiled(restartTimes, restartValues, restartSolver, temp_params, result.error, result.nIterations))
+    {
+        result.nIterations = solveDlib(temp_params);
+        result.error = residual_sum_of_sqares(restartSamples, temp_params);
     }
+    result.parameters = temp_params;
+
+    // check parameters
+    // skip if invalid
+    result.valid = parameters_valid(temp_params, restartYLimit);
+    if (!result.valid && CVWIZ_DEBUG_MODE)
+        qDebug() << "\n!Parameters invalid!\nPlateau = " << QString::number(temp_params(0) + temp_params(3)) << "\nbeta_1 = " << QString::number(temp_params(1)) << "\nbeta_2 = " << QString::number(temp_params(4)) << "\n\t-> result ignored";
+
+    return result;
+}
+
+/*!
+ * \brief LeastSquaresFitter::solveDlib improves \a parameters with the prepared dlib solver, evaluating the virtual model & residual_derivative per sample.
+ * Returns the number of solver steps: dlib evaluates the derivatives of all samples once per step.
+ */
+int LeastSquaresFitter::solveDlib(parameter_vector &parameters)
+{
+    qint64 nDerivatives = 0;
+    auto residualFunction = [this](const std::pair<input_vector, double>& data, const parameter_vector& params) -> double
+                              { return residual(data, params);};
+    auto derivativeFunction = [this, &nDerivatives](const std::pair<input_vector, double>& data, const parameter_vector& params) -> parameter_vector
+                              { nDerivatives++; return residual_derivative(data, params);};
+
+    // start solver
+    if (restartSolver == Solver::LevenbergMarquardt)
+        dlib::solve_least_squares_lm(dlib::objective_delta_stop_strategy(LEAST_SQUARES_MIN_DELTA, LEAST_SQUARES_MAX_ITERATIONS), residualFunction, derivativeFunction, restartSampleVector, parameters);
+    else
+        dlib::solve_least_squares(dlib::objective_delta_stop_strategy(LEAST_SQUARES_MIN_DELTA, LEAST_SQUARES_MAX_ITERATIONS), residualFunction, derivativeFunction, restartSampleVector, parameters);
+
+    return restartSampleVector.empty() ? 0 : static_cast<int>(nDerivatives / static_cast<qint64>(restartSampleVector.size()));
+}
+
+/*!
+ * \brief LeastSquaresFitter::solveCompiled improves \a parameters for the samples (\a t, \a y) with a ModelFitter of the fitter's model
+ * and sets their residual \a sumOfSquares and the \a nIterations steps taken. Returns false if the fitter has no compile-time model: the dlib solver is used.
+ */
+bool LeastSquaresFitter::solveCompiled(const std::vector<double> &t, const std::vector<double> &y, Solver solver, parameter_vector &parameters, double &sumOfSquares, int &nIterations) const
+{
+    Q_UNUSED(t)
+    Q_UNUSED(y)
+    Q_UNUSED(solver)
+    Q_UNUSED(parameters)
+    Q_UNUSED(sumOfSquares)
+    Q_UNUSED(nIterations)
+    return false;
+}
 
+/*!
+ * \brief LeastSquaresFitter::reachesTarget returns true if \a result is valid and its rms residual on the prepared samples is within the target error.
+ * Always false if no target error is set.
+ */
+bool LeastSquaresFitter::reachesTarget(const RestartResult &result) const
+{
+    return targetError > 0. && result.valid && result.error <= targetError * targetError * restartSamples.size();
+}
+
+/*!
+ * \brief LeastSquaresFitter::setBestResult sets the parameters to the valid result with the lowest error among the first \a nRestarts \a results.
+ * Ties are resolved by the lower restart index. No valid result: all parameters are zero.
+ */
+void LeastSquaresFitter::setBestResult(const std::vector<RestartResult> &results, int nRestarts)
+{
     double bestError = std::numeric_limits<double>::infinity();
     parameter_vector best_parameters;
-    for (int i=0; i<nIterations; i++)
+    best_parameters = 0;
+    for (int i=0; i<nRestarts && i<static_cast<int>(results.size()); i++)
     {
-        parameter_vector temp_params = getRandomParameterVector(samples);
-
-        // start solver
-        dlib::solve_least_squares_lm(
-                    dlib::objective_delta_stop_strategy(1e-7, LEAST_SQUARES_MAX_ITERATIONS),
-                    [this](const std::pair<input_vector, double>& data, const parameter_vector& params) -> double
-                      { return residual(data, params);},
-                    [this](const std::pair<input_vector, double>& data, const parameter_vector& params) -> parameter_vector
-                      { return  residual_derivative(data, params);},
-                    sample_vector,
-                    temp_params
-        );
-
-        double error = residual_sum_of_sqares(samples, temp_params);
-//        qDebug() << "Error:\t" << QString::number(error);
-
-        // check parameters
-        // skip if invalid
-        if (!parameters_valid(temp_params, limitFactor * y_max))
+        const RestartResult &result = results[static_cast<size_t>(i)];
+        if (result.valid && result.error < bestError)
         {
-            if (CVWIZ_DEBUG_MODE)
-                qDebug() << "\n!Parameters invalid!\nPlateau = " << QString::number(temp_params(0) + temp_params(3)) << "\nbeta_1 = " << QString::number(temp_params(1)) << "\nbeta_2 = " << QString::number(temp_params(4)) << "\n\t-> result ignored";
-            continue;
-        }
-
-        if (error < bestError)
-        {
-            if (CVWIZ_DEBUG_MODE) {
-                qDebug() << "\n!Improved error from " << QString::number(bestError) << " to " << QString::number(error) << "!";
-                qDebug() << "alpha_1 = " << QString::number(temp_params(0)) << "\tbeta_1 = " << QString::number(temp_params(1)) << "\tt0_1 = " << QString::number(temp_params(2)) << "\nalpha_2 = " << QString::number(temp_params(3)) << "\tbeta_2 = " << QString::number(temp_params(4)) << "\tt0_2 = " << QString::number(temp_params(5));
-            }
-            bestError = error;
-            best_parameters = temp_params;
+            bestError = result.error;
+            best_parameters = result.parameters;
         }
     }
+    nRestartsRun = nRestarts;
+
     params = best_parameters;
     if (CVWIZ_DEBUG_MODE) {
-        qDebug() << "-> Best error:\t" << QString::number(bestError);
+        qDebug() << "-> Best error:\t" << QString::number(bestError) << "after" << nRestartsRun << "restarts";
         qDebug() << "alpha_1 = " << QString::number(params(0)) << "\tbeta_1 = " << QString::number(params(1)) << "\tt0_1 = " << QString::number(params(2)) << "\nalpha_2 = " << QString::number(params(3)) << "\tbeta_2 = " << QString::number(params(4)) << "\tt0_2 = " << QString::number(params(5));
     }
 }
 
+/*!
+ * \brief LeastSquaresFitter::solveRestarts runs \a nIterations prepared restarts in the calling thread and keeps the valid result with the lowest error.
+ * If a target error is set, the restarts after the first one reaching it are skipped.
+ * Fits running in parallel submit the restarts to a TaskExecutor instead, see CurveFitWorker.
+ */
+void LeastSquaresFitter::solveRestarts(int nIterations)
+{
+    int end = qMax(0, nIterations);
+    std::vector<RestartResult> results(static_cast<size_t>(end));
+    for (int i=0; i<end; i++)
+    {
+        results[static_cast<size_t>(i)] = runRestart(i);
+        if (reachesTarget(results[static_cast<size_t>(i)]))
+            end = i + 1;
+    }
+
+    setBestResult(results, end);
+}
+
 double LeastSquaresFitter::residual_sum_of_sqares(const std::vector<std::pair<double, double> > &samples) const
 {
     return residual_sum_of_sqares(samples, params);
@@ -231,6 +264,46 @@ void LeastSquaresFitter::resetParams()
     params = 0;
 }
 
+/*!
+ * \brief LeastSquaresFitter::setSeed sets the seed of the random start parameters of the restarts.
+ */
+void LeastSquaresFitter::setSeed(quint64 value)
+{
+    seed = value;
+}
+
+/*!
+ * \brief LeastSquaresFitter::setTargetError sets the rms residual at which a solve stops starting new restarts. 0: all restarts are run.
+ */
+void LeastSquaresFitter::setTargetError(double value)
+{
+    targetError = qMax(0.0, value);
+}
+
+/*!
+ * \brief LeastSquaresFitter::setUseCompiledModel selects the solver of the restarts: the compile-time model of the fitter if \a value is true and it has one, dlib otherwise.
+ */
+void LeastSquaresFitter::setUseCompiledModel(bool value)
+{
+    useCompiledModel = value;
+}
+
+/*!
+ * \brief LeastSquaresFitter::setStartParameters sets the start parameters of the first restarts, e.g. the result of a similar fit. The following restarts start from random parameters.
+ */
+void LeastSquaresFitter::setStartParameters(const std::vector<parameter_vector> &value)
+{
+    startParameters = value;
+}
+
+/*!
+ * \brief LeastSquaresFitter::getNRestartsRun returns the number of restarts the last solve ran before reaching the target error or the number of iterations.
+ */
+int LeastSquaresFitter::getNRestartsRun() const
+{
+    return nRestartsRun;
+}
+
 double LeastSquaresFitter::residual(const std::pair<input_vector, double>& data, const parameter_vector& param_vector) const
 {
     return model(data.first, param_vector) - data.second;
@@ -291,9 +364,13 @@ bool ADG_superpos_Fitter::parameters_valid(const parameter_vector &param_vector,
     return  not_zero && alpha_valid1 && alpha_valid2 && alpha_valid3 && beta_valid;
 }
 
-parameter_vector ADG_superpos_Fitter::getRandomParameterVector(const std::vector<std::pair<double, double> > &samples) const
+parameter_vector ADG_superpos_Fitter::getRandomParameterVector(const std::vector<std::pair<double, double> > &samples, std::mt19937 &generator) const
 {
-    parameter_vector parameters = dlib::randm(params.size(), 1);
+    // uniform in [0; 1)
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    parameter_vector parameters;
+    for (long i=0; i<parameters.size(); i++)
+        parameters(i) = distribution(generator);
 
     // determine helper parameters
     double t_first = std::numeric_limits<double>::infinity();
@@ -346,7 +423,7 @@ parameter_vector ADG_superpos_Fitter::residual_derivative(const std::pair<input_
     der(3) = 1 - std::exp(-beta_2 * (t - t0_2));
 
     der(1) = alpha_1 * (t - t0_1) * std::exp(-beta_1 * (t - t0_1));
-    der(4) = alpha_1 * (t - t0_2) * std::exp(-beta_2 * (t - t0_2));
+    der(4) = alpha_2 * (t - t0_2) * std::exp(-beta_2 * (t - t0_2));
 
     der(2) = -alpha_1 * beta_1 * std::exp(-beta_1 * (t - t0_1));
     der(5) = -alpha_2 * beta_2 * std::exp(-beta_2 * (t - t0_2));
@@ -354,6 +431,28 @@ parameter_vector ADG_superpos_Fitter::residual_derivative(const std::pair<input_
     return der;
 }
 
+/*!
+ * \brief ADG_superpos_Fitter::solveCompiled fits ADGModel with the damped Gauss-Newton steps of ModelFitter.
+ * LeastSquares uses Marquardt damping, LevenbergMarquardt Levenberg damping, so the two solvers still take different paths from the same start parameters.
+ */
+bool ADG_superpos_Fitter::solveCompiled(const std::vector<double> &t, const std::vector<double> &y, Solver solver, parameter_vector &parameters, double &sumOfSquares, int &nIterations) const
+{
+    typedef ModelFitter<ADGModel> Fitter;
+
+    Fitter::Parameters modelParameters;
+    for (int i=0; i<Fitter::nParameters; i++)
+        modelParameters[i] = parameters(i);
+
+    Fitter fitter(t.data(), y.data(), t.size());
+    sumOfSquares = fitter.solve(modelParameters, solver == Solver::LevenbergMarquardt ? Fitter::Damping::Levenberg : Fitter::Damping::Marquardt,
+                                LEAST_SQUARES_MAX_ITERATIONS, LEAST_SQUARES_MIN_DELTA);
+    nIterations = fitter.getNIterations();
+
+    for (int i=0; i<Fitter::nParameters; i++)
+        parameters(i) = modelParameters[i];
+    return true;
+}
+
 /*!
  * \brief ARM_Fitter::tau_90
  * t_zero_intersection = t0 - log(- gamma / alpha) / beta
@@ -4,9 +4,15 @@
 #include <dlib/optimization.h>
 #include <QtCore>
 
+#include <limits>
+#include <random>
+
 #define LEAST_SQUARES_N_FITS 20   // number of iterations
 #define LEAST_SQUARES_LIMIT_FACTOR 1.5
 #define LEAST_SQUARES_MAX_ITERATIONS 75
+#define LEAST_SQUARES_SEED 42               // seed of the random restarts
+#define LEAST_SQUARES_COMPILED_MODEL false  // true: restarts use the compile-time model of the fitter (ModelFitter) if it has one; compare both with --benchmark-fitter
+#define LEAST_SQUARES_MIN_DELTA 1e-7        // restarts stop when the objective changes less in a step
 
 typedef dlib::matrix<double,1,1> input_vector;
 typedef dlib::matrix<double,6,1> parameter_vector;
@@ -19,6 +25,14 @@ class LeastSquaresFitter
 {
 public:
     enum class Type {SUPERPOS};
+    enum class Solver {LeastSquares, LevenbergMarquardt};
+
+    struct RestartResult{
+        bool valid = false;
+        double error = std::numeric_limits<double>::infinity();
+        parameter_vector parameters;
+        int nIterations = 0;            // solver steps
+    };
 
     LeastSquaresFitter();
 
@@ -48,6 +62,18 @@ public:
 
     void resetParams();
 
+    void setSeed(quint64 value);
+    void setTargetError(double value);
+    void setUseCompiledModel(bool value);
+    void setStartParameters(const std::vector<parameter_vector> &value);
+
+    int getNRestartsRun() const;
+
+    void prepareRestarts(const std::vector<std::pair<double, double>>& samples, double limitFactor, Solver solver);
+    RestartResult runRestart(int index);
+    bool reachesTarget(const RestartResult &result) const;
+    void setBestResult(const std::vector<RestartResult> &results, int nRestarts);
+
 protected:
     parameter_vector params;
     QList<QString> parameterNames;
@@ -70,9 +96,28 @@ protected:
         const parameter_vector& params
     ) const;
 
-    virtual parameter_vector getRandomParameterVector(const std::vector<std::pair<double, double>>& samples) const = 0;
+    virtual parameter_vector getRandomParameterVector(const std::vector<std::pair<double, double>>& samples, std::mt19937 &generator) const = 0;
 
     virtual bool parameters_valid(const parameter_vector &param_vector, double y_limit) const = 0;
+
+    virtual bool solveCompiled(const std::vector<double> &t, const std::vector<double> &y, Solver solver, parameter_vector &parameters, double &sumOfSquares, int &nIterations) const;
+
+private:
+    quint64 seed = LEAST_SQUARES_SEED;
+    double targetError = 0.0;           // rms residual stopping the restarts, 0: run all restarts
+    int nRestartsRun = 0;
+    bool useCompiledModel = LEAST_SQUARES_COMPILED_MODEL;
+    std::vector<parameter_vector> startParameters;  // start of the first restarts instead of random parameters
+
+    // restarts prepared by prepareRestarts()
+    std::vector<std::pair<double, double>> restartSamples;
+    std::vector<std::pair<input_vector, double>> restartSampleVector;
+    std::vector<double> restartTimes, restartValues;
+    double restartYLimit = 0.;
+    Solver restartSolver = Solver::LeastSquares;
+
+    void solveRestarts(int nIterations);
+    int solveDlib(parameter_vector &parameters);
 };
 
 /*!
@@ -104,9 +149,11 @@ protected:
         const parameter_vector& parameter_vector
     );
 
-    parameter_vector getRandomParameterVector(const std::vector<std::pair<double, double>>& samples) const;
+    parameter_vector getRandomParameterVector(const std::vector<std::pair<double, double>>& samples, std::mt19937 &generator) const;
 
     virtual bool parameters_valid(const parameter_vector &param_vector, double y_limit) const override;
+
+    bool solveCompiled(const std::vector<double> &t, const std::vector<double> &y, Solver solver, parameter_vector &parameters, double &sumOfSquares, int &nIterations) const override;
 };
 
 class LinearFitter
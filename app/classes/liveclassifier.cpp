@@ -0,0 +1,143 @@
+#include "liveclassifier.h"
+
+/*!
+ * \class LiveClassifier
+ * \brief Classifies the vectors received during a measurement in a dedicated inference thread.
+ * The inputs submitted are passed through a mailbox with a single slot: an input not yet classified is replaced by the next one,
+ * so a slow model never backs up and the latency of each result is bounded by about two inferences.
+ * Results are passed asynchronously by annotationReady.
+ *
+ * The LiveClassifier is not deleted directly: stop() requests its thread to finish without waiting for a running inference.
+ * \a classifier must be kept until the thread finished. The LiveClassifier deletes itself when its thread finished,
+ * the thread deletes itself in the event loop of the thread that created it.
+ */
+LiveClassifier::LiveClassifier(Classifier *classifier):
+    QObject(),
+    classifier(classifier),
+    thread(new QThread())
+{
+    Q_ASSERT(classifier != nullptr);
+    qRegisterMetaType<Annotation>("Annotation");
+
+    clock.start();
+
+    moveToThread(thread);
+    connect(thread, &QThread::finished, this, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    thread->start();
+}
+
+/*!
+ * \brief LiveClassifier::stop requests the inference thread to finish after a running inference and returns immediately. Inputs pending are dropped.
+ * The LiveClassifier deletes itself when its thread finished and must not be used afterwards.
+ */
+void LiveClassifier::stop()
+{
+    thread->requestInterruption();
+    thread->quit();
+}
+
+/*!
+ * \brief LiveClassifier::getThread returns the inference thread. It finishes after stop() was called.
+ */
+QThread *LiveClassifier::getThread() const
+{
+    return thread;
+}
+
+/*!
+ * \brief LiveClassifier::submit replaces the pending input by \a input and schedules its classification. Can be called from any thread.
+ */
+void LiveClassifier::submit(const std::vector<double> &input)
+{
+    QMutexLocker locker(&mutex);
+
+    nSubmitted++;
+    if (hasPending)
+        nCoalesced++;
+
+    pendingInput = input;
+    pendingTime = clock.nsecsElapsed();
+    hasPending = true;
+
+    if (!processScheduled)
+    {
+        processScheduled = true;
+        QMetaObject::invokeMethod(this, "process", Qt::QueuedConnection);
+    }
+}
+
+void LiveClassifier::process()
+{
+    std::vector<double> input;
+    qint64 submitTime;
+    {
+        QMutexLocker locker(&mutex);
+        processScheduled = false;
+        if (!hasPending || thread->isInterruptionRequested())
+            return;
+
+        input.swap(pendingInput);
+        submitTime = pendingTime;
+        hasPending = false;
+    }
+
+    try {
+        // live inputs hardly recur: the cache is kept for the measurement's inputs
+        Annotation annotation = classifier->getAnnotation(input, false);
+        qint64 latency = clock.nsecsElapsed() - submitTime;
+
+        {
+            QMutexLocker locker(&mutex);
+            nClassified++;
+            latencySum += latency;
+            latencyMax = qMax(latencyMax, latency);
+        }
+
+        emit annotationReady(annotation, latency * 1e-6);
+    } catch (std::invalid_argument& e) {
+        emit error(e.what());
+    }
+}
+
+quint64 LiveClassifier::getNSubmitted() const
+{
+    QMutexLocker locker(&mutex);
+    return nSubmitted;
+}
+
+quint64 LiveClassifier::getNClassified() const
+{
+    QMutexLocker locker(&mutex);
+    return nClassified;
+}
+
+/*!
+ * \brief LiveClassifier::getNCoalesced returns the number of inputs replaced by a newer one before they were classified.
+ */
+quint64 LiveClassifier::getNCoalesced() const
+{
+    QMutexLocker locker(&mutex);
+    return nCoalesced;
+}
+
+/*!
+ * \brief LiveClassifier::getMeanLatency returns the mean time in ms from submitting an input to its result.
+ */
+double LiveClassifier::getMeanLatency() const
+{
+    QMutexLocker locker(&mutex);
+    return nClassified > 0 ? latencySum * 1e-6 / nClassified : 0.0;
+}
+
+double LiveClassifier::getMaxLatency() const
+{
+    QMutexLocker locker(&mutex);
+    return latencyMax * 1e-6;
+}
+
+QString LiveClassifier::statistics() const
+{
+    return "Live classification: " + QString::number(getNClassified()) + " of " + QString::number(getNSubmitted()) + " inputs classified, "
+            + QString::number(getNCoalesced()) + " coalesced, latency: " + QString::number(getMeanLatency(), 'f', 2) + " ms (max " + QString::number(getMaxLatency(), 'f', 2) + " ms)";
+}
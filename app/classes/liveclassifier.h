@@ -0,0 +1,61 @@
+#ifndef LIVECLASSIFIER_H
+#define LIVECLASSIFIER_H
+
+#include <QObject>
+#include <QtCore>
+
+#include "annotation.h"
+#include "classifier.h"
+
+class LiveClassifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LiveClassifier(Classifier *classifier);
+
+    void stop();
+    QThread *getThread() const;
+    void submit(const std::vector<double> &input);
+
+    quint64 getNSubmitted() const;
+    quint64 getNClassified() const;
+    quint64 getNCoalesced() const;
+    double getMeanLatency() const;
+    double getMaxLatency() const;
+
+    QString statistics() const;
+
+Q_SIGNALS:
+    /*!
+     * \brief annotationReady is emitted from the inference thread when the latest input was classified.
+     * \a latency is the time in ms from submitting the input to the result.
+     */
+    void annotationReady(Annotation annotation, double latency);
+
+    void error(QString errorMessage);
+
+private Q_SLOTS:
+    void process();
+
+private:
+    Classifier *classifier;
+    QThread *thread;
+    QElapsedTimer clock;
+
+    // mailbox, only the latest input submitted is kept
+    mutable QMutex mutex;
+    std::vector<double> pendingInput;
+    qint64 pendingTime = 0;         // in ns since the construction
+    bool hasPending = false;
+    bool processScheduled = false;
+
+    // statistics
+    quint64 nSubmitted = 0;
+    quint64 nClassified = 0;
+    quint64 nCoalesced = 0;
+    qint64 latencySum = 0;          // in ns
+    qint64 latencyMax = 0;          // in ns
+};
+
+#endif // LIVECLASSIFIER_H
@@ -184,6 +184,34 @@ void MeasurementData::addVector(uint timestamp, AbsoluteMVector vector, Absolute
     addVector(timestamp, vector);
 }
 
+/*!
+ * \brief MeasurementData::addVectors adds \a vectors. Vectors at timestamps already in data are skipped.
+ * Emits vectorsAdded once for all added vectors instead of vectorAdded for each vector.
+ * Returns the number of vectors added.
+ */
+int MeasurementData::addVectors(const QMap<uint, AbsoluteMVector> &vectors)
+{
+    bool prevReplotStatus = replotStatus;
+    replotStatus = false;
+
+    QMap<uint, AbsoluteMVector> addedVectors;
+    for (auto it = vectors.constBegin(); it != vectors.constEnd(); ++it)
+    {
+        if (data.contains(it.key()))
+            continue;
+
+        addVector(it.key(), it.value());
+        addedVectors.insert(it.key(), data[it.key()]);
+    }
+
+    replotStatus = prevReplotStatus;
+
+    if (replotStatus && !addedVectors.isEmpty())
+        emit vectorsAdded(addedVectors, functionalisation, sensorFailures);
+
+    return addedVectors.size();
+}
+
 void MeasurementData::setData(QMap<uint, AbsoluteMVector> absoluteData, QMap<uint, AbsoluteMVector> baseVectors)
 {
     // clear data
@@ -318,6 +346,14 @@ void MeasurementData::setBaseVector(uint timestamp, AbsoluteMVector baseVector)
     }
 }
 
+/*!
+ * \brief MeasurementData::getBaseVectorMap returns the base vectors by the timestamp from which on they apply.
+ */
+QMap<uint, AbsoluteMVector> MeasurementData::getBaseVectorMap() const
+{
+    return baseVectorMap;
+}
+
 Functionalisation MeasurementData::getFunctionalisation() const
 {
     return functionalisation;
@@ -491,7 +527,7 @@ bool MeasurementData::saveData(QString filename, QMap<uint, MVector> map)
     {
         out << "#baseLevel:" << getTimestampStringFromUInt(timestamp) << ";";
         QStringList valueList;
-        for (int i=0; i<MVector::nChannels; i++)
+        for (int i=0; i<nChannels(); i++)
             valueList << QString::number(baseVectorMap[timestamp][i], 'g', 10);
         out <<  valueList.join(";") << "\n";
     }
@@ -515,7 +551,7 @@ bool MeasurementData::saveData(QString filename, QMap<uint, MVector> map)
 
     headerList << "#header:timestamp";
 
-    for (int i=0; i<MVector::nChannels; i++)
+    for (int i=0; i<nChannels(); i++)
         headerList << "ch" + QString::number(i+1);
 
     for (QString sensorAttribute : sensorAttributes)
@@ -535,7 +571,7 @@ bool MeasurementData::saveData(QString filename, QMap<uint, MVector> map)
         valueList << getTimestampStringFromUInt(iter.key());      // timestamp
 
         // vector
-        for (int i=0; i<MVector::nChannels; i++)
+        for (int i=0; i<nChannels(); i++)
             valueList << QString::number(iter.value()[i], 'g', 10);
         // sensor attributes
         for (QString attribute : iter.value().sensorAttributes.keys())
@@ -1030,6 +1066,33 @@ void MeasurementData::setDetectedAnnotation(Annotation annotation, uint timestam
     emit annotationsChanged(changedMap, false);
 }
 
+/*!
+ * \brief MeasurementData::setDetectedAnnotations sets the detected annotations at the timestamps of \a annotations.
+ * Timestamps not contained in the data are skipped. Emits annotationsChanged once for all annotations set.
+ */
+void MeasurementData::setDetectedAnnotations(const QMap<uint, Annotation> &annotations)
+{
+    QMap<uint, Annotation> changedMap;
+
+    for (auto it = annotations.constBegin(); it != annotations.constEnd(); ++it)
+    {
+        if (!data.contains(it.key()))
+            continue;
+
+        data[it.key()].detectedAnnotation = it.value();
+        if (selectedData.contains(it.key()))
+            selectedData[it.key()].detectedAnnotation = it.value();
+
+        changedMap[it.key()] = it.value();
+    }
+
+    if (changedMap.isEmpty())
+        return;
+
+    setDataChanged(true);
+    emit annotationsChanged(changedMap, false);
+}
+
 void MeasurementData::setDetectedAnnotationOfSelection(Annotation annotation)
 {
     QMap<uint, Annotation> changedMap;
@@ -1427,6 +1490,55 @@ FileReader::FileReaderType FileReader::getType()
     return FileReaderType::General;
 }
 
+/*!
+ * \brief FileReader::setExpectedNChannels makes readFile() fail after the header of files that have not \a value channels, before any values are parsed.
+ * 0: files with any channel count are read.
+ */
+void FileReader::setExpectedNChannels(uint value)
+{
+    expectedNChannels = value;
+}
+
+/*!
+ * \brief FileReader::setNChannels is called by the readers when the header defined the channel count \a nChannels.
+ * Throws std::runtime_error if another channel count is expected, emits resetNChannels otherwise.
+ */
+void FileReader::setNChannels(uint nChannels)
+{
+    if (expectedNChannels != 0 && nChannels != expectedNChannels)
+        throw std::runtime_error("File has " + std::to_string(nChannels) + " channels, expected " + std::to_string(expectedNChannels) + ".");
+
+    emit resetNChannels(nChannels); // resets MVector::nChannels if connected
+}
+
+/*!
+ * \brief FileReader::setRegisterClasses sets if the classes declared in the file are added to the global class set while reading.
+ * The class set is not synchronised: readers running in worker threads collect the classes, which are registered by the calling thread via getClasses().
+ */
+void FileReader::setRegisterClasses(bool value)
+{
+    registerClasses = value;
+}
+
+/*!
+ * \brief FileReader::getClasses returns the classes declared in the file read.
+ */
+QList<aClass> FileReader::getClasses() const
+{
+    return fileClasses;
+}
+
+/*!
+ * \brief FileReader::addClass records \a newClass declared in the file and registers it if set by setRegisterClasses.
+ */
+void FileReader::addClass(aClass newClass)
+{
+    fileClasses << newClass;
+
+    if (registerClasses && !aClass::staticClassSet.contains(newClass))
+        data->addClass(newClass);
+}
+
 MeasurementData* FileReader::getMeasurementData()
 {
     // reset dataChanged
@@ -1535,10 +1647,7 @@ void AnnotatorFileReader::parseHeader(QString line)
 
             if (!aClass::isClassString(classString))
                 throw std::runtime_error("Error in line " + std::to_string(lineCount+1) + ".\n" + classString.toStdString() + " is not a class string!");
-            aClass c = aClass::fromString(classString);
-
-            if (!aClass::staticClassSet.contains(c))
-                data->addClass(c);
+            addClass(aClass::fromString(classString));
         }
     }
     else if (line.startsWith("#header:"))
@@ -1577,8 +1686,8 @@ void AnnotatorFileReader::parseHeader(QString line)
         }
         // after parsing the header:
         // reset number of channels
+        setNChannels(resistanceIndexMap.size());
         data->resetNChannels(resistanceIndexMap.size());
-        emit resetNChannels(resistanceIndexMap.size()); // resets MVector::nChannels if connected
 
         // set data meta attributes
         data->setSensorFailures(failureString);
@@ -1765,7 +1874,7 @@ void LabviewFileReader::parseHeader(QString line)
 
     // prepare MVector class:
     // MVector default size is number of resistance values
-    emit resetNChannels(resistanceIndexes.size());
+    setNChannels(resistanceIndexes.size());
     data->resetNChannels(resistanceIndexes.size());
     data->addAttributes(sensorAttributeIndexMap.keys());
 }
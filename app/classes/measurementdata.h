@@ -163,6 +163,7 @@ public:
      * returns baselevel at timestamp
      */
     AbsoluteMVector* getBaseVector (uint timestamp);
+    QMap<uint, AbsoluteMVector> getBaseVectorMap() const;
 
     Functionalisation getFunctionalisation() const;
     void setFunctionalisation(const Functionalisation &value);
@@ -190,6 +191,11 @@ public:
      */
     void setDetectedAnnotation(Annotation annotation, uint timestamp);
 
+    /*
+     * sets the detected annotations of all timestamps in annotations, emits annotationsChanged once
+     */
+    void setDetectedAnnotations(const QMap<uint, Annotation> &annotations);
+
     static QString getTimestampStringFromUInt(uint timestamp);
     static uint getTimestampUIntfromString (QString string);
 
@@ -247,6 +253,12 @@ public slots:
      */
     void addVector(uint timestamp, AbsoluteMVector vector, AbsoluteMVector baseLevelVector);
 
+    /*
+     * add several absolute vectors, emits vectorsAdded once
+     * returns the number of vectors added
+     */
+    int addVectors(const QMap<uint, AbsoluteMVector> &vectors);
+
     void checkLimits (const AbsoluteMVector &vector);
     void checkLimits ();
 
@@ -261,6 +273,7 @@ signals:
     void selectionCleared();
 
     void vectorAdded(uint timestamp, AbsoluteMVector vector, Functionalisation functionalisation , std::vector<bool> sensorFailures, bool yRescale);
+    void vectorsAdded(const QMap<uint, AbsoluteMVector> &vectors, const Functionalisation &functionalisation, const std::vector<bool> &sensorFailures);
     void dataSet(const QMap<uint, AbsoluteMVector> &data, const Functionalisation &functionalisation, const std::vector<bool> &sensorFailures);
     void dataCleared();
 
@@ -324,13 +337,23 @@ public:
 
     virtual FileReaderType getType();
 
+    void setExpectedNChannels(uint value);
+    void setRegisterClasses(bool value);
+    QList<aClass> getClasses() const;
+
 signals:
     void resetNChannels(uint nChannels);
 
 private:
-
+    uint expectedNChannels = 0;     // 0: any channel count
+    bool registerClasses = true;    // false: the classes of the file are only collected, e.g. when reading in a worker thread
 
 protected:
+    void setNChannels(uint nChannels);
+    void addClass(aClass newClass);
+
+    QList<aClass> fileClasses;      // classes declared in the file
+
     MeasurementData* data;
     QFile file;
     QTextStream in;
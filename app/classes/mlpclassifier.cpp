@@ -0,0 +1,794 @@
+#include "mlpclassifier.h"
+#include "funcwindowbuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define MLP_KERNEL_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define MLP_KERNEL_SSE
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MLP_KERNEL_NEON
+#endif
+
+namespace {
+
+const char fileMagic[4] = {'E', 'M', 'L', 'P'};
+const quint32 fileVersion = 1;
+
+// weight rows & activations are padded to multiples of kPadding floats, so the kernels have no remainder loops
+const int kPadding = 8;
+// output neurons computed together, sharing the loads of the input
+const int kRowTile = 4;
+// weights of the output neurons processed for all rows of a batch before moving on: fits into the L2 cache
+const size_t kBlockBytes = 256 * 1024;
+
+// activations of the calling thread, reused by all inferences of the thread: [0] input & odd layers, [1] even layers
+thread_local std::vector<float> activationBuffers[2];
+
+float *activationBuffer(int index, size_t size)
+{
+    std::vector<float> &buffer = activationBuffers[index];
+    if (buffer.size() < size)
+        buffer.resize(size, 0.0f);
+    return buffer.data();
+}
+
+int padded(int size)
+{
+    return (size + kPadding - 1) / kPadding * kPadding;
+}
+
+/*!
+ * \brief dot4 writes the dot products of the kRowTile weight rows starting at \a weights with \a input, plus \a bias, to \a output.
+ * \a n is the padded row length, a multiple of kPadding.
+ */
+inline void dot4(const float *weights, int n, const float *input, const float *bias, float *output)
+{
+    const float *w0 = weights;
+    const float *w1 = w0 + n;
+    const float *w2 = w1 + n;
+    const float *w3 = w2 + n;
+
+#if defined(MLP_KERNEL_AVX)
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps(), acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+    for (int k=0; k<n; k+=8)
+    {
+        __m256 x = _mm256_loadu_ps(input + k);
+#if defined(__FMA__)
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(w0 + k), x, acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(w1 + k), x, acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(w2 + k), x, acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(w3 + k), x, acc3);
+#else
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(w0 + k), x));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(w1 + k), x));
+        acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(_mm256_loadu_ps(w2 + k), x));
+        acc3 = _mm256_add_ps(acc3, _mm256_mul_ps(_mm256_loadu_ps(w3 + k), x));
+#endif
+    }
+    // reduce each accumulator: per 128 bit lane [sum0, sum1, sum2, sum3], then add the lanes
+    __m256 sum = _mm256_hadd_ps(_mm256_hadd_ps(acc0, acc1), _mm256_hadd_ps(acc2, acc3));
+    __m128 result = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    _mm_storeu_ps(output, _mm_add_ps(result, _mm_loadu_ps(bias)));
+#elif defined(MLP_KERNEL_SSE)
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps(), acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+    for (int k=0; k<n; k+=4)
+    {
+        __m128 x = _mm_loadu_ps(input + k);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(w0 + k), x));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(w1 + k), x));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(w2 + k), x));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(w3 + k), x));
+    }
+    // after the transpose, lane i of the sum is the sum of acc_i
+    _MM_TRANSPOSE4_PS(acc0, acc1, acc2, acc3);
+    __m128 result = _mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3));
+    _mm_storeu_ps(output, _mm_add_ps(result, _mm_loadu_ps(bias)));
+#elif defined(MLP_KERNEL_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f), acc2 = vdupq_n_f32(0.0f), acc3 = vdupq_n_f32(0.0f);
+    for (int k=0; k<n; k+=4)
+    {
+        float32x4_t x = vld1q_f32(input + k);
+        acc0 = vmlaq_f32(acc0, vld1q_f32(w0 + k), x);
+        acc1 = vmlaq_f32(acc1, vld1q_f32(w1 + k), x);
+        acc2 = vmlaq_f32(acc2, vld1q_f32(w2 + k), x);
+        acc3 = vmlaq_f32(acc3, vld1q_f32(w3 + k), x);
+    }
+    float32x2_t sum01 = vpadd_f32(vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0)), vadd_f32(vget_low_f32(acc1), vget_high_f32(acc1)));
+    float32x2_t sum23 = vpadd_f32(vadd_f32(vget_low_f32(acc2), vget_high_f32(acc2)), vadd_f32(vget_low_f32(acc3), vget_high_f32(acc3)));
+    vst1q_f32(output, vaddq_f32(vcombine_f32(sum01, sum23), vld1q_f32(bias)));
+#else
+    float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+    for (int k=0; k<n; k++)
+    {
+        float x = input[k];
+        sum0 += w0[k] * x;
+        sum1 += w1[k] * x;
+        sum2 += w2[k] * x;
+        sum3 += w3[k] * x;
+    }
+    output[0] = sum0 + bias[0];
+    output[1] = sum1 + bias[1];
+    output[2] = sum2 + bias[2];
+    output[3] = sum3 + bias[3];
+#endif
+}
+
+void softmax(float *values, int n, bool logarithmic)
+{
+    float max = *std::max_element(values, values + n);
+
+    float sum = 0.0f;
+    for (int i=0; i<n; i++)
+        sum += std::exp(values[i] - max);
+
+    if (logarithmic)
+    {
+        float logSum = max + std::log(sum);
+        for (int i=0; i<n; i++)
+            values[i] -= logSum;
+    }
+    else
+    {
+        for (int i=0; i<n; i++)
+            values[i] = std::exp(values[i] - max) / sum;
+    }
+}
+
+void sigmoid(float *values, int n)
+{
+    for (int i=0; i<n; i++)
+        values[i] = 1.0f / (1.0f + std::exp(-values[i]));
+}
+
+}
+
+/*!
+ * \class MlpClassifier
+ * \brief Classifies func vectors with a multi-layer perceptron of dense layers, evaluated by built-in kernels instead of libtorch.
+ * Loads the compact model files (.mlp) exported from TorchScript classifiers by TorchClassifier::exportMlp.
+ * The attributes of the model are the same as for TorchScript classifiers and are interpreted the same way.
+ *
+ * File format, little endian (QDataStream): the magic "EMLP", quint32 format version, the attributes as compact JSON in a QByteArray,
+ * quint32 number of layers, then per layer: qint32 inputs, qint32 outputs, the activation name (QByteArray), float negative slope of LeakyReLU,
+ * quint8 1 if a bias follows, the float32 weights row-major (one row per output) and the float32 bias.
+ *
+ * Throws no exceptions at load: \a loadOk is set to false and the problems are appended to \a errorString.
+ */
+MlpClassifier::MlpClassifier(QObject *parent, QString filename, bool* loadOk, QString *errorString, int nInputs, Settings settings):
+    Classifier(parent),
+    filename(filename),
+    N{nInputs}
+{
+    Q_ASSERT(loadOk != nullptr);
+
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+
+    *loadOk = false;
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        *errorString += "Could not open " + filename + ": " + file.errorString() + "\n";
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    char magic[4];
+    quint32 version = 0;
+    if (stream.readRawData(magic, 4) != 4 || !std::equal(magic, magic + 4, fileMagic))
+    {
+        *errorString += filename + " is no MLP classifier file.\n";
+        return;
+    }
+    stream >> version;
+    if (version != fileVersion)
+    {
+        *errorString += "MLP classifier file version " + QString::number(version) + " is not supported.\n";
+        return;
+    }
+
+    QByteArray attributeJson;
+    stream >> attributeJson;
+    QJsonParseError parseError;
+    QJsonDocument attributeDocument = QJsonDocument::fromJson(attributeJson, &parseError);
+    if (!attributeDocument.isObject())
+    {
+        *errorString += "Attributes of the model could not be read: " + parseError.errorString() + "\n";
+        return;
+    }
+
+    *loadOk = readAttributes(attributeDocument.object(), nInputs, errorString);
+    if (*loadOk)
+        *loadOk = readLayers(stream, errorString);
+
+    // model key: hash of the model file & preset
+    QCryptographicHash fileHash(QCryptographicHash::Sha1);
+    if (file.seek(0) && fileHash.addData(&file))
+        modelKey = fileHash.result() + presetName.toUtf8();
+    else
+        modelKey = filename.toUtf8() + presetName.toUtf8();
+
+    if (*loadOk)
+    {
+        warmUp(settings.nWarmupRuns);
+
+        loadTime = loadTimer.nsecsElapsed() * 1e-6;
+        qDebug().noquote() << "Classifier" << name << "loaded in" << QString::number(loadTime, 'f', 1) << "ms (" + QString::number(layers.size()) + " layers, " + QString::number(getNParameters()) + " parameters)";
+    }
+    else
+    {
+        *errorString += "See the classifier section <a href=\"https://github.com/Tilagiho/eNoseAnnotator/blob/master/README.md\">documentation</a> for more information.\n";
+    }
+}
+
+/*!
+ * \brief MlpClassifier::readAttributes reads the model attributes, named as the attributes of TorchScript classifiers.
+ * nInputs <= 0: the input size is taken from the attribute N.
+ */
+bool MlpClassifier::readAttributes(const QJsonObject &attributes, int nInputs, QString *errorString)
+{
+    bool ok = true;
+
+    // required attributes
+    if (!attributes.contains("classList"))
+    {
+        *errorString += "No class list provided with model.\n";
+        return false;
+    }
+    classNames = attributes["classList"].toString().split(",");
+
+    // optional attributes
+    name = attributes.contains("name") ? attributes["name"].toString() : filename;
+
+    if (N <= 0)
+    {
+        if (!attributes.contains("N"))
+        {
+            *errorString += "Input size of the model is unknown: no N provided with model.\n";
+            return false;
+        }
+        N = attributes["N"].toInt();
+    }
+
+    if (attributes.contains("N") && attributes["N"].toInt() <= 0)
+    {
+        *errorString += "Model is inconsistent: attribute N is " + attributes["N"].toVariant().toString() + ", the input size has to be a positive number!\n";
+        return false;
+    }
+
+    if (attributes.contains("N") && attributes["N"].toInt() != N)
+    {
+        ok = false;
+        *errorString += "Model takes " + QString::number(attributes["N"].toInt()) + " inputs (attribute N), but " + QString::number(N) + " were provided!\n";
+    }
+
+    if (attributes.contains("M") && attributes["M"].toInt() != classNames.size())
+    {
+        ok = false;
+        *errorString += "Model is inconsistent: M was set to " + QString::number(attributes["M"].toInt()) + " outputs, but " + QString::number(classNames.size()) + " class names were provided!\n";
+    }
+    M = classNames.size();
+
+    windowLength = attributes["window_length"].toInt(1);
+    windowStride = attributes["window_stride"].toInt(1);
+    windowSlopes = attributes["window_slopes"].toBool(false);
+    if (windowLength < 1 || windowStride < 1)
+    {
+        ok = false;
+        *errorString += "Model is inconsistent: window length " + QString::number(windowLength) + " and window stride " + QString::number(windowStride) + " have to be positive!\n";
+        windowLength = 1;
+        windowStride = 1;
+    }
+    inputWidth = FuncWindowBuffer::inputWidth(N, windowLength, windowSlopes);
+
+    inputFunctionType = inputFunctionFromString(attributes["input_function"].toString(), inputFunctionType);
+    outputFunctionType = outputFunctionFromString(attributes["output_function"].toString(), outputFunctionType);
+    isMultiLabel = attributes["is_multi_label"].toBool(isMultiLabel);
+    threshold = attributes["threshold"].toDouble(threshold);
+    isInputAbsolute = attributes["isInputAbsolute"].toBool(isInputAbsolute);
+    presetName = attributes["preset_name"].toString(presetName);
+
+    // normalisation values
+    std::vector<double> mean, stdev;
+    for (const QJsonValue &value : attributes["mean"].toArray())
+        mean.push_back(value.toDouble());
+    for (const QJsonValue &value : attributes["variance"].toArray())
+        stdev.push_back(std::sqrt(value.toDouble()));
+
+    if (!mean.empty() && mean.size() != N && mean.size() != inputWidth)
+    {
+        ok = false;
+        *errorString += "Model is inconsistent: Mean vector size is " + QString::number(mean.size()) + " , input size N is " + QString::number(N) + "!\n";
+        mean.clear();
+    }
+    if (!stdev.empty() && stdev.size() != N && stdev.size() != inputWidth)
+    {
+        ok = false;
+        *errorString += "Model is inconsistent: Variance vector size is " + QString::number(stdev.size()) + " , input size N is " + QString::number(N) + "!\n";
+        stdev.clear();
+    }
+
+    computeNormalisation(mean, stdev, N, windowLength, inputWidth, shift, scale);
+
+    return ok;
+}
+
+/*!
+ * \brief MlpClassifier::readLayers reads the dense layers from \a stream and packs them for the kernels.
+ * The layers have to chain from inputWidth inputs to M outputs.
+ */
+bool MlpClassifier::readLayers(QDataStream &stream, QString *errorString)
+{
+    quint32 nLayers = 0;
+    stream >> nLayers;
+    if (stream.status() != QDataStream::Ok || nLayers == 0)
+    {
+        *errorString += "Model contains no layers.\n";
+        return false;
+    }
+
+    int previousOutputs = inputWidth;
+    bufferWidth = padded(inputWidth);
+
+    for (quint32 i=0; i<nLayers; i++)
+    {
+        PackedLayer layer;
+        qint32 nLayerInputs, nLayerOutputs;
+        QByteArray activationName;
+        quint8 hasBias;
+        stream >> nLayerInputs >> nLayerOutputs >> activationName >> layer.negativeSlope >> hasBias;
+
+        if (stream.status() != QDataStream::Ok || nLayerInputs < 1 || nLayerOutputs < 1 || static_cast<qint64>(nLayerInputs) * nLayerOutputs > (1 << 26))
+        {
+            *errorString += "Layer " + QString::number(i) + " of the model is invalid.\n";
+            return false;
+        }
+        if (nLayerInputs != previousOutputs)
+        {
+            *errorString += "Model is inconsistent: layer " + QString::number(i) + " takes " + QString::number(nLayerInputs) + " inputs, but " + QString::number(previousOutputs) + " are provided!\n";
+            return false;
+        }
+        if (!activationFromString(QString::fromLatin1(activationName), &layer.activation))
+        {
+            *errorString += "Activation \"" + QString::fromLatin1(activationName) + "\" of layer " + QString::number(i) + " is not supported.\n";
+            return false;
+        }
+
+        // padding rows & columns stay zero
+        layer.nInputs = nLayerInputs;
+        layer.nOutputs = nLayerOutputs;
+        layer.stride = padded(nLayerInputs);
+        layer.nRows = padded(nLayerOutputs);
+        layer.weights.assign(static_cast<size_t>(layer.nRows) * static_cast<size_t>(layer.stride), 0.0f);
+        layer.bias.assign(static_cast<size_t>(layer.nRows), 0.0f);
+
+        for (int row=0; row<nLayerOutputs; row++)
+        {
+            float *rowWeights = layer.weights.data() + static_cast<size_t>(row) * static_cast<size_t>(layer.stride);
+            for (int k=0; k<nLayerInputs; k++)
+                stream >> rowWeights[k];
+        }
+        if (hasBias)
+            for (int row=0; row<nLayerOutputs; row++)
+                stream >> layer.bias[static_cast<size_t>(row)];
+
+        if (stream.status() != QDataStream::Ok)
+        {
+            *errorString += "Model file is truncated in layer " + QString::number(i) + ".\n";
+            return false;
+        }
+
+        previousOutputs = nLayerOutputs;
+        bufferWidth = qMax(bufferWidth, layer.nRows);
+        layers.push_back(std::move(layer));
+    }
+
+    if (previousOutputs != M)
+    {
+        *errorString += "Model is inconsistent: the last layer has " + QString::number(previousOutputs) + " outputs, but " + QString::number(M) + " class names were provided!\n";
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief MlpClassifier::save writes the model with \a attributes and \a layers to \a filename in the format read by the constructor.
+ * Returns false and sets \a errorString if a layer is inconsistent or the file could not be written.
+ */
+bool MlpClassifier::save(QString filename, const QJsonObject &attributes, const QList<Layer> &layers, QString *errorString)
+{
+    for (int i=0; i<layers.size(); i++)
+    {
+        const Layer &layer = layers[i];
+        if (layer.weights.size() != static_cast<size_t>(layer.nInputs) * static_cast<size_t>(layer.nOutputs) || (!layer.bias.empty() && layer.bias.size() != static_cast<size_t>(layer.nOutputs)))
+        {
+            *errorString = "Weights of layer " + QString::number(i) + " do not match its size.";
+            return false;
+        }
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        *errorString = "Could not write " + filename + ": " + file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    stream.writeRawData(fileMagic, 4);
+    stream << fileVersion;
+    stream << QJsonDocument(attributes).toJson(QJsonDocument::Compact);
+    stream << static_cast<quint32>(layers.size());
+
+    for (const Layer &layer : layers)
+    {
+        stream << static_cast<qint32>(layer.nInputs) << static_cast<qint32>(layer.nOutputs) << activationToString(layer.activation).toLatin1() << layer.negativeSlope << static_cast<quint8>(!layer.bias.empty());
+
+        for (float weight : layer.weights)
+            stream << weight;
+        for (float bias : layer.bias)
+            stream << bias;
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        *errorString = "Could not write " + filename + ": " + file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QString MlpClassifier::activationToString(MlpClassifier::Activation activation)
+{
+    switch (activation)
+    {
+    case Activation::ReLU:
+        return "relu";
+    case Activation::LeakyReLU:
+        return "leaky_relu";
+    case Activation::Sigmoid:
+        return "sigmoid";
+    case Activation::Tanh:
+        return "tanh";
+    case Activation::Softmax:
+        return "softmax";
+    case Activation::LogSoftmax:
+        return "log_softmax";
+    default:
+        return "none";
+    }
+}
+
+/*!
+ * \brief MlpClassifier::activationFromString sets \a activation to the activation named \a activationString. Returns false if the name is unknown.
+ */
+bool MlpClassifier::activationFromString(QString activationString, MlpClassifier::Activation *activation)
+{
+    static const QList<Activation> activations{Activation::None, Activation::ReLU, Activation::LeakyReLU, Activation::Sigmoid, Activation::Tanh, Activation::Softmax, Activation::LogSoftmax};
+
+    for (Activation candidate : activations)
+        if (activationToString(candidate) == activationString)
+        {
+            *activation = candidate;
+            return true;
+        }
+    return false;
+}
+
+/*!
+ * \brief MlpClassifier::warmUp classifies a zero vector \a nRuns times, so the activation buffers of the loading thread are allocated before the first live prediction.
+ */
+void MlpClassifier::warmUp(int nRuns)
+{
+    std::vector<double> zeroInput(static_cast<size_t>(inputWidth), 0.0);
+    for (int i=0; i<nRuns; i++)
+        classify(zeroInput);
+}
+
+/*!
+ * \brief MlpClassifier::getAnnotation classifies \a input. Inputs found in the cache are not classified again, unless \a useCache is false.
+ * Throws std::invalid_argument if the input has the wrong size.
+ */
+Annotation MlpClassifier::getAnnotation(const std::vector<double> &input, bool useCache)
+{
+    if (input.size() != inputWidth)
+        throw std::invalid_argument("Input vector has wrong size.");
+
+    ClassificationCache *inputCache = useCache ? cache : nullptr;
+
+    Annotation annotation;
+    if (inputCache != nullptr && inputCache->find(modelKey, input, annotation))
+        return annotation;
+
+    annotation = classify(input);
+
+    if (inputCache != nullptr)
+        inputCache->insert(modelKey, input, annotation);
+
+    return annotation;
+}
+
+Annotation MlpClassifier::classify(const std::vector<double> &input)
+{
+    normalise(input.data(), activationBuffer(0, static_cast<size_t>(bufferWidth)));
+
+    return decodeAnnotation(forward(1), classNames, isMultiLabel, threshold, isRegression);
+}
+
+/*!
+ * \brief MlpClassifier::getAnnotations classifies all \a inputs. Inputs found in the cache are taken from it if \a useCache is set,
+ * the remaining rows are classified in chunks of up to \a batchSize rows, so each block of weights is loaded once per chunk.
+ * Throws std::invalid_argument if an input has the wrong size.
+ */
+QList<Annotation> MlpClassifier::getAnnotations(const std::vector<std::vector<double>> &inputs, int batchSize, bool useCache)
+{
+    Q_ASSERT("Invalid batch size!" && batchSize > 0);
+
+    ClassificationCache *inputCache = useCache ? cache : nullptr;
+
+    QVector<Annotation> annotations(static_cast<int>(inputs.size()));
+
+    // look up cached inputs
+    std::vector<size_t> missing;
+    missing.reserve(inputs.size());
+    for (size_t i=0; i<inputs.size(); i++)
+    {
+        if (inputs[i].size() != inputWidth)
+            throw std::invalid_argument("Input vector has wrong size.");
+
+        if (inputCache == nullptr || !inputCache->find(modelKey, inputs[i], annotations[static_cast<int>(i)]))
+            missing.push_back(i);
+    }
+
+    for (size_t start=0; start<missing.size(); start+=static_cast<size_t>(batchSize))
+    {
+        int nRows = static_cast<int>(qMin(missing.size() - start, static_cast<size_t>(batchSize)));
+        float *inputData = activationBuffer(0, static_cast<size_t>(nRows) * static_cast<size_t>(bufferWidth));
+
+        for (int row=0; row<nRows; row++)
+            normalise(inputs[missing[start + row]].data(), inputData + static_cast<size_t>(row) * static_cast<size_t>(bufferWidth));
+
+        const float *probabilities = forward(nRows);
+
+        for (int row=0; row<nRows; row++)
+        {
+            size_t index = missing[start + row];
+            annotations[static_cast<int>(index)] = decodeAnnotation(probabilities + static_cast<size_t>(row) * static_cast<size_t>(bufferWidth), classNames, isMultiLabel, threshold, isRegression);
+
+            if (inputCache != nullptr)
+                inputCache->insert(modelKey, inputs[index], annotations[static_cast<int>(index)]);
+        }
+    }
+
+    return annotations.toList();
+}
+
+/*!
+ * \brief MlpClassifier::forward runs the layers on the \a nRows normalised input rows in the first activation buffer of the calling thread
+ * and returns the class probabilities, one row of bufferWidth values per input.
+ */
+const float *MlpClassifier::forward(int nRows) const
+{
+    size_t bufferSize = static_cast<size_t>(nRows) * static_cast<size_t>(bufferWidth);
+    float *input = activationBuffer(0, bufferSize);
+    float *output = activationBuffer(1, bufferSize);
+
+    for (const PackedLayer &layer : layers)
+    {
+        denseLayer(layer, input, nRows, bufferWidth, output);
+        activate(layer, nRows, bufferWidth, output);
+        std::swap(input, output);
+    }
+
+    for (int row=0; row<nRows; row++)
+        applyOutputFunction(input + static_cast<size_t>(row) * static_cast<size_t>(bufferWidth));
+
+    return input;
+}
+
+/*!
+ * \brief MlpClassifier::denseLayer computes W x + b of \a layer for \a nRows input rows, \a rowStride floats apart in \a input and \a output.
+ * The output neurons are processed in blocks whose weights fit into the L2 cache: each block is applied to all rows before the next one is loaded,
+ * so the weights are read from memory once per batch instead of once per row.
+ */
+void MlpClassifier::denseLayer(const MlpClassifier::PackedLayer &layer, const float *input, int nRows, int rowStride, float *output)
+{
+    size_t rowBytes = static_cast<size_t>(layer.stride) * sizeof(float);
+    int blockRows = qMax(kRowTile, static_cast<int>(kBlockBytes / rowBytes) / kRowTile * kRowTile);
+
+    for (int blockStart=0; blockStart<layer.nRows; blockStart+=blockRows)
+    {
+        int blockEnd = qMin(blockStart + blockRows, layer.nRows);
+
+        for (int row=0; row<nRows; row++)
+        {
+            const float *x = input + static_cast<size_t>(row) * static_cast<size_t>(rowStride);
+            float *y = output + static_cast<size_t>(row) * static_cast<size_t>(rowStride);
+
+            for (int o=blockStart; o<blockEnd; o+=kRowTile)
+                dot4(layer.weights.data() + static_cast<size_t>(o) * static_cast<size_t>(layer.stride), layer.stride, x, layer.bias.data() + o, y + o);
+        }
+    }
+}
+
+/*!
+ * \brief MlpClassifier::activate applies the activation of \a layer to its outputs. The padding outputs stay zero.
+ */
+void MlpClassifier::activate(const MlpClassifier::PackedLayer &layer, int nRows, int rowStride, float *output)
+{
+    int n = layer.nOutputs;
+
+    for (int row=0; row<nRows; row++)
+    {
+        float *y = output + static_cast<size_t>(row) * static_cast<size_t>(rowStride);
+
+        switch (layer.activation)
+        {
+        case Activation::ReLU:
+            for (int i=0; i<n; i++)
+                y[i] = y[i] > 0.0f ? y[i] : 0.0f;
+            break;
+        case Activation::LeakyReLU:
+            for (int i=0; i<n; i++)
+                y[i] = y[i] > 0.0f ? y[i] : layer.negativeSlope * y[i];
+            break;
+        case Activation::Sigmoid:
+            sigmoid(y, n);
+            break;
+        case Activation::Tanh:
+            for (int i=0; i<n; i++)
+                y[i] = std::tanh(y[i]);
+            break;
+        case Activation::Softmax:
+            softmax(y, n, false);
+            break;
+        case Activation::LogSoftmax:
+            softmax(y, n, true);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/*!
+ * \brief MlpClassifier::applyOutputFunction turns the M outputs of the model in \a output into class probabilities, as TorchClassifier does.
+ */
+void MlpClassifier::applyOutputFunction(float *output) const
+{
+    if (outputFunctionType == OutputFunctionType::logsoftmax)
+        softmax(output, M, false);
+    else if (outputFunctionType == OutputFunctionType::sigmoid)
+        sigmoid(output, M);
+}
+
+/*!
+ * \brief MlpClassifier::normalise normalises the inputWidth values of \a input, converts them to float and zeroes the padding of the row in \a output.
+ */
+void MlpClassifier::normalise(const double *input, float *output) const
+{
+    const double *shiftData = shift.data();
+    const double *scaleData = scale.data();
+
+    // shift in double: rounding the raw values to float first would lose the digits the shift leaves
+    for (int i=0; i<inputWidth; i++)
+        output[i] = static_cast<float>((input[i] - shiftData[i]) * scaleData[i]);
+
+    std::fill(output + inputWidth, output + padded(inputWidth), 0.0f);
+}
+
+QString MlpClassifier::getName() const
+{
+    return name;
+}
+
+QString MlpClassifier::getFilename() const
+{
+    return filename;
+}
+
+bool MlpClassifier::getIsInputAbsolute() const
+{
+    return isInputAbsolute;
+}
+
+QStringList MlpClassifier::getClassNames() const
+{
+    return classNames;
+}
+
+int MlpClassifier::getN() const
+{
+    return N;
+}
+
+int MlpClassifier::getInputWidth() const
+{
+    return inputWidth;
+}
+
+int MlpClassifier::getWindowLength() const
+{
+    return windowLength;
+}
+
+int MlpClassifier::getWindowStride() const
+{
+    return windowStride;
+}
+
+bool MlpClassifier::getWindowSlopes() const
+{
+    return windowSlopes;
+}
+
+int MlpClassifier::getM() const
+{
+    return M;
+}
+
+QString MlpClassifier::getPresetName() const
+{
+    return presetName;
+}
+
+InputFunctionType MlpClassifier::getInputFunctionType() const
+{
+    return inputFunctionType;
+}
+
+bool MlpClassifier::getIsMultiLabel() const
+{
+    return isMultiLabel;
+}
+
+double MlpClassifier::getThreshold() const
+{
+    return threshold;
+}
+
+double MlpClassifier::getLoadTime() const
+{
+    return loadTime;
+}
+
+/*!
+ * \brief MlpClassifier::getNParameters returns the number of weights and biases of the model, without padding.
+ */
+int MlpClassifier::getNParameters() const
+{
+    int nParameters = 0;
+    for (const PackedLayer &layer : layers)
+        nParameters += layer.nInputs * layer.nOutputs + layer.nOutputs;
+    return nParameters;
+}
+
+QByteArray MlpClassifier::getModelKey() const
+{
+    return modelKey;
+}
+
+/*!
+ * \brief MlpClassifier::setCache sets the \a cache used by getAnnotation and getAnnotations. The cache is not owned by the classifier,
+ * nullptr disables caching.
+ */
+void MlpClassifier::setCache(ClassificationCache *value)
+{
+    cache = value;
+}
@@ -0,0 +1,132 @@
+#ifndef MLPCLASSIFIER_H
+#define MLPCLASSIFIER_H
+
+#include <QObject>
+#include <QtCore>
+
+#include <vector>
+
+#include "classifier.h"
+
+class MlpClassifier : public Classifier
+{
+    Q_OBJECT
+
+public:
+    enum class Activation {None, ReLU, LeakyReLU, Sigmoid, Tanh, Softmax, LogSoftmax};
+
+    /*!
+     * \brief The Layer struct is a dense layer y = activation(W x + b) with the weights W stored row-major, one row per output.
+     */
+    struct Layer{
+        int nInputs = 0;
+        int nOutputs = 0;
+        Activation activation = Activation::None;
+        float negativeSlope = 0.01f;        // of LeakyReLU
+        std::vector<float> weights;         // nOutputs x nInputs
+        std::vector<float> bias;            // nOutputs, empty: no bias
+    };
+
+    explicit MlpClassifier(QObject *parent, QString filename, bool* loadOk, QString *errorString, int nInputs, Settings settings = Settings());
+
+    static bool save(QString filename, const QJsonObject &attributes, const QList<Layer> &layers, QString *errorString);
+
+    static QString activationToString(Activation activation);
+    static bool activationFromString(QString activationString, Activation *activation);
+
+    Annotation getAnnotation (const std::vector<double> &input, bool useCache = true) override;
+
+    QList<Annotation> getAnnotations (const std::vector<std::vector<double>> &inputs, int batchSize, bool useCache = true) override;
+
+    QString getName() const override;
+
+    QString getFilename() const;
+
+    bool getIsInputAbsolute() const override;
+
+    QStringList getClassNames() const override;
+
+    int getN() const override;
+
+    int getInputWidth() const override;
+
+    int getWindowLength() const override;
+
+    int getWindowStride() const override;
+
+    bool getWindowSlopes() const override;
+
+    int getM() const;
+
+    QString getPresetName() const override;
+
+    InputFunctionType getInputFunctionType() const override;
+
+    bool getIsMultiLabel() const override;
+
+    double getThreshold() const override;
+
+    double getLoadTime() const;
+
+    int getNParameters() const;
+
+    QByteArray getModelKey() const;
+
+    void setCache(ClassificationCache *value) override;
+
+private:
+    /*!
+     * \brief The PackedLayer struct holds the weights of a layer padded for the matrix-vector kernels:
+     * rows and row length are rounded up to multiples of the SIMD width and the padding is zero.
+     */
+    struct PackedLayer{
+        int nInputs = 0;
+        int nOutputs = 0;
+        int nRows = 0;                      // padded nOutputs
+        int stride = 0;                     // padded nInputs
+        Activation activation = Activation::None;
+        float negativeSlope = 0.01f;
+        std::vector<float> weights;         // nRows x stride
+        std::vector<float> bias;            // nRows
+    };
+
+    std::vector<PackedLayer> layers;
+    int bufferWidth = 0;                    // padded width of the widest layer
+
+    // meta info
+    bool isInputAbsolute = false;
+    QStringList classNames{};
+    QString name;
+    QString filename;
+    QString presetName = "None";
+    QByteArray modelKey;                    // identifies the model in the classification cache
+    ClassificationCache *cache = nullptr;
+    int N, M;
+    int windowLength = 1;                   // func vectors per input
+    int windowStride = 1;                   // func vectors between inputs classified
+    bool windowSlopes = false;              // slopes of the window appended to the input
+    int inputWidth = 0;
+    std::vector<double> shift, scale;       // precomputed normalisation: (x - shift) * scale, in double: the mean is close to the raw values
+
+    double loadTime = 0.0;                  // in ms
+
+    InputFunctionType inputFunctionType = InputFunctionType::average;
+    OutputFunctionType outputFunctionType = OutputFunctionType::logsoftmax;
+    bool isMultiLabel = false;
+    bool isRegression = false;
+    double threshold = 0.3;
+
+    bool readAttributes(const QJsonObject &attributes, int nInputs, QString *errorString);
+    bool readLayers(QDataStream &stream, QString *errorString);
+    void warmUp(int nRuns);
+
+    Annotation classify (const std::vector<double> &input);
+    const float *forward(int nRows) const;
+    void normalise(const double *input, float *output) const;
+    void applyOutputFunction(float *output) const;
+
+    static void denseLayer(const PackedLayer &layer, const float *input, int nRows, int rowStride, float *output);
+    static void activate(const PackedLayer &layer, int nRows, int rowStride, float *output);
+};
+
+#endif // MLPCLASSIFIER_H
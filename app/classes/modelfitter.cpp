@@ -0,0 +1,162 @@
+#include "modelfitter.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FIT_KERNEL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FIT_KERNEL_SSE2
+#endif
+
+namespace {
+
+// exp(x) = 2^k * exp(r), k = round(x / ln 2), r = x - k * ln 2 in [-ln 2 / 2, ln 2 / 2]
+// ln 2 is split in a part exact in few bits and a remainder, so k * ln2Hi is exact
+const double kLog2e = 1.4426950408889634074;
+const double kLn2Hi = 6.93145751953125e-1;
+const double kLn2Lo = 1.42860682030941723212e-6;
+// inputs are clamped, so 2^k stays a normal double; NaN is returned unchanged
+const double kExpMin = -708.0;
+const double kExpMax = 709.0;
+// Taylor coefficients 1/i! of exp(r), i = 12..0: truncation error below 2e-16 for |r| <= ln 2 / 2
+const double kExpCoefficients[13] = {
+    2.08767569878680989792e-9, 2.50521083854417187751e-8, 2.75573192239858906526e-7, 2.75573192239858906526e-6,
+    2.48015873015873015873e-5, 1.98412698412698412698e-4, 1.38888888888888888889e-3, 8.33333333333333333333e-3,
+    4.16666666666666666667e-2, 1.66666666666666666667e-1, 5.0e-1, 1.0, 1.0
+};
+
+inline double scalarExp(double x)
+{
+    // NaN passes the clamp and would be converted to an integer below
+    if (std::isnan(x))
+        return x;
+
+    x = std::min(std::max(x, kExpMin), kExpMax);
+    double k = std::floor(x * kLog2e + 0.5);
+    double r = (x - k * kLn2Hi) - k * kLn2Lo;
+
+    double p = kExpCoefficients[0];
+    for (int i=1; i<13; i++)
+        p = p * r + kExpCoefficients[i];
+
+    uint64_t bits = static_cast<uint64_t>(static_cast<int64_t>(k) + 1023) << 52;
+    double scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+}
+
+/*!
+ * \brief vectorExp writes exp(x[i]) to \a result[i] for the \a n values of \a x. \a result may be \a x.
+ * Inputs are clamped to [-708, 709], NaN is propagated, so that the caller can reject the result. The relative error is a few ulp. The values are computed in SIMD registers:
+ * 4 at once with AVX2 ("qmake CONFIG+=mlp_avx2"), 2 with SSE2, the remainder and other architectures one by one.
+ */
+void vectorExp(const double *x, double *result, size_t n)
+{
+    size_t i = 0;
+
+#if defined(FIT_KERNEL_AVX2)
+    const __m256d log2e = _mm256_set1_pd(kLog2e), ln2Hi = _mm256_set1_pd(kLn2Hi), ln2Lo = _mm256_set1_pd(kLn2Lo);
+    const __m256d expMin = _mm256_set1_pd(kExpMin), expMax = _mm256_set1_pd(kExpMax), half = _mm256_set1_pd(0.5);
+    for (; i+4<=n; i+=4)
+    {
+        // max/min return the clamp bound for NaN, which is restored by the blend below
+        __m256d input = _mm256_loadu_pd(x + i);
+        __m256d nan = _mm256_cmp_pd(input, input, _CMP_UNORD_Q);
+        __m256d v = _mm256_min_pd(_mm256_max_pd(input, expMin), expMax);
+        __m256d k = _mm256_floor_pd(_mm256_add_pd(_mm256_mul_pd(v, log2e), half));
+        __m256d r = _mm256_sub_pd(_mm256_sub_pd(v, _mm256_mul_pd(k, ln2Hi)), _mm256_mul_pd(k, ln2Lo));
+
+        __m256d p = _mm256_set1_pd(kExpCoefficients[0]);
+        for (int c=1; c<13; c++)
+            p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(kExpCoefficients[c]));
+
+        // 2^k: biased exponent k + 1023 shifted into the exponent bits
+        __m128i exponent = _mm_add_epi32(_mm256_cvtpd_epi32(k), _mm_set1_epi32(1023));
+        __m256d scale = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_cvtepu32_epi64(exponent), 52));
+        _mm256_storeu_pd(result + i, _mm256_blendv_pd(_mm256_mul_pd(p, scale), input, nan));
+    }
+#elif defined(FIT_KERNEL_SSE2)
+    const __m128d log2e = _mm_set1_pd(kLog2e), ln2Hi = _mm_set1_pd(kLn2Hi), ln2Lo = _mm_set1_pd(kLn2Lo);
+    const __m128d expMin = _mm_set1_pd(kExpMin), expMax = _mm_set1_pd(kExpMax), half = _mm_set1_pd(0.5), one = _mm_set1_pd(1.0);
+    for (; i+2<=n; i+=2)
+    {
+        // max/min return the clamp bound for NaN, which is restored by the select below
+        __m128d input = _mm_loadu_pd(x + i);
+        __m128d nan = _mm_cmpunord_pd(input, input);
+        __m128d v = _mm_min_pd(_mm_max_pd(input, expMin), expMax);
+        // floor without SSE4.1: truncate, subtract 1 where the truncation rounded up
+        __m128d f = _mm_add_pd(_mm_mul_pd(v, log2e), half);
+        __m128i truncated = _mm_cvttpd_epi32(f);
+        __m128d k = _mm_cvtepi32_pd(truncated);
+        __m128d roundedUp = _mm_and_pd(_mm_cmpgt_pd(k, f), one);
+        k = _mm_sub_pd(k, roundedUp);
+        __m128d r = _mm_sub_pd(_mm_sub_pd(v, _mm_mul_pd(k, ln2Hi)), _mm_mul_pd(k, ln2Lo));
+
+        __m128d p = _mm_set1_pd(kExpCoefficients[0]);
+        for (int c=1; c<13; c++)
+            p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(kExpCoefficients[c]));
+
+        // 2^k: biased exponent k + 1023 (positive, so it can be zero extended) shifted into the exponent bits
+        __m128i exponent = _mm_add_epi32(_mm_cvttpd_epi32(k), _mm_set1_epi32(1023));
+        __m128d scale = _mm_castsi128_pd(_mm_slli_epi64(_mm_unpacklo_epi32(exponent, _mm_setzero_si128()), 52));
+        __m128d value = _mm_mul_pd(p, scale);
+        _mm_storeu_pd(result + i, _mm_or_pd(_mm_andnot_pd(nan, value), _mm_and_pd(nan, input)));
+    }
+#endif
+
+    for (; i<n; i++)
+        result[i] = scalarExp(x[i]);
+}
+
+/*!
+ * \brief ADGModel::evaluate writes the model values of the \a n samples \a t to \a values and, if \a jacobian is not null, the derivatives by the parameters.
+ * \a buffer holds 2 * \a n doubles: the exponentials of both terms.
+ */
+void ADGModel::evaluate(const double *t, size_t n, const double *parameters, double *values, double *jacobian, double *buffer)
+{
+    const double alpha_1 = parameters[0];
+    const double beta_1 = parameters[1];
+    const double t0_1 = parameters[2];
+    const double alpha_2 = parameters[3];
+    const double beta_2 = parameters[4];
+    const double t0_2 = parameters[5];
+
+    double *e1 = buffer;
+    double *e2 = buffer + n;
+
+    for (size_t i=0; i<n; i++)
+    {
+        e1[i] = -beta_1 * (t[i] - t0_1);
+        e2[i] = -beta_2 * (t[i] - t0_2);
+    }
+    vectorExp(e1, e1, n);
+    vectorExp(e2, e2, n);
+
+    for (size_t i=0; i<n; i++)
+        values[i] = alpha_1 * (1 - e1[i]) + alpha_2 * (1 - e2[i]);
+
+    if (jacobian == nullptr)
+        return;
+
+    double *dAlpha_1 = jacobian;
+    double *dBeta_1 = jacobian + n;
+    double *dT0_1 = jacobian + 2 * n;
+    double *dAlpha_2 = jacobian + 3 * n;
+    double *dBeta_2 = jacobian + 4 * n;
+    double *dT0_2 = jacobian + 5 * n;
+
+    for (size_t i=0; i<n; i++)
+    {
+        dAlpha_1[i] = 1 - e1[i];
+        dBeta_1[i] = alpha_1 * (t[i] - t0_1) * e1[i];
+        dT0_1[i] = -alpha_1 * beta_1 * e1[i];
+        dAlpha_2[i] = 1 - e2[i];
+        dBeta_2[i] = alpha_2 * (t[i] - t0_2) * e2[i];
+        dT0_2[i] = -alpha_2 * beta_2 * e2[i];
+    }
+}
@@ -0,0 +1,221 @@
+#ifndef MODELFITTER_H
+#define MODELFITTER_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+void vectorExp(const double *x, double *result, size_t n);
+
+/*!
+ * \brief The ADGModel struct is the superposition of two asymptotic regression models fitted by ADG_superpos_Fitter
+ * f: alpha1 * (1 - e^(-beta1 * (t - t01)) + alpha2 * (1 - e^(-beta2 * (t - t02))
+ * parameters: alpha_1, beta_1, t0_1, alpha_2, beta_2, t0_2
+ */
+struct ADGModel
+{
+    static const int nParameters = 6;
+    static const int nBuffers = 2;      // doubles per sample needed by evaluate
+
+    static void evaluate(const double *t, size_t n, const double *parameters, double *values, double *jacobian, double *buffer);
+};
+
+/*!
+ * \brief The ModelFitter class fits a Model to samples (t, y) by damped Gauss-Newton steps with fixed-size normal equations.
+ * Model is a compile-time parameter providing
+ * - nParameters: number of parameters
+ * - nBuffers: number of doubles per sample needed as temporary buffer
+ * - evaluate(t, n, parameters, values, jacobian, buffer): the model values of all samples and,
+ *   if jacobian is not null, the derivatives by parameter: jacobian[k*n + i] = d f(t_i) / d parameter_k
+ * The samples are evaluated in one loop per term, so the model is not called per sample and the exponentials are computed by vectorExp.
+ * Not thread safe: each thread needs its own ModelFitter, the samples can be shared.
+ */
+template<class Model>
+class ModelFitter
+{
+public:
+    static const int nParameters = Model::nParameters;
+    typedef std::array<double, Model::nParameters> Parameters;
+
+    // damping of the Gauss-Newton steps
+    enum class Damping {
+        Marquardt,      // scaled by the diagonal of the normal equations, invariant to the parameter scales
+        Levenberg       // identity, gradient descent for large damping
+    };
+
+    ModelFitter(const double *t, const double *y, size_t n):
+        t(t),
+        y(y),
+        n(n),
+        values(n),
+        jacobian(n * nParameters),
+        buffer(n * Model::nBuffers)
+    {}
+
+    /*!
+     * \brief ModelFitter::sumOfSquares returns the residual sum of squares of \a parameters.
+     */
+    double sumOfSquares(const Parameters &parameters)
+    {
+        Model::evaluate(t, n, parameters.data(), values.data(), nullptr, buffer.data());
+
+        double sum = 0.;
+        for (size_t i=0; i<n; i++)
+        {
+            double residual = values[i] - y[i];
+            sum += residual * residual;
+        }
+        return sum;
+    }
+
+    /*!
+     * \brief ModelFitter::solve improves \a parameters until the objective 0.5 * sum of squares changes less than \a minDelta in a step
+     * or after \a maxIterations steps. Returns the residual sum of squares of the result, the number of steps taken is returned by getNIterations().
+     */
+    double solve(Parameters &parameters, Damping damping, int maxIterations, double minDelta)
+    {
+        nIterations = 0;
+        double error = evaluate(parameters, true);
+        if (!std::isfinite(error))
+            return error;
+
+        double lambda = 1e-3;
+        for (int iteration=0; iteration<maxIterations; iteration++)
+        {
+            // normal equations: J^T J delta = -J^T r
+            double normal[nParameters][nParameters];
+            double gradient[nParameters];
+            for (int a=0; a<nParameters; a++)
+            {
+                const double *ja = jacobian.data() + a * n;
+                double g = 0.;
+                for (size_t i=0; i<n; i++)
+                    g += ja[i] * values[i];
+                gradient[a] = g;
+
+                for (int b=0; b<=a; b++)
+                {
+                    const double *jb = jacobian.data() + b * n;
+                    double sum = 0.;
+                    for (size_t i=0; i<n; i++)
+                        sum += ja[i] * jb[i];
+                    normal[a][b] = normal[b][a] = sum;
+                }
+            }
+
+            // increase damping until a step decreases the error
+            Parameters step;
+            double stepError = std::numeric_limits<double>::infinity();
+            while (lambda < 1e16)
+            {
+                double damped[nParameters][nParameters];
+                double delta[nParameters];
+                for (int a=0; a<nParameters; a++)
+                {
+                    for (int b=0; b<nParameters; b++)
+                        damped[a][b] = normal[a][b];
+                    damped[a][a] += lambda * (damping == Damping::Marquardt ? std::max(normal[a][a], 1e-12) : 1.);
+                    delta[a] = -gradient[a];
+                }
+
+                if (choleskySolve(damped, delta))
+                {
+                    for (int a=0; a<nParameters; a++)
+                        step[a] = parameters[a] + delta[a];
+                    stepError = sumOfSquares(step);
+                    if (stepError < error)
+                        break;
+                }
+                lambda *= 10.;
+            }
+
+            // no decrease: minimum reached
+            if (!(stepError < error))
+                break;
+
+            double objectiveDelta = 0.5 * (error - stepError);
+            parameters = step;
+            nIterations++;
+            lambda = std::max(lambda / 10., 1e-12);
+            error = evaluate(parameters, true);
+
+            if (objectiveDelta < minDelta)
+                break;
+        }
+        return error;
+    }
+
+    int getNIterations() const
+    {
+        return nIterations;
+    }
+
+private:
+    const double *t, *y;
+    size_t n;
+    int nIterations = 0;
+
+    std::vector<double> values;         // model values, residuals after evaluate()
+    std::vector<double> jacobian;       // nParameters rows of n derivatives
+    std::vector<double> buffer;
+
+    double evaluate(const Parameters &parameters, bool withJacobian)
+    {
+        Model::evaluate(t, n, parameters.data(), values.data(), withJacobian ? jacobian.data() : nullptr, buffer.data());
+
+        double sum = 0.;
+        for (size_t i=0; i<n; i++)
+        {
+            values[i] -= y[i];
+            sum += values[i] * values[i];
+        }
+        return sum;
+    }
+
+    /*!
+     * \brief ModelFitter::choleskySolve solves \a matrix x = \a vector for the symmetric positive definite \a matrix in place, x is returned in \a vector.
+     * Returns false if \a matrix is not positive definite.
+     */
+    static bool choleskySolve(double (&matrix)[nParameters][nParameters], double (&vector)[nParameters])
+    {
+        // matrix = L L^T, L is stored in the lower triangle
+        for (int j=0; j<nParameters; j++)
+        {
+            double diagonal = matrix[j][j];
+            for (int k=0; k<j; k++)
+                diagonal -= matrix[j][k] * matrix[j][k];
+            if (!(diagonal > 0.))
+                return false;
+            matrix[j][j] = std::sqrt(diagonal);
+
+            for (int i=j+1; i<nParameters; i++)
+            {
+                double value = matrix[i][j];
+                for (int k=0; k<j; k++)
+                    value -= matrix[i][k] * matrix[j][k];
+                matrix[i][j] = value / matrix[j][j];
+            }
+        }
+
+        // forward: L z = vector
+        for (int i=0; i<nParameters; i++)
+        {
+            for (int k=0; k<i; k++)
+                vector[i] -= matrix[i][k] * vector[k];
+            vector[i] /= matrix[i][i];
+        }
+        // backward: L^T x = z
+        for (int i=nParameters-1; i>=0; i--)
+        {
+            for (int k=i+1; k<nParameters; k++)
+                vector[i] -= matrix[k][i] * vector[k];
+            vector[i] /= matrix[i][i];
+        }
+        return true;
+    }
+};
+
+#endif // MODELFITTER_H
@@ -88,7 +88,7 @@ bool MVector::operator!=(const MVector &other) const
 
 MVector MVector::operator*(const double multiplier)
 {
-    MVector vector(baseVector);
+    MVector vector(baseVector, size);
     vector.copyMetaData(*this);
 
     for (int i=0; i<size; i++)
@@ -109,7 +109,7 @@ MVector MVector::operator*(const int multiplier)
 
 MVector MVector::operator/(const double denominator)
 {
-    MVector vector(baseVector);
+    MVector vector(baseVector, size);
     vector.copyMetaData(*this);
 
     for (int i=0; i<size; i++)
@@ -132,7 +132,7 @@ MVector MVector::operator+(const MVector other)
 {
     Q_ASSERT(other.size == this->size);
 
-    MVector vector(baseVector);
+    MVector vector(baseVector, size);
     vector.copyMetaData(*this);
 
     for (int i=0; i<size; i++)
@@ -148,7 +148,7 @@ MVector MVector::operator+(const MVector other)
 
 MVector MVector::operator +(const double value)
 {
-    MVector vector(baseVector);
+    MVector vector(baseVector, size);
     vector.copyMetaData(*this);
 
     for (int i=0; i<size; i++)
@@ -167,7 +167,7 @@ MVector MVector::operator-(const MVector other)
 {
     Q_ASSERT(other.size == this->size);
 
-    MVector vector(baseVector);
+    MVector vector(baseVector, size);
     vector.copyMetaData(*this);
 
     for (int i=0; i<size; i++)
@@ -260,7 +260,7 @@ MVector MVector::getFuncAverageVector(const Functionalisation &functionalisation
     funcVector.detectedAnnotation = detectedAnnotation;
 
     // calc averages of functionalisations
-    for (int i=0; i<MVector::nChannels; i++)
+    for (int i=0; i<size; i++)
     {
         if (!sensorFailures[i])
         {
@@ -290,7 +290,7 @@ MVector MVector::getFuncMedianAverageVector(const Functionalisation &functionali
 
     // create list of functionalisation values
     QMap<int, QList<double>> funcValueMap;
-    for (int i=0; i<MVector::nChannels; i++)
+    for (int i=0; i<size; i++)
     {
         if (!sensorFailures[i])
         {
@@ -0,0 +1,305 @@
+#include "replaydatasource.h"
+
+#include "measurementdata.h"
+#include "defaultSettings.h"
+
+/*!
+ * \class ReplayDataSource
+ * \brief Streams a recorded measurement file like a connected sensor.
+ * Vectors are replayed with their original timestamps, sensor attributes and user annotations (e.g. measurement events).
+ * The base vectors of the file are replayed before the first vector they apply to.
+ * Detected annotations are not replayed, so the live classifier can be benchmarked on the data.
+ *
+ * \a speed sets the replay speed relative to real time: 1 replays in real time, 10 ten times as fast.
+ * A speed <= 0 replays as fast as the consumer drains the source buffer.
+ *
+ * The status changes like the ones of USBDataSource: CONNECTING -> CONNECTED after init,
+ * SET_BASEVECTOR -> RECEIVING_DATA after start or reset, PAUSED after pause, CONNECTED after stop or at the end of the file.
+ * Throws std::runtime_error if the file can not be read.
+ */
+ReplayDataSource::ReplayDataSource(QString filename, double speed, int sensorTimeout):
+    DataSource(sensorTimeout, MVector::nChannels),
+    filename(filename),
+    speed(speed)
+{
+    loadFile();
+}
+
+ReplayDataSource::~ReplayDataSource()
+{
+    if (replayTimer != nullptr)
+        replayTimer->deleteLater();
+}
+
+void ReplayDataSource::loadFile()
+{
+    FileReader generalFileReader(filename);
+    FileReader* specificReader = generalFileReader.getSpecificReader();
+    specificReader->readFile();
+
+    MeasurementData* fileData = specificReader->getMeasurementData();
+
+    sensorId = fileData->getSensorId();
+    functionalisation = fileData->getFunctionalisation();
+    nChannels = static_cast<int>(fileData->nChannels());
+    vectors = fileData->getAbsoluteData();
+    baseVectors = fileData->getBaseVectorMap();
+
+    delete specificReader;
+
+    if (vectors.isEmpty())
+        throw std::runtime_error(filename.toStdString() + " contains no measurement data!");
+
+    // base vectors of fileData were deleted with specificReader
+    for (auto &vector : vectors)
+    {
+        vector.setBaseVector(nullptr);
+        vector.detectedAnnotation = Annotation();
+    }
+
+    timestamps = vectors.keys();
+}
+
+DataSource::SourceType ReplayDataSource::sourceType()
+{
+    return SourceType::REPLAY;
+}
+
+QString ReplayDataSource::identifier()
+{
+    return filename;
+}
+
+double ReplayDataSource::getSpeed() const
+{
+    return speed;
+}
+
+QString ReplayDataSource::getSensorId() const
+{
+    return sensorId;
+}
+
+Functionalisation ReplayDataSource::getFunctionalisation() const
+{
+    return functionalisation;
+}
+
+int ReplayDataSource::getNVectors() const
+{
+    return timestamps.size();
+}
+
+void ReplayDataSource::init()
+{
+    replayTimer = new QTimer();
+    replayTimer->setSingleShot(true);
+    connect(replayTimer, &QTimer::timeout, this, &ReplayDataSource::replayNext);
+
+    setStatus(Status::CONNECTING);
+    position = 0;
+    setStatus(Status::CONNECTED);
+}
+
+void ReplayDataSource::start()
+{
+    Q_ASSERT("Replay was already started!" && connectionStatus != Status::RECEIVING_DATA);
+    Q_ASSERT("Replay is not connected!" && connectionStatus != Status::NOT_CONNECTED);
+
+    // start new replay
+    if (status() != Status::PAUSED)
+    {
+        position = 0;
+        lastBaseTimestamp = 0;
+        baseVectorPublished = false;
+        collectBaseVector = baseVectors.isEmpty();
+        baselineEstimator.reset(nChannels);
+        setStatus(Status::SET_BASEVECTOR);
+    }
+    // resume existing replay
+    else
+        setStatus(baseVectorPublished ? Status::RECEIVING_DATA : Status::SET_BASEVECTOR);
+
+    resume();
+}
+
+void ReplayDataSource::pause()
+{
+    Q_ASSERT("Replay is not running!" && connectionStatus == Status::RECEIVING_DATA || connectionStatus == Status::SET_BASEVECTOR);
+
+    replayTimer->stop();
+
+    if (collectBaseVector)
+        baselineEstimator.reset(nChannels);
+
+    setStatus(Status::PAUSED);
+}
+
+void ReplayDataSource::stop()
+{
+    Q_ASSERT("Trying to stop replay that is not running!" && (connectionStatus == Status::RECEIVING_DATA ||  connectionStatus == Status::PAUSED || connectionStatus == Status::SET_BASEVECTOR));
+
+    replayTimer->stop();
+    position = 0;
+    setStatus(Status::CONNECTED);
+}
+
+/*!
+ * \brief ReplayDataSource::reset estimates a new base vector from the next vectors replayed.
+ */
+void ReplayDataSource::reset()
+{
+    Q_ASSERT("Trying to reset base vector of replay that is not running!" && connectionStatus == Status::RECEIVING_DATA || connectionStatus == Status::PAUSED);
+
+    collectBaseVector = true;
+    baselineEstimator.reset(nChannels);
+    setStatus(Status::SET_BASEVECTOR);
+
+    resume();
+}
+
+void ReplayDataSource::reconnect()
+{
+    if (replayTimer != nullptr)
+        replayTimer->stop();
+
+    position = 0;
+    setStatus(Status::CONNECTING);
+    setStatus(Status::CONNECTED);
+}
+
+/*!
+ * \brief ReplayDataSource::replayTime returns the time in ms after the start of the replay at which the vector at \a index is due.
+ */
+qint64 ReplayDataSource::replayTime(int index) const
+{
+    if (speed <= 0)
+        return 0;
+
+    return qRound64((timestamps[index] - timestamps.first()) * 1000.0 / speed);
+}
+
+void ReplayDataSource::resume()
+{
+    if (position >= timestamps.size())
+        position = 0;
+
+    clockOffset = replayTime(position);
+    replayClock.start();
+
+    replayTimer->start(0);
+}
+
+/*!
+ * \brief ReplayDataSource::replayNext replays all vectors due and schedules the next call.
+ * If replaying as fast as possible, at most REPLAY_MAX_BATCH vectors are replayed per call and replaying waits while the source buffer
+ * can not take all readings of the next vector. In real time, vectors not fitting into the buffer are dropped, but base vectors never are:
+ * replaying waits until the buffer can take them.
+ */
+void ReplayDataSource::replayNext()
+{
+    int nReplayed = 0;
+    bool bufferFull = false;
+
+    while (position < timestamps.size())
+    {
+        if (speed > 0 && replayTime(position) > clockOffset + replayClock.elapsed())
+            break;
+
+        // a vector can publish base vectors before it
+        int nBaseVectors = baseVectorsDue(position);
+        size_t nReadings = static_cast<size_t>(nBaseVectors) + (collectBaseVector ? 0 : 1);
+        bufferFull = getBufferSize() + nReadings > getBufferCapacity();
+        if (speed <= 0 && (nReplayed >= REPLAY_MAX_BATCH || bufferFull))
+            break;
+        if (bufferFull && nBaseVectors > 0)
+            break;
+        bufferFull = false;
+
+        replayVector(position);
+        position++;
+        nReplayed++;
+    }
+
+    // end of file: stop measurement
+    if (position >= timestamps.size())
+    {
+        qDebug() << "Replay of" << filename << "finished";
+        position = 0;
+        setStatus(Status::CONNECTED);
+        return;
+    }
+
+    if (bufferFull)
+        replayTimer->start(1);
+    else if (speed > 0)
+        replayTimer->start(static_cast<int>(qMax(Q_INT64_C(0), replayTime(position) - clockOffset - replayClock.elapsed())));
+    else
+        replayTimer->start(0);
+}
+
+/*!
+ * \brief ReplayDataSource::baseVectorsDue returns the maximum number of base vectors replayVector() publishes for the vector at \a index.
+ */
+int ReplayDataSource::baseVectorsDue(int index) const
+{
+    // estimated base vector
+    if (collectBaseVector)
+        return 1;
+
+    uint timestamp = timestamps[index];
+    int n = 0;
+    uint lastTimestamp = lastBaseTimestamp;
+    if (!baseVectorPublished)
+    {
+        n++;
+        lastTimestamp = baseVectors.firstKey();
+    }
+
+    for (auto baseIter = baseVectors.upperBound(lastTimestamp); baseIter != baseVectors.end() && baseIter.key() <= timestamp; ++baseIter)
+        n++;
+
+    return n;
+}
+
+void ReplayDataSource::replayVector(int index)
+{
+    uint timestamp = timestamps[index];
+    const AbsoluteMVector &vector = vectors[timestamp];
+
+    // set base vector from the next vectors
+    if (collectBaseVector)
+    {
+        if (baselineEstimator.isEmpty())
+            lastBaseTimestamp = timestamp;
+
+        if (baselineEstimator.update(vector))
+        {
+            publishBaseVector(lastBaseTimestamp, baselineEstimator.getBaseVector());
+            baseVectorPublished = true;
+            collectBaseVector = false;
+            setStatus(Status::RECEIVING_DATA);
+        }
+        return;
+    }
+
+    // first base vector of file applies to all vectors before it
+    if (!baseVectorPublished)
+    {
+        lastBaseTimestamp = baseVectors.firstKey();
+        publishBaseVector(qMin(lastBaseTimestamp, timestamp), baseVectors.first());
+        baseVectorPublished = true;
+    }
+
+    // replay further base vectors of file
+    for (auto baseIter = baseVectors.upperBound(lastBaseTimestamp); baseIter != baseVectors.end() && baseIter.key() <= timestamp; ++baseIter)
+    {
+        lastBaseTimestamp = baseIter.key();
+        publishBaseVector(lastBaseTimestamp, baseIter.value());
+    }
+
+    if (connectionStatus != Status::RECEIVING_DATA)
+        setStatus(Status::RECEIVING_DATA);
+
+    publishVector(timestamp, vector);
+}
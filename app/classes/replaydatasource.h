@@ -0,0 +1,61 @@
+#ifndef REPLAYDATASOURCE_H
+#define REPLAYDATASOURCE_H
+
+#include <QElapsedTimer>
+
+#include "datasource.h"
+#include "functionalisation.h"
+
+class ReplayDataSource : public DataSource
+{
+public:
+    ReplayDataSource(QString filename, double speed, int sensorTimeout);
+    ~ReplayDataSource();
+
+    SourceType sourceType() override;
+    QString identifier() override;
+
+    double getSpeed() const;
+    QString getSensorId() const;
+    Functionalisation getFunctionalisation() const;
+    int getNVectors() const;
+
+public slots:
+    void init() override;
+    void start() override;
+    void pause() override;
+    void stop() override;
+    void reset() override;
+    void reconnect() override;
+
+private slots:
+    void replayNext();
+
+private:
+    QString filename;
+    double speed;   // <= 0: as fast as possible
+
+    // replayed data
+    QString sensorId;
+    Functionalisation functionalisation;
+    QMap<uint, AbsoluteMVector> vectors;
+    QMap<uint, AbsoluteMVector> baseVectors;
+    QList<uint> timestamps;
+
+    int position = 0;                   // index of next vector in timestamps
+    uint lastBaseTimestamp = 0;
+    bool baseVectorPublished = false;   // true after the first base vector of the current replay was published
+    bool collectBaseVector = false;     // true after reset: the base vector is estimated from the next vectors
+
+    QTimer *replayTimer = nullptr;
+    QElapsedTimer replayClock;
+    qint64 clockOffset = 0;             // replay time in ms when replayClock was started
+
+    void loadFile();
+    void resume();
+    qint64 replayTime(int index) const;
+    int baseVectorsDue(int index) const;
+    void replayVector(int index);
+};
+
+#endif // REPLAYDATASOURCE_H
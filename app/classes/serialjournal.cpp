@@ -0,0 +1,172 @@
+#include "serialjournal.h"
+
+#include <QtEndian>
+#include <QDebug>
+
+#include <stdexcept>
+
+#include "defaultSettings.h"
+
+const QByteArray SerialJournal::magic = "ENJ1";
+
+/*!
+ * \class SerialJournal
+ * \brief Captures the raw bytes received on a serial port to a binary journal file.
+ * Chunks are appended by the reading thread without touching the disk: they are encoded to a memory buffer,
+ * which is written by the journal's own thread at least every SERIAL_JOURNAL_FLUSH_INTERVAL ms.
+ *
+ * File format (little endian):
+ * header: magic "ENJ1", start time of the capture in ms since epoch (qint64)
+ * chunks: receive time in ns since the start of the capture from a monotonic clock (qint64), size (quint32), bytes
+ */
+SerialJournal::SerialJournal(QString filename, QObject *parent):
+    QThread(parent),
+    file(filename)
+{
+}
+
+SerialJournal::~SerialJournal()
+{
+    close();
+}
+
+/*!
+ * \brief SerialJournal::open creates the journal file and starts the writer thread. Throws std::runtime_error if the file can not be created.
+ */
+void SerialJournal::open()
+{
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        throw std::runtime_error("Cannot create serial journal " + file.fileName().toStdString() + ": " + file.errorString().toStdString());
+
+    char startTime[8];
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), startTime);
+    file.write(magic);
+    file.write(startTime, sizeof(startTime));
+
+    closing = false;
+    clock.start();
+    start(QThread::LowPriority);
+}
+
+/*!
+ * \brief SerialJournal::close writes the remaining chunks, stops the writer thread and closes the file.
+ */
+void SerialJournal::close()
+{
+    if (!isRunning())
+        return;
+
+    {
+        QMutexLocker locker(&mutex);
+        closing = true;
+        dataAvailable.wakeOne();
+    }
+    wait();
+}
+
+/*!
+ * \brief SerialJournal::append adds \a chunk with the current time to the journal. Can be called from any thread.
+ */
+void SerialJournal::append(const QByteArray &chunk)
+{
+    if (chunk.isEmpty())
+        return;
+
+    char header[12];
+    qToLittleEndian<qint64>(clock.nsecsElapsed(), header);
+    qToLittleEndian<quint32>(static_cast<quint32>(chunk.size()), header + 8);
+
+    {
+        QMutexLocker locker(&mutex);
+        pendingData.append(header, sizeof(header));
+        pendingData.append(chunk);
+    }
+
+    nChunks++;
+    nBytes += static_cast<quint64>(chunk.size());
+}
+
+QString SerialJournal::getFilename() const
+{
+    return file.fileName();
+}
+
+quint64 SerialJournal::getNChunks() const
+{
+    return nChunks.load();
+}
+
+quint64 SerialJournal::getNBytes() const
+{
+    return nBytes.load();
+}
+
+void SerialJournal::run()
+{
+    QByteArray data;
+
+    forever
+    {
+        bool finished;
+        {
+            QMutexLocker locker(&mutex);
+            if (!closing)
+                dataAvailable.wait(&mutex, SERIAL_JOURNAL_FLUSH_INTERVAL);
+
+            data.swap(pendingData);
+            finished = closing;
+        }
+
+        if (!data.isEmpty())
+        {
+            if (file.write(data) != data.size())
+                qWarning() << "Error writing serial journal " << file.fileName() << ": " << file.errorString();
+            file.flush();
+            data.clear();
+        }
+
+        if (finished)
+            break;
+    }
+
+    file.close();
+}
+
+/*!
+ * \brief SerialJournal::load reads all chunks of the journal \a filename. The start time of the capture is stored in \a startTime if set.
+ * Throws std::runtime_error if the file can not be read or is no serial journal.
+ * A truncated last chunk, e.g. after a crash, is ignored.
+ */
+QList<SerialJournal::Chunk> SerialJournal::load(QString filename, QDateTime *startTime)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        throw std::runtime_error("Cannot open serial journal " + filename.toStdString() + ": " + file.errorString().toStdString());
+
+    QByteArray data = file.readAll();
+    int headerSize = magic.size() + 8;
+    if (data.size() < headerSize || !data.startsWith(magic))
+        throw std::runtime_error(filename.toStdString() + " is no serial journal!");
+
+    if (startTime != nullptr)
+        *startTime = QDateTime::fromMSecsSinceEpoch(qFromLittleEndian<qint64>(data.constData() + magic.size()));
+
+    QList<Chunk> chunks;
+    int pos = headerSize;
+    while (pos + 12 <= data.size())
+    {
+        Chunk chunk;
+        chunk.time = qFromLittleEndian<qint64>(data.constData() + pos);
+        int size = static_cast<int>(qFromLittleEndian<quint32>(data.constData() + pos + 8));
+        pos += 12;
+
+        if (size < 0 || pos + size > data.size())
+            break;
+
+        chunk.data = data.mid(pos, size);
+        pos += size;
+        chunks << chunk;
+    }
+
+    return chunks;
+}
@@ -0,0 +1,54 @@
+#ifndef SERIALJOURNAL_H
+#define SERIALJOURNAL_H
+
+#include <QThread>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QDateTime>
+
+#include <atomic>
+
+class SerialJournal : public QThread
+{
+public:
+    // chunk of bytes received at once
+    struct Chunk{
+        qint64 time;    // ns since the start of the capture
+        QByteArray data;
+    };
+
+    explicit SerialJournal(QString filename, QObject *parent = nullptr);
+    ~SerialJournal();
+
+    void open();
+    void close();
+
+    void append(const QByteArray &chunk);
+
+    QString getFilename() const;
+    quint64 getNChunks() const;
+    quint64 getNBytes() const;
+
+    static QList<Chunk> load(QString filename, QDateTime *startTime = nullptr);
+
+    static const QByteArray magic;
+
+protected:
+    void run() override;
+
+private:
+    QFile file;
+    QElapsedTimer clock;
+
+    QMutex mutex;
+    QWaitCondition dataAvailable;
+    QByteArray pendingData;     // encoded chunks not yet written
+    bool closing = false;
+
+    std::atomic<quint64> nChunks{0};
+    std::atomic<quint64> nBytes{0};
+};
+
+#endif // SERIALJOURNAL_H
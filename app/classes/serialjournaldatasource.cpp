@@ -0,0 +1,171 @@
+#include "serialjournaldatasource.h"
+
+#include "defaultSettings.h"
+
+/*!
+ * \class SerialJournalDataSource
+ * \brief Replays a serial journal captured by USBDataSource through the line processing of USBDataSource.
+ * This allows to profile changes of the parser and the measurement pipeline with real captured streams.
+ *
+ * The chunks are replayed with their original timing multiplied by 1 / \a speed, a \a speed <= 0 replays as fast as the consumer drains the source buffer.
+ * Vectors get the timestamps of their capture, independent of the replay speed.
+ * The GET_INFO request is not sent: the answer of the sensor is part of the captured stream.
+ * Throws std::runtime_error if the journal can not be read.
+ */
+SerialJournalDataSource::SerialJournalDataSource(QString filename, double speed, int sensorTimeout, int sensorNChannels):
+    USBDataSource([filename](){
+        USBDataSource::Settings journalSettings;
+        journalSettings.portName = filename;
+        journalSettings.hasEnvSensors = false;
+        return journalSettings;
+    }(), sensorTimeout, sensorNChannels),
+    speed(speed)
+{
+    chunks = SerialJournal::load(filename, &captureStart);
+
+    if (chunks.isEmpty())
+        throw std::runtime_error(filename.toStdString() + " contains no serial data!");
+}
+
+SerialJournalDataSource::~SerialJournalDataSource()
+{
+    if (replayTimer != nullptr)
+        replayTimer->deleteLater();
+}
+
+/*!
+ * \brief SerialJournalDataSource::status returns the connection status. There is no serial port to be checked.
+ */
+DataSource::Status SerialJournalDataSource::status()
+{
+    return connectionStatus;
+}
+
+DataSource::SourceType SerialJournalDataSource::sourceType()
+{
+    return SourceType::REPLAY;
+}
+
+double SerialJournalDataSource::getSpeed() const
+{
+    return speed;
+}
+
+int SerialJournalDataSource::getNChunks() const
+{
+    return chunks.size();
+}
+
+void SerialJournalDataSource::init()
+{
+    replayTimer = new QTimer();
+    replayTimer->setSingleShot(true);
+    replayTimer->setTimerType(Qt::PreciseTimer);
+    connect(replayTimer, &QTimer::timeout, this, &SerialJournalDataSource::replayNext);
+
+    position = 0;
+    emitData = false;
+    setStatus(Status::CONNECTING);
+    resume();
+}
+
+/*!
+ * \brief SerialJournalDataSource::start starts a measurement. Restarts the replay if the end of the journal was reached.
+ */
+void SerialJournalDataSource::start()
+{
+    if (!replayTimer->isActive())
+    {
+        // the captured stream starts in ASCII mode
+        position = 0;
+        readBuffer.clear();
+        frameDecoder.clear();
+        binaryMode = false;
+        resume();
+    }
+
+    USBDataSource::start();
+}
+
+void SerialJournalDataSource::reconnect()
+{
+    replayTimer->stop();
+
+    position = 0;
+    emitData = false;
+    deviceInfoRequests = 0;
+    readBuffer.clear();
+    frameDecoder.clear();
+    binaryMode = false;
+    setStatus(Status::CONNECTING);
+    resume();
+}
+
+uint SerialJournalDataSource::currentTimestamp()
+{
+    return chunkTimestamp;
+}
+
+/*!
+ * \brief SerialJournalDataSource::replayTime returns the time in ns after the start of the replay at which the chunk at \a index is due.
+ */
+qint64 SerialJournalDataSource::replayTime(int index) const
+{
+    if (speed <= 0)
+        return 0;
+
+    return static_cast<qint64>((chunks[index].time - chunks.first().time) / speed);
+}
+
+void SerialJournalDataSource::resume()
+{
+    clockOffset = replayTime(position);
+    replayClock.start();
+
+    replayTimer->start(0);
+}
+
+/*!
+ * \brief SerialJournalDataSource::replayNext processes all chunks due and schedules the next call.
+ * If replaying as fast as possible, at most SERIAL_JOURNAL_MAX_BATCH chunks are processed per call and replaying waits while the source buffer is full.
+ */
+void SerialJournalDataSource::replayNext()
+{
+    int nReplayed = 0;
+
+    while (position < chunks.size())
+    {
+        if (speed > 0 && replayTime(position) > clockOffset + replayClock.nsecsElapsed())
+            break;
+        if (speed <= 0 && (nReplayed >= SERIAL_JOURNAL_MAX_BATCH || getBufferSize() >= getBufferCapacity()))
+            break;
+
+        const auto &chunk = chunks[position];
+        chunkTimestamp = static_cast<uint>(captureStart.addMSecs(chunk.time / 1000000).toTime_t());
+        processData(chunk.data);
+
+        position++;
+        nReplayed++;
+    }
+
+    // end of journal: stop measurement
+    if (position >= chunks.size())
+    {
+        qDebug() << "Replay of" << identifier() << "finished";
+        timer->stop();
+
+        if (connectionStatus == Status::RECEIVING_DATA || connectionStatus == Status::PAUSED)
+            stop();
+        else if (connectionStatus != Status::CONNECTING)
+        {
+            emitData = false;
+            setStatus(Status::CONNECTED);
+        }
+        return;
+    }
+
+    if (speed > 0)
+        replayTimer->start(static_cast<int>(qMax(Q_INT64_C(0), replayTime(position) - clockOffset - replayClock.nsecsElapsed()) / 1000000));
+    else
+        replayTimer->start(getBufferSize() >= getBufferCapacity() ? 1 : 0);
+}
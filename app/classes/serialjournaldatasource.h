@@ -0,0 +1,49 @@
+#ifndef SERIALJOURNALDATASOURCE_H
+#define SERIALJOURNALDATASOURCE_H
+
+#include <QElapsedTimer>
+
+#include "usbdatasource.h"
+#include "serialjournal.h"
+
+class SerialJournalDataSource : public USBDataSource
+{
+public:
+    SerialJournalDataSource(QString filename, double speed, int sensorTimeout, int sensorNChannels);
+    ~SerialJournalDataSource();
+
+    Status status() override;
+    SourceType sourceType() override;
+
+    double getSpeed() const;
+    int getNChunks() const;
+
+public slots:
+    void init() override;
+    void start() override;
+    void reconnect() override;
+
+protected:
+    uint currentTimestamp() override;
+
+private slots:
+    void replayNext();
+
+private:
+    double speed;   // <= 0: as fast as possible
+
+    QList<SerialJournal::Chunk> chunks;
+    QDateTime captureStart;
+
+    int position = 0;               // index of next chunk
+    uint chunkTimestamp = 0;        // capture time of the chunk processed
+
+    QTimer *replayTimer = nullptr;
+    QElapsedTimer replayClock;
+    qint64 clockOffset = 0;         // capture time in ns when replayClock was started
+
+    void resume();
+    qint64 replayTime(int index) const;
+};
+
+#endif // SERIALJOURNALDATASOURCE_H
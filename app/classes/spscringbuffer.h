@@ -0,0 +1,149 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <vector>
+
+/*!
+ * \class SpscRingBuffer
+ * \brief Lock-free single-producer/single-consumer queue with a fixed capacity.
+ * All slots are allocated on construction, push() and pop() copy into existing slots,
+ * so item types reusing their storage on assignment (e.g. std::vector) do not allocate while running.
+ * push() must only be called by the producer thread, pop() only by the consumer thread.
+ * If the buffer is full, push() drops the item and counts an overrun.
+ */
+template <typename T>
+class SpscRingBuffer
+{
+public:
+    explicit SpscRingBuffer(size_t capacity, const T &prototype = T()):
+        slots(capacity + 1, prototype)  // one slot is kept free to distinguish full from empty
+    {
+        Q_ASSERT(capacity > 0);
+    }
+
+    /*!
+     * \brief push copies \a item into the next free slot. Returns false if the buffer is full.
+     */
+    bool push(const T &item)
+    {
+        const size_t currentTail = tail.load(std::memory_order_relaxed);
+        const size_t nextTail = increment(currentTail);
+
+        if (nextTail == head.load(std::memory_order_acquire))
+        {
+            overrunCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        slots[currentTail] = item;
+        tail.store(nextTail, std::memory_order_release);
+        pushCount.fetch_add(1, std::memory_order_relaxed);
+
+        // update high-water mark
+        size_t fill = sizeFrom(head.load(std::memory_order_acquire), nextTail);
+        size_t prevMark = highWater.load(std::memory_order_relaxed);
+        while (fill > prevMark && !highWater.compare_exchange_weak(prevMark, fill, std::memory_order_relaxed))
+            ;
+
+        return true;
+    }
+
+    /*!
+     * \brief pop copies the oldest item into \a item. Returns false if the buffer is empty.
+     */
+    bool pop(T &item)
+    {
+        const size_t currentHead = head.load(std::memory_order_relaxed);
+
+        if (currentHead == tail.load(std::memory_order_acquire))
+            return false;
+
+        item = slots[currentHead];
+        head.store(increment(currentHead), std::memory_order_release);
+
+        return true;
+    }
+
+    /*!
+     * \brief clear drops all queued items. Must only be called by the consumer thread.
+     */
+    void clear()
+    {
+        head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    size_t size() const
+    {
+        return sizeFrom(head.load(std::memory_order_acquire), tail.load(std::memory_order_acquire));
+    }
+
+    bool isEmpty() const
+    {
+        return size() == 0;
+    }
+
+    size_t capacity() const
+    {
+        return slots.size() - 1;
+    }
+
+    /*!
+     * \brief highWaterMark returns the maximum number of items queued at the same time.
+     */
+    size_t highWaterMark() const
+    {
+        return highWater.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief overruns returns the number of items dropped because the buffer was full.
+     */
+    quint64 overruns() const
+    {
+        return overrunCount.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief pushed returns the number of items successfully pushed.
+     */
+    quint64 pushed() const
+    {
+        return pushCount.load(std::memory_order_relaxed);
+    }
+
+    void resetStatistics()
+    {
+        highWater.store(0, std::memory_order_relaxed);
+        overrunCount.store(0, std::memory_order_relaxed);
+        pushCount.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<T> slots;
+
+    // head and tail are kept on separate cache lines:
+    // consumer and producer do not invalidate each other's line on every access
+    std::atomic<size_t> head{0};    // next slot to be read, written by consumer
+    char headPadding[64];
+    std::atomic<size_t> tail{0};    // next slot to be written, written by producer
+    char tailPadding[64];
+
+    std::atomic<size_t> highWater{0};
+    std::atomic<quint64> overrunCount{0};
+    std::atomic<quint64> pushCount{0};
+
+    size_t increment(size_t index) const
+    {
+        return (index + 1) == slots.size() ? 0 : index + 1;
+    }
+
+    size_t sizeFrom(size_t headIndex, size_t tailIndex) const
+    {
+        return tailIndex >= headIndex ? tailIndex - headIndex : slots.size() - headIndex + tailIndex;
+    }
+};
+
+#endif // SPSCRINGBUFFER_H
@@ -0,0 +1,228 @@
+#include "stressdatasource.h"
+
+#include "defaultSettings.h"
+
+/*!
+ * \class StressDataSource
+ * \brief Generates synthetic readings at high rates in order to stress test the measurement pipeline.
+ * The signal of each channel consists of a base value with drift, step responses to periodic exposures, gaussian noise and spikes.
+ * Sensor attributes and measurement events are generated as well.
+ *
+ * MeasurementData skips readings with the same timestamp, so consecutive readings get consecutive timestamps:
+ * at rates > 1 Hz the timestamps of the data run faster than real time.
+ * The signal model uses the real time since the start of the measurement.
+ */
+StressDataSource::StressDataSource(StressDataSource::Settings settings, int sensorTimeout):
+    DataSource(sensorTimeout, settings.nChannels),
+    settings(settings),
+    randomGenerator(settings.seed),
+    noiseDistribution(0.0, 1.0),
+    uniformDistribution(0.0, 1.0),
+    channelBase(settings.nChannels),
+    channelSensitivity(settings.nChannels),
+    vector(nullptr, settings.nChannels)
+{
+    Q_ASSERT("Invalid stress settings!" && settings.rate > 0 && settings.nChannels > 0);
+
+    for (int i=0; i<settings.nChannels; i++)
+    {
+        channelBase[i] = 1000.0 + 50.0 * (i % 64) + 1000.0 * uniformDistribution(randomGenerator);
+        channelSensitivity[i] = 2.0 * uniformDistribution(randomGenerator) - 1.0;
+    }
+
+    for (int i=0; i<settings.nAttributes; i++)
+        attributeNames << "attribute" + QString::number(i+1);
+}
+
+StressDataSource::~StressDataSource()
+{
+    if (generationTimer != nullptr)
+        generationTimer->deleteLater();
+}
+
+DataSource::SourceType StressDataSource::sourceType()
+{
+    return SourceType::FAKE;
+}
+
+QString StressDataSource::identifier()
+{
+    return "Stress Data Source";
+}
+
+StressDataSource::Settings StressDataSource::getSettings() const
+{
+    return settings;
+}
+
+/*!
+ * \brief StressDataSource::getNGenerated returns the number of readings generated since the source was created.
+ */
+quint64 StressDataSource::getNGenerated() const
+{
+    return nGenerated.load();
+}
+
+void StressDataSource::init()
+{
+    generationTimer = new QTimer();
+    generationTimer->setTimerType(Qt::PreciseTimer);
+    generationTimer->setSingleShot(false);
+    connect(generationTimer, &QTimer::timeout, this, &StressDataSource::generateDue);
+
+    setStatus(Status::CONNECTING);
+    setStatus(Status::CONNECTED);
+}
+
+void StressDataSource::start()
+{
+    Q_ASSERT("Stress source was already started!" && connectionStatus != Status::RECEIVING_DATA);
+
+    // start new measurement
+    if (status() != Status::PAUSED)
+    {
+        uint now = QDateTime::currentDateTime().toTime_t();
+        startTimestamp = qMax(now, startTimestamp + static_cast<uint>(sampleIndex) + 1);
+        sampleIndex = 0;
+        clockOffset = 0;
+
+        setStatus(Status::SET_BASEVECTOR);
+        publishBase();
+        sampleIndex++;
+    }
+
+    setStatus(Status::RECEIVING_DATA);
+
+    clock.start();
+    generationTimer->start(STRESS_TIMER_INTERVAL);
+}
+
+void StressDataSource::pause()
+{
+    generationTimer->stop();
+    clockOffset += clock.nsecsElapsed();
+    setStatus(Status::PAUSED);
+}
+
+void StressDataSource::stop()
+{
+    generationTimer->stop();
+    setStatus(Status::CONNECTED);
+}
+
+/*!
+ * \brief StressDataSource::reset sets the current drifted base values as new base vector.
+ */
+void StressDataSource::reset()
+{
+    setStatus(Status::SET_BASEVECTOR);
+    publishBase();
+    sampleIndex++;
+    setStatus(Status::RECEIVING_DATA);
+
+    if (!generationTimer->isActive())
+    {
+        clock.start();
+        generationTimer->start(STRESS_TIMER_INTERVAL);
+    }
+}
+
+void StressDataSource::reconnect()
+{
+    generationTimer->stop();
+    setStatus(Status::CONNECTING);
+    setStatus(Status::CONNECTED);
+}
+
+/*!
+ * \brief StressDataSource::generateDue generates all readings due since the last call.
+ * At most STRESS_MAX_BATCH readings are generated per call, so the source thread stays responsive if the generation falls behind.
+ */
+void StressDataSource::generateDue()
+{
+    qint64 elapsed = clockOffset + clock.nsecsElapsed();
+    quint64 due = static_cast<quint64>(elapsed * 1e-9 * settings.rate) + 1;   // + base vector
+
+    for (int n=0; sampleIndex < due && n < STRESS_MAX_BATCH; n++)
+    {
+        generate(startTimestamp + static_cast<uint>(sampleIndex), sampleIndex / settings.rate);
+        sampleIndex++;
+    }
+}
+
+void StressDataSource::generate(uint timestamp, double t)
+{
+    double driftFactor = 1.0 + settings.drift * t;
+    double response = exposureResponse(t);
+
+    for (int i=0; i<settings.nChannels; i++)
+    {
+        double value = channelBase[i] * driftFactor * (1.0 + channelSensitivity[i] * response);
+        value *= 1.0 + settings.noise * noiseDistribution(randomGenerator);
+
+        if (settings.spikeProbability > 0 && uniformDistribution(randomGenerator) < settings.spikeProbability)
+            value *= 1.0 + settings.spikeAmplitude;
+
+        vector[i] = value;
+    }
+
+    for (int i=0; i<attributeNames.size(); i++)
+        vector.sensorAttributes[attributeNames[i]] = 20.0 + i + qSin(t / 60.0 + i);
+
+    // measurement events
+    vector.userAnnotation = Annotation();
+    if (settings.eventRate > 0 && uniformDistribution(randomGenerator) < settings.eventRate / settings.rate)
+    {
+        // registered by the controler before the source is started
+        vector.userAnnotation = Annotation({aClass(STRESS_EVENT_CLASS)});
+    }
+
+    publishVector(timestamp, vector);
+    nGenerated++;
+}
+
+/*!
+ * \brief StressDataSource::exposureResponse returns the relative response at \a t seconds.
+ * Exposures start every stepPeriod seconds and last stepDuration seconds.
+ * The response rises with time constant stepTau during exposures and decays with the same constant afterwards.
+ */
+double StressDataSource::exposureResponse(double t) const
+{
+    if (settings.stepPeriod <= 0)
+        return 0.0;
+
+    double phase = std::fmod(t, settings.stepPeriod);
+
+    if (phase < settings.stepDuration)
+        return settings.stepAmplitude * (1.0 - qExp(-phase / settings.stepTau));
+
+    double endResponse = settings.stepAmplitude * (1.0 - qExp(-settings.stepDuration / settings.stepTau));
+    return endResponse * qExp(-(phase - settings.stepDuration) / settings.stepTau);
+}
+
+void StressDataSource::publishBase()
+{
+    double t = sampleIndex / settings.rate;
+    double driftFactor = 1.0 + settings.drift * t;
+
+    AbsoluteMVector baseVector(nullptr, settings.nChannels);
+    for (int i=0; i<settings.nChannels; i++)
+        baseVector[i] = channelBase[i] * driftFactor;
+
+    publishBaseVector(startTimestamp + static_cast<uint>(sampleIndex), baseVector);
+}
+
+QString StressDataSource::Settings::toString() const
+{
+    QStringList settingList;
+    settingList << "rate: " + QString::number(rate) + " Hz";
+    settingList << "channels: " + QString::number(nChannels);
+    settingList << "noise: " + QString::number(noise);
+    settingList << "drift: " + QString::number(drift) + "/s";
+    settingList << "exposures: " + QString::number(stepAmplitude) + " every " + QString::number(stepPeriod) + " s for " + QString::number(stepDuration) + " s (tau = " + QString::number(stepTau) + " s)";
+    settingList << "spikes: " + QString::number(spikeProbability) + " x " + QString::number(spikeAmplitude);
+    settingList << "attributes: " + QString::number(nAttributes);
+    settingList << "events: " + QString::number(eventRate) + "/s";
+
+    return settingList.join(", ");
+}
@@ -0,0 +1,80 @@
+#ifndef STRESSDATASOURCE_H
+#define STRESSDATASOURCE_H
+
+#include <QElapsedTimer>
+
+#include <random>
+
+#include "datasource.h"
+
+class StressDataSource : public DataSource
+{
+public:
+    /*!
+     * \brief The Settings struct describes the synthetic signal generated.
+     * Times are in seconds since the start of the measurement, values relative to the base value of each channel.
+     */
+    struct Settings{
+        double rate = 1000.0;               // readings per second
+        int nChannels = 64;
+        double noise = 0.002;               // standard deviation of the relative gaussian noise
+        double drift = 0.001;               // relative drift per second
+        double stepPeriod = 30.0;           // period of exposures, <= 0: no exposures
+        double stepDuration = 10.0;         // duration of each exposure
+        double stepAmplitude = 0.2;         // max relative response to an exposure
+        double stepTau = 3.0;               // time constant of exposure response & recovery
+        double spikeProbability = 1e-4;     // per channel and reading
+        double spikeAmplitude = 2.0;        // relative height of spikes
+        int nAttributes = 2;                // number of sensor attributes
+        double eventRate = 0.0;             // measurement events per second
+        unsigned int seed = 0;
+
+        QString toString() const;
+    };
+
+    StressDataSource(Settings settings, int sensorTimeout);
+    ~StressDataSource();
+
+    SourceType sourceType() override;
+    QString identifier() override;
+
+    Settings getSettings() const;
+    quint64 getNGenerated() const;
+
+public slots:
+    void init() override;
+    void start() override;
+    void pause() override;
+    void stop() override;
+    void reset() override;
+    void reconnect() override;
+
+private slots:
+    void generateDue();
+
+private:
+    Settings settings;
+
+    QTimer *generationTimer = nullptr;
+    QElapsedTimer clock;
+    qint64 clockOffset = 0;     // ns of measurement time when clock was started
+
+    uint startTimestamp = 0;
+    quint64 sampleIndex = 0;    // readings generated in the current measurement
+    std::atomic<quint64> nGenerated{0};
+
+    std::mt19937 randomGenerator;
+    std::normal_distribution<double> noiseDistribution;
+    std::uniform_real_distribution<double> uniformDistribution;
+
+    std::vector<double> channelBase;        // base resistance of each channel
+    std::vector<double> channelSensitivity; // response to exposures
+    QStringList attributeNames;
+    AbsoluteMVector vector;                 // reused for each reading
+
+    void generate(uint timestamp, double t);
+    double exposureResponse(double t) const;
+    void publishBase();
+};
+
+#endif // STRESSDATASOURCE_H
@@ -0,0 +1,321 @@
+#include "taskexecutor.h"
+
+#include <algorithm>
+
+namespace {
+
+// executor & index of the worker running in the current thread
+thread_local const TaskExecutor *currentExecutor = nullptr;
+thread_local int currentWorker = -1;
+
+}
+
+CancellationToken::CancellationToken():
+    cancelled(std::make_shared<std::atomic<bool>>(false))
+{
+}
+
+void CancellationToken::cancel()
+{
+    cancelled->store(true);
+}
+
+bool CancellationToken::isCancelled() const
+{
+    return cancelled->load();
+}
+
+/*!
+ * \brief TaskExecutor::Task::operator < orders the task heaps: higher priorities first, earlier submissions first among equal priorities.
+ */
+bool TaskExecutor::Task::operator<(const Task &other) const
+{
+    if (priority != other.priority)
+        return priority < other.priority;
+    return sequence > other.sequence;
+}
+
+/*!
+ * \brief The TaskExecutor::Worker class is a thread of the executor with its own task queue.
+ */
+class TaskExecutor::Worker : public QThread
+{
+public:
+    Worker(TaskExecutor *executor, int index):
+        executor(executor),
+        index(index)
+    {}
+
+    QMutex queueMutex;
+    std::vector<Task> queue;    // heap ordered by Task::operator<
+
+    void push(Task &&task)
+    {
+        QMutexLocker locker(&queueMutex);
+        queue.push_back(std::move(task));
+        std::push_heap(queue.begin(), queue.end());
+    }
+
+    bool pop(Task &task)
+    {
+        QMutexLocker locker(&queueMutex);
+        if (queue.empty())
+            return false;
+        std::pop_heap(queue.begin(), queue.end());
+        task = std::move(queue.back());
+        queue.pop_back();
+        return true;
+    }
+
+    bool peek(qint64 &priority)
+    {
+        QMutexLocker locker(&queueMutex);
+        if (queue.empty())
+            return false;
+        priority = queue.front().priority;
+        return true;
+    }
+
+protected:
+    void run() override
+    {
+        currentExecutor = executor;
+        currentWorker = index;
+        executor->work(index);
+    }
+
+private:
+    TaskExecutor *executor;
+    int index;
+};
+
+/*!
+ * \class TaskExecutor
+ * \brief Runs tasks in \a nThreads threads of its own (0: ideal thread count), independent of the global thread pool.
+ * Each thread has a queue ordered by priority. A thread runs the top task of its own queue and, if it is empty,
+ * steals the top task with the highest priority from the other queues.
+ * Tasks submitted by a running task are queued to the thread running it, other tasks are distributed round robin.
+ * Tasks whose cancellation token is cancelled before they start are skipped. Start, wait and run time of each task are recorded.
+ */
+TaskExecutor::TaskExecutor(int nThreads)
+{
+    if (nThreads <= 0)
+        nThreads = QThread::idealThreadCount();
+
+    clock.start();
+    for (int i=0; i<nThreads; i++)
+        workers.emplace_back(new Worker(this, i));
+    for (auto &worker : workers)
+        worker->start();
+}
+
+/*!
+ * \brief TaskExecutor::~TaskExecutor stops the threads after their current task. Queued tasks are dropped, call waitForDone() to run them.
+ */
+TaskExecutor::~TaskExecutor()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        workAvailable.wakeAll();
+    }
+
+    for (auto &worker : workers)
+        worker->wait();
+}
+
+/*!
+ * \brief TaskExecutor::submit queues \a function with \a priority. \a name identifies the task in the timings.
+ * The task is skipped if \a token is cancelled before it starts. Can be called from any thread, including tasks of the executor.
+ */
+void TaskExecutor::submit(std::function<void()> function, qint64 priority, QString name, CancellationToken token)
+{
+    Task task;
+    task.function = std::move(function);
+    task.priority = priority;
+    task.sequence = nSubmitted++;
+    task.submitTime = clock.nsecsElapsed();
+    task.name = name;
+    task.token = token;
+
+    bool submittedByWorker = currentExecutor == this && currentWorker >= 0;
+    task.owner = submittedByWorker ? currentWorker : static_cast<int>(task.sequence % workers.size());
+    workers[static_cast<size_t>(task.owner)]->push(std::move(task));
+
+    // the task is queued before it is counted: every counted task can be taken
+    QMutexLocker locker(&mutex);
+    nPending++;
+    workAvailable.wakeOne();
+}
+
+/*!
+ * \brief TaskExecutor::waitForDone blocks until all queued tasks and the tasks they submit are finished.
+ * Must not be called from a task of the executor.
+ */
+void TaskExecutor::waitForDone()
+{
+    Q_ASSERT("waitForDone called from a task of the executor" && currentExecutor != this);
+
+    QMutexLocker locker(&mutex);
+    while (nPending > 0 || nRunning > 0)
+        allDone.wait(&mutex);
+}
+
+int TaskExecutor::getNThreads() const
+{
+    return static_cast<int>(workers.size());
+}
+
+/*!
+ * \brief TaskExecutor::take takes the top task of the queue of \a workerIndex or steals the top task with the highest priority of another queue.
+ * Returns false if all queues were empty when looked at.
+ */
+bool TaskExecutor::take(int workerIndex, Task &task, bool &stolen)
+{
+    stolen = false;
+    if (workers[static_cast<size_t>(workerIndex)]->pop(task))
+        return true;
+
+    int victim = -1;
+    qint64 bestPriority = 0;
+    for (size_t i=1; i<workers.size(); i++)
+    {
+        int index = static_cast<int>((workerIndex + i) % workers.size());
+        qint64 priority;
+        if (workers[static_cast<size_t>(index)]->peek(priority) && (victim < 0 || priority > bestPriority))
+        {
+            victim = index;
+            bestPriority = priority;
+        }
+    }
+
+    // the top task may have been taken meanwhile: the caller retries
+    stolen = victim >= 0 && workers[static_cast<size_t>(victim)]->pop(task);
+    return stolen;
+}
+
+void TaskExecutor::execute(int workerIndex, Task &task, bool stolen)
+{
+    TaskTiming timing;
+    timing.name = task.name;
+    timing.worker = workerIndex;
+    timing.stolen = stolen;
+
+    qint64 startTime = clock.nsecsElapsed();
+    timing.startTime = startTime * 1e-6;
+    timing.waitTime = (startTime - task.submitTime) * 1e-6;
+
+    if (task.token.isCancelled())
+        timing.cancelled = true;
+    else
+    {
+        try {
+            task.function();
+        } catch (std::exception &exception) {
+            qWarning() << "Task" << task.name << "failed:" << exception.what();
+        }
+        timing.runTime = (clock.nsecsElapsed() - startTime) * 1e-6;
+    }
+
+    // release the captures of the task before it is counted as finished
+    task = Task();
+
+    QMutexLocker locker(&timingMutex);
+    timings << timing;
+}
+
+/*!
+ * \brief TaskExecutor::work is the loop of the thread \a workerIndex: reserves a queued task, takes it from one of the queues and runs it.
+ */
+void TaskExecutor::work(int workerIndex)
+{
+    forever
+    {
+        {
+            QMutexLocker locker(&mutex);
+            while (nPending == 0 && !stopping)
+                workAvailable.wait(&mutex);
+            if (stopping)
+                return;
+
+            nPending--;
+            nRunning++;
+        }
+
+        // the reserved task is in one of the queues, but may be taken by another thread reserving later
+        Task task;
+        bool stolen;
+        while (!take(workerIndex, task, stolen))
+            QThread::yieldCurrentThread();
+
+        execute(workerIndex, task, stolen);
+
+        QMutexLocker locker(&mutex);
+        nRunning--;
+        if (nPending == 0 && nRunning == 0)
+            allDone.wakeAll();
+    }
+}
+
+QList<TaskExecutor::TaskTiming> TaskExecutor::getTimings() const
+{
+    QMutexLocker locker(&timingMutex);
+    return timings;
+}
+
+void TaskExecutor::clearTimings()
+{
+    QMutexLocker locker(&timingMutex);
+    timings.clear();
+}
+
+/*!
+ * \brief TaskExecutor::saveTimings writes the timings of all tasks run to \a filename as ";" separated values. Returns false if the file can not be written.
+ */
+bool TaskExecutor::saveTimings(QString filename) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qWarning() << "Cannot write task timings to" << filename << ":" << file.errorString();
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "task;thread;stolen;cancelled;start [ms];wait [ms];run [ms]\n";
+    for (const TaskTiming &timing : getTimings())
+        out << timing.name << ";" << timing.worker << ";" << int(timing.stolen) << ";" << int(timing.cancelled) << ";"
+            << QString::number(timing.startTime, 'f', 3) << ";" << QString::number(timing.waitTime, 'f', 3) << ";" << QString::number(timing.runTime, 'f', 3) << "\n";
+
+    return true;
+}
+
+/*!
+ * \brief TaskExecutor::statistics summarises the timings: tasks run, stolen and cancelled, mean wait & run time and the share of the wall time the threads were busy.
+ */
+QString TaskExecutor::statistics() const
+{
+    auto timingList = getTimings();
+    if (timingList.isEmpty())
+        return "no tasks run";
+
+    int nStolen = 0, nCancelled = 0;
+    double waitTime = 0., runTime = 0., firstStart = qInf(), lastEnd = 0.;
+    for (const TaskTiming &timing : timingList)
+    {
+        nStolen += timing.stolen;
+        nCancelled += timing.cancelled;
+        waitTime += timing.waitTime;
+        runTime += timing.runTime;
+        firstStart = qMin(firstStart, timing.startTime);
+        lastEnd = qMax(lastEnd, timing.startTime + timing.runTime);
+    }
+
+    double wallTime = lastEnd - firstStart;
+    double utilisation = wallTime > 0. ? runTime / (wallTime * workers.size()) : 1.;
+
+    return QString("%1 tasks (%2 stolen, %3 cancelled) in %4 threads, mean wait %5 ms, mean run %6 ms, wall time %7 ms, utilisation %8 %")
+            .arg(timingList.size()).arg(nStolen).arg(nCancelled).arg(workers.size())
+            .arg(waitTime / timingList.size(), 0, 'f', 2).arg(runTime / timingList.size(), 0, 'f', 2)
+            .arg(wallTime, 0, 'f', 1).arg(100. * utilisation, 0, 'f', 1);
+}
@@ -0,0 +1,86 @@
+#ifndef TASKEXECUTOR_H
+#define TASKEXECUTOR_H
+
+#include <QtCore>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/*!
+ * \brief The CancellationToken class is shared by the tasks of one job: cancel() skips all of its tasks not yet started.
+ * Copies refer to the same state.
+ */
+class CancellationToken
+{
+public:
+    CancellationToken();
+
+    void cancel();
+    bool isCancelled() const;
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+class TaskExecutor
+{
+public:
+    struct TaskTiming{
+        QString name;
+        int worker = -1;                // thread that ran the task
+        bool stolen = false;            // taken from the queue of another thread
+        bool cancelled = false;         // skipped by its cancellation token
+        double startTime = 0.0;         // in ms since the executor was created
+        double waitTime = 0.0;          // in ms between submission & start
+        double runTime = 0.0;           // in ms
+    };
+
+    explicit TaskExecutor(int nThreads = 0);
+    ~TaskExecutor();
+
+    void submit(std::function<void()> function, qint64 priority = 0, QString name = "", CancellationToken token = CancellationToken());
+    void waitForDone();
+
+    int getNThreads() const;
+
+    QList<TaskTiming> getTimings() const;
+    void clearTimings();
+    bool saveTimings(QString filename) const;
+    QString statistics() const;
+
+private:
+    struct Task{
+        std::function<void()> function;
+        qint64 priority = 0;
+        quint64 sequence = 0;           // submission order, FIFO among equal priorities
+        qint64 submitTime = 0;          // in ns since the executor was created
+        QString name;
+        CancellationToken token;
+        int owner = -1;                 // queue the task was pushed to
+
+        bool operator<(const Task &other) const;
+    };
+
+    class Worker;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    QElapsedTimer clock;
+
+    QMutex mutex;                       // guards the counters below and the wait conditions
+    QWaitCondition workAvailable, allDone;
+    int nPending = 0;                   // tasks queued
+    int nRunning = 0;                   // tasks taken from a queue and not finished
+    bool stopping = false;
+    std::atomic<quint64> nSubmitted{0};
+
+    mutable QMutex timingMutex;
+    QList<TaskTiming> timings;
+
+    bool take(int workerIndex, Task &task, bool &stolen);
+    void execute(int workerIndex, Task &task, bool stolen);
+    void work(int workerIndex);
+};
+
+#endif // TASKEXECUTOR_H
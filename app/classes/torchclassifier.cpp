@@ -1,17 +1,34 @@
 #include "torchclassifier.h"
+#include "funcwindowbuffer.h"
+#include "mlpclassifier.h"
 
 #include <QtCore>
 
+#include <ATen/Parallel.h>
+#include <ATen/core/dispatch/Dispatcher.h>
+
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <memory>
 
-TorchClassifier::TorchClassifier(QObject *parent, QString filename, bool* loadOk, QString* errorString, int nInputs):
-    QObject(parent),
+namespace {
+
+// max difference of the class probabilities of the int8 layers to the float module on random inputs
+const double maxQuantizationDeviation = 0.1;
+
+}
+
+TorchClassifier::TorchClassifier(QObject *parent, QString filename, bool* loadOk, QString* errorString, int nInputs, Settings settings):
+    Classifier(parent),
     filename(filename),
     N{nInputs}
 {
     Q_ASSERT(loadOk != nullptr);
 
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+
     *loadOk = true;
 
     // load mandatory attributes
@@ -47,6 +64,19 @@ TorchClassifier::TorchClassifier(QObject *parent, QString filename, bool* loadOk
         name = filename;
 
     // extract dimensions
+    // nInputs <= 0: input size of the model
+    if (N <= 0)
+    {
+        if (module.hasattr("N"))
+            N = static_cast<int>(module.attr("N").toInt());
+        else
+        {
+            *loadOk = false;
+            *errorString += "Input size of the model is unknown: no N provided with model.\n";
+            return;
+        }
+    }
+
     if (module.hasattr("N"))
         if (module.attr("N").toInt() != N)
         {
@@ -63,31 +93,31 @@ TorchClassifier::TorchClassifier(QObject *parent, QString filename, bool* loadOk
 
     M = classNames.size();
 
-    // input function
-    if (module.hasattr("input_function"))
+    // temporal window: the model classifies the last window_length func vectors, optionally followed by their slopes
+    if (module.hasattr("window_length"))
+        windowLength = static_cast<int>(module.attr("window_length").toInt());
+    if (module.hasattr("window_stride"))
+        windowStride = static_cast<int>(module.attr("window_stride").toInt());
+    if (module.hasattr("window_slopes"))
+        windowSlopes = module.attr("window_slopes").toBool();
+
+    if (windowLength < 1 || windowStride < 1)
     {
-        QString input_function = module.attr("input_function").toString()->string().c_str();
-
-        if (input_function == "average")
-            inputFunctionType = InputFunctionType::average;
-        else if (input_function == "median_average")
-            inputFunctionType = InputFunctionType::medianAverage;
-        else if (input_function == "None")
-            inputFunctionType = InputFunctionType::none;
+        *loadOk = false;
+        *errorString += "Model is inconsistent: window length " + QString::number(windowLength) + " and window stride " + QString::number(windowStride) + " have to be positive!\n";
+        windowLength = 1;
+        windowStride = 1;
     }
 
+    inputWidth = FuncWindowBuffer::inputWidth(N, windowLength, windowSlopes);
+
+    // input function
+    if (module.hasattr("input_function"))
+        inputFunctionType = inputFunctionFromString(module.attr("input_function").toString()->string().c_str(), inputFunctionType);
+
     // output function
     if (module.hasattr("output_function"))
-    {
-        QString output_function = module.attr("output_function").toString()->string().c_str();
-
-        if (output_function == "logsoftmax")
-            outputFunctionType = OutputFunctionType::logsoftmax;
-        else if (output_function == "sigmoid")
-            outputFunctionType = OutputFunctionType::sigmoid;
-        else if (output_function == "None")
-            outputFunctionType = OutputFunctionType::none;
-    }
+        outputFunctionType = outputFunctionFromString(module.attr("output_function").toString()->string().c_str(), outputFunctionType);
 
     // apply threshold
     if (module.hasattr("is_multi_label"))
@@ -109,7 +139,7 @@ TorchClassifier::TorchClassifier(QObject *parent, QString filename, bool* loadOk
         for (auto it = meanList.begin(); it != meanList.end(); it++)
             mean_vector.push_back(*it);
 
-        if (mean_vector.size() != N)
+        if (mean_vector.size() != N && mean_vector.size() != inputWidth)
         {
 
             *loadOk = false;
@@ -125,7 +155,7 @@ TorchClassifier::TorchClassifier(QObject *parent, QString filename, bool* loadOk
         for (auto it = varList.begin(); it != varList.end(); it++)
             stdev_vector.push_back(std::sqrt(*it));
 
-        if (stdev_vector.size() != N)
+        if (stdev_vector.size() != N && stdev_vector.size() != inputWidth)
         {
 
             *loadOk = false;
@@ -137,6 +167,27 @@ TorchClassifier::TorchClassifier(QObject *parent, QString filename, bool* loadOk
     if (module.hasattr("preset_name"))
         presetName = QString(module.attr("preset_name").toString()->string().c_str());
 
+    // model key: hash of the model file & preset, the preparation is added by prepareModule
+    QFile modelFile(filename);
+    QCryptographicHash fileHash(QCryptographicHash::Sha1);
+    if (modelFile.open(QIODevice::ReadOnly) && fileHash.addData(&modelFile))
+        modelKey = fileHash.result() + presetName.toUtf8();
+    else
+        modelKey = filename.toUtf8() + presetName.toUtf8();
+
+    // normalisation: (x - shift) * scale
+    computeNormalisation(mean_vector, stdev_vector, N, windowLength, inputWidth, shift, scale);
+
+    // all attributes were read: the module can be frozen
+    if (*loadOk)
+    {
+        prepareModule(settings);
+        modelKey += "|" + preparation.toUtf8();
+        warmUp(settings.nWarmupRuns);
+
+        loadTime = loadTimer.nsecsElapsed() * 1e-6;
+        qDebug().noquote() << "Classifier" << name << "loaded in" << QString::number(loadTime, 'f', 1) << "ms (" + settings.toString() + ")";
+    }
 
 //    qDebug() << module.dump_to_str(false, true, true, 3).c_str();
 //    qDebug() << classNames.join(", ");
@@ -145,21 +196,424 @@ TorchClassifier::TorchClassifier(QObject *parent, QString filename, bool* loadOk
         *errorString += "See the classifier section <a href=\"https://github.com/Tilagiho/eNoseAnnotator/blob/master/README.md\">documentation</a> for more information.\n";
 }
 
-at::Tensor TorchClassifier::forward(std::vector<double> rawInput)
+/*!
+ * \brief TorchClassifier::prepareModule switches the module to evaluation mode and quantizes, freezes or optimises it for inference as set in \a settings.
+ * If quantizing fails, the module is frozen instead. If freezing fails, the module is used as loaded.
+ * The preparation applied is kept: it changes the outputs, so it is part of the model key.
+ */
+void TorchClassifier::prepareModule(const TorchClassifier::Settings &settings)
+{
+    module.eval();
+    preparation = "float";
+
+    // the layers are taken from the module before freezing inlines them
+    if (settings.quantization != "off")
+    {
+        QString errorString;
+        if (setQuantizedEngine(settings.quantization, &errorString) && quantize(&errorString))
+        {
+            preparation = "int8 " + getQuantizedEngine();
+            return;
+        }
+
+        qWarning().noquote() << "Classifier" << name << "could not be quantized, using float:" << errorString;
+    }
+
+    try {
+        // optimize_for_inference freezes the module first
+        if (settings.optimize)
+        {
+            module = torch::jit::optimize_for_inference(module);
+            preparation = "optimized";
+        }
+        else if (settings.freeze)
+        {
+            module = torch::jit::freeze(module);
+            preparation = "frozen";
+        }
+    } catch (const c10::Error& e) {
+        qWarning() << "Classifier" << name << "could not be frozen, using it unfrozen:" << e.msg().c_str();
+    }
+}
+
+/*!
+ * \brief TorchClassifier::quantize replaces the module by its Linear layers with int8 weights, run by quantized::linear_dynamic of the quantized engine set:
+ * the weights are quantized symmetrically per tensor once, the activations dynamically per batch.
+ * The int8 layers have to reproduce the module on random inputs, which fails if the module is no sequence of Linear and activation modules.
+ */
+bool TorchClassifier::quantize(QString *errorString)
+{
+    QList<MlpClassifier::Layer> layers;
+    if (!extractLayers(module, layers, errorString))
+        return false;
+
+    if (layers.first().nInputs != inputWidth)
+    {
+        *errorString = "First Linear module takes " + QString::number(layers.first().nInputs) + " inputs, but the model takes " + QString::number(inputWidth) + ".";
+        return false;
+    }
+
+    try {
+        static const c10::OperatorHandle prepack = c10::Dispatcher::singleton().findSchemaOrThrow("quantized::linear_prepack", "");
+
+        // the prepacked weights keep the engine set now, even if later loads change the global engine
+        c10::QEngine engine = at::globalContext().qEngine();
+        quantizedEngine = QString(c10::toString(engine).c_str());
+        reduceRange = engine == c10::QEngine::FBGEMM;
+
+        for (MlpClassifier::Layer &layer : layers)
+        {
+            at::Tensor weight = torch::from_blob(layer.weights.data(), {layer.nOutputs, layer.nInputs}, torch::kFloat32);
+            double scale = qMax(weight.abs().max().item<double>() / 127.0, 1e-10);
+
+            torch::jit::Stack stack;
+            stack.emplace_back(at::quantize_per_tensor(weight, scale, 0, at::kQInt8));
+            if (layer.bias.empty())
+                stack.emplace_back();
+            else
+                stack.emplace_back(torch::from_blob(layer.bias.data(), {layer.nOutputs}, torch::kFloat32).clone());
+            prepack.callBoxed(&stack);
+
+            QuantizedLayer quantizedLayer;
+            quantizedLayer.packedWeights = stack.back();
+            quantizedLayer.activation = layer.activation;
+            quantizedLayer.negativeSlope = layer.negativeSlope;
+            quantizedLayers.push_back(quantizedLayer);
+        }
+
+        c10::InferenceMode inferenceMode;
+        at::Tensor input = torch::randn({16, inputWidth});
+        at::Tensor floatOutput = applyOutputFunction(module.forward({input}).toTensor());
+        at::Tensor int8Output = applyOutputFunction(forwardQuantized(input));
+
+        double deviation = floatOutput.sizes() == int8Output.sizes() ? (floatOutput - int8Output).abs().max().item<double>() : std::numeric_limits<double>::infinity();
+        if (!(deviation <= maxQuantizationDeviation))
+        {
+            quantizedLayers.clear();
+            *errorString = "The Linear and activation modules don't reproduce the output of the model (max deviation " + QString::number(deviation) + ").";
+            return false;
+        }
+    } catch (const c10::Error& e) {
+        quantizedLayers.clear();
+        *errorString = e.msg().c_str();
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief TorchClassifier::setQuantizedEngine sets the quantized backend of libtorch to \a engineName: "fbgemm", "qnnpack" or "auto" (FBGEMM if supported, QNNPACK otherwise).
+ * The engine is global: models quantized in python run on the engine set last. The int8 layers of quantize() keep the engine they were prepacked for.
+ * Returns false and sets \a errorString if the engine is not supported by the CPU or libtorch build.
+ */
+bool TorchClassifier::setQuantizedEngine(QString engineName, QString *errorString)
+{
+    const std::vector<c10::QEngine> &supported = at::globalContext().supportedQEngines();
+    auto isSupported = [&supported](c10::QEngine engine){
+        return std::find(supported.begin(), supported.end(), engine) != supported.end();
+    };
+
+    c10::QEngine engine;
+    if (engineName == "fbgemm")
+        engine = c10::QEngine::FBGEMM;
+    else if (engineName == "qnnpack")
+        engine = c10::QEngine::QNNPACK;
+    else
+        engine = isSupported(c10::QEngine::FBGEMM) ? c10::QEngine::FBGEMM : c10::QEngine::QNNPACK;
+
+    if (!isSupported(engine))
+    {
+        *errorString = "Quantized engine " + QString(c10::toString(engine).c_str()) + " is not supported on this system.";
+        return false;
+    }
+
+    at::globalContext().setQEngine(engine);
+    return true;
+}
+
+/*!
+ * \brief TorchClassifier::warmUp classifies a zero vector \a nRuns times, so lazy initialisations and graph optimisations of the module
+ * happen before the first live prediction.
+ */
+void TorchClassifier::warmUp(int nRuns)
+{
+    if (nRuns <= 0)
+        return;
+
+    std::vector<double> zeroInput(static_cast<size_t>(inputWidth), 0.0);
+    QElapsedTimer warmupTimer;
+    double lastRunTime = 0.0;
+
+    try {
+        for (int i=0; i<nRuns; i++)
+        {
+            warmupTimer.start();
+            getAnnotation(zeroInput, false);
+            lastRunTime = warmupTimer.nsecsElapsed() * 1e-6;
+        }
+    } catch (const std::exception& e) {
+        qWarning() << "Warm-up of classifier" << name << "failed:" << e.what();
+        return;
+    }
+
+    qDebug().noquote() << "Classifier" << name << "warmed up: first inference" << QString::number(firstInferenceTime, 'f', 2) << "ms, last inference" << QString::number(lastRunTime, 'f', 2) << "ms";
+}
+
+/*!
+ * \brief TorchClassifier::setThreadCounts sets the number of intra-op and inter-op threads of libtorch. Values <= 0 keep the current number.
+ * The inter-op threads can only be set before libtorch ran inter-op work for the first time, later changes are ignored with a warning.
+ */
+void TorchClassifier::setThreadCounts(int intraOpThreads, int interOpThreads)
+{
+    if (intraOpThreads > 0 && at::get_num_threads() != intraOpThreads)
+        at::set_num_threads(intraOpThreads);
+
+    if (interOpThreads > 0 && at::get_num_interop_threads() != interOpThreads)
+    {
+        try {
+            at::set_num_interop_threads(interOpThreads);
+        } catch (const c10::Error& e) {
+            qWarning() << "Number of classifier inter-op threads is applied after a restart";
+        }
+    }
+}
+
+/*!
+ * \brief TorchClassifier::exportMlp converts the TorchScript classifier \a filename into a compact model file for MlpClassifier at \a mlpFilename.
+ * The model attributes are copied, the Linear and activation submodules become the dense layers in the order they are registered.
+ * Dropout, Identity and Flatten modules are skipped, other modules can't be exported.
+ * Activations called in forward() instead of being registered as modules are not seen, so the result should be compared to the TorchScript model.
+ * Returns false and sets \a errorString if the model can't be exported.
+ */
+bool TorchClassifier::exportMlp(QString filename, QString mlpFilename, QString *errorString)
 {
-    // create float vector
-    std::vector<float> floatVector;
-    for (double value : rawInput)
-        floatVector.push_back(static_cast<float>(value));
-    // Create a vector of inputs.
-    torch::Tensor inputTensor = at::from_blob(floatVector.data(), {1, N});
+    torch::jit::script::Module module;
+    try {
+        module = torch::jit::load(filename.toStdString());
+    } catch (const c10::Error& e) {
+        *errorString = e.msg().c_str();
+        return false;
+    }
+    module.eval();
+
+    // attributes of the classifier
+    QJsonObject attributes;
+    const QStringList attributeNames{"classList", "name", "N", "M", "input_function", "output_function", "is_multi_label", "threshold", "isInputAbsolute",
+                                     "mean", "variance", "preset_name", "window_length", "window_stride", "window_slopes"};
+    for (const QString &attributeName : attributeNames)
+    {
+        if (!module.hasattr(attributeName.toStdString()))
+            continue;
+
+        torch::jit::IValue value = module.attr(attributeName.toStdString());
+        if (value.isString())
+            attributes[attributeName] = QString(value.toStringRef().c_str());
+        else if (value.isBool())
+            attributes[attributeName] = value.toBool();
+        else if (value.isInt())
+            attributes[attributeName] = static_cast<int>(value.toInt());
+        else if (value.isDouble())
+            attributes[attributeName] = value.toDouble();
+        else if (value.isDoubleList())
+        {
+            QJsonArray array;
+            for (double element : value.toDoubleVector())
+                array.append(element);
+            attributes[attributeName] = array;
+        }
+    }
+
+    QList<MlpClassifier::Layer> layers;
+    if (!extractLayers(module, layers, errorString))
+        return false;
+
+    return MlpClassifier::save(mlpFilename, attributes, layers, errorString);
+}
+
+/*!
+ * \brief TorchClassifier::extractLayers reads the Linear and activation submodules of \a module as dense \a layers, in the order they are registered.
+ * Dropout, Identity and Flatten modules are skipped. Returns false and sets \a errorString if other modules are found.
+ */
+bool TorchClassifier::extractLayers(const torch::jit::script::Module &module, QList<MlpClassifier::Layer> &layers, QString *errorString)
+{
+    bool activationSet = false;
+    try {
+        for (const auto &submodule : module.named_modules())
+        {
+            QString typeName = submodule.value.type()->name() ? QString(submodule.value.type()->name()->name().c_str()) : "";
+
+            if (typeName == "Linear")
+            {
+                at::Tensor weight = submodule.value.attr("weight").toTensor().to(torch::kFloat32).contiguous();
+
+                MlpClassifier::Layer layer;
+                layer.nOutputs = static_cast<int>(weight.size(0));
+                layer.nInputs = static_cast<int>(weight.size(1));
+                layer.weights.assign(weight.data_ptr<float>(), weight.data_ptr<float>() + weight.numel());
+
+                torch::jit::IValue bias = submodule.value.attr("bias");
+                if (!bias.isNone())
+                {
+                    at::Tensor biasTensor = bias.toTensor().to(torch::kFloat32).contiguous();
+                    layer.bias.assign(biasTensor.data_ptr<float>(), biasTensor.data_ptr<float>() + biasTensor.numel());
+                }
+
+                layers << layer;
+                activationSet = false;
+                continue;
+            }
+
+            // containers & layers without effect in evaluation mode
+            if (submodule.name.empty() || typeName == "Sequential" || typeName == "Dropout" || typeName == "Identity" || typeName == "Flatten")
+                continue;
+
+            MlpClassifier::Activation activation;
+            if (typeName == "ReLU")
+                activation = MlpClassifier::Activation::ReLU;
+            else if (typeName == "LeakyReLU")
+                activation = MlpClassifier::Activation::LeakyReLU;
+            else if (typeName == "Sigmoid")
+                activation = MlpClassifier::Activation::Sigmoid;
+            else if (typeName == "Tanh")
+                activation = MlpClassifier::Activation::Tanh;
+            else if (typeName == "Softmax")
+                activation = MlpClassifier::Activation::Softmax;
+            else if (typeName == "LogSoftmax")
+                activation = MlpClassifier::Activation::LogSoftmax;
+            else
+            {
+                *errorString = "Module " + QString(submodule.name.c_str()) + " of type " + typeName + " is not supported.";
+                return false;
+            }
+
+            if (layers.isEmpty() || activationSet)
+            {
+                *errorString = "Activation " + QString(submodule.name.c_str()) + " does not follow a Linear module.";
+                return false;
+            }
+
+            layers.last().activation = activation;
+            if (activation == MlpClassifier::Activation::LeakyReLU)
+                layers.last().negativeSlope = static_cast<float>(submodule.value.attr("negative_slope").toDouble());
+            activationSet = true;
+        }
+    } catch (const c10::Error& e) {
+        *errorString = e.msg().c_str();
+        return false;
+    }
+
+    if (layers.isEmpty())
+    {
+        *errorString = "Model contains no Linear modules.";
+        return false;
+    }
+
+    return true;
+}
+
+bool TorchClassifier::getIsQuantized() const
+{
+    return !quantizedLayers.empty();
+}
+
+/*!
+ * \brief TorchClassifier::getQuantizedEngine returns the quantized engine the int8 layers were prepacked for when the classifier was loaded,
+ * an empty string if the classifier is not quantized. The layers run on this engine independently of the global engine set by later loads.
+ */
+QString TorchClassifier::getQuantizedEngine() const
+{
+    return getIsQuantized() ? quantizedEngine : "";
+}
+
+double TorchClassifier::getLoadTime() const
+{
+    return loadTime;
+}
+
+/*!
+ * \brief TorchClassifier::getFirstInferenceTime returns the duration of the first inference in ms, 0 if no inference was run yet.
+ */
+double TorchClassifier::getFirstInferenceTime() const
+{
+    return firstInferenceTime;
+}
+
+/*!
+ * \brief TorchClassifier::getModelKey returns the key identifying the model in the classification cache:
+ * the SHA-1 hash of the model file, the preset name and the preparation (quantized with its engine, optimized, frozen or float).
+ */
+QByteArray TorchClassifier::getModelKey() const
+{
+    return modelKey;
+}
+
+/*!
+ * \brief TorchClassifier::setCache sets the \a cache used by getAnnotation and getAnnotations. The cache is not owned by the classifier,
+ * nullptr disables caching.
+ */
+void TorchClassifier::setCache(ClassificationCache *value)
+{
+    cache = value;
+}
+
+/*!
+ * \brief TorchClassifier::takeInputBuffer returns a float tensor with at least \a nRows rows of inputWidth the inputs can be normalised into.
+ * Buffers returned by returnInputBuffer are reused and only reallocated if they are too small. Their data is aligned by the torch allocator.
+ * Can be called from any thread.
+ */
+at::Tensor TorchClassifier::takeInputBuffer(int nRows) const
+{
+    at::Tensor buffer;
+    {
+        QMutexLocker locker(&inputBufferMutex);
+        if (!inputBuffers.empty())
+        {
+            buffer = std::move(inputBuffers.back());
+            inputBuffers.pop_back();
+        }
+    }
+
+    if (!buffer.defined() || buffer.size(0) < nRows)
+        buffer = torch::empty({nRows, inputWidth}, torch::kFloat32);
+
+    return buffer;
+}
+
+/*!
+ * \brief TorchClassifier::returnInputBuffer makes \a buffer taken by takeInputBuffer available for the next inference.
+ */
+void TorchClassifier::returnInputBuffer(at::Tensor buffer) const
+{
+    QMutexLocker locker(&inputBufferMutex);
+    inputBuffers.push_back(std::move(buffer));
+}
+
+/*!
+ * \brief TorchClassifier::forward runs the model on the normalised input rows of \a inputTensor.
+ */
+at::Tensor TorchClassifier::forward(const at::Tensor &inputTensor)
+{
+    c10::InferenceMode inferenceMode;
 
 //    std::cout << "Called forward with input: " << inputTensor.slice(1,0,8);
     std::vector<torch::jit::IValue> inputs;
     inputs.push_back(inputTensor);
 
+    // time the first inference
+    bool isFirstInference = !firstInferenceDone.exchange(true);
+    QElapsedTimer inferenceTimer;
+    if (isFirstInference)
+        inferenceTimer.start();
+
     // Execute the model and turn its output into a tensor.
-    at::Tensor output = module.forward(inputs).toTensor();
+    at::Tensor output = quantizedLayers.empty() ? module.forward(inputs).toTensor() : forwardQuantized(inputTensor);
+
+    if (isFirstInference)
+    {
+        firstInferenceTime = inferenceTimer.nsecsElapsed() * 1e-6;
+        qDebug().noquote() << "First inference of classifier" << name << "took" << QString::number(firstInferenceTime, 'f', 2) << "ms";
+    }
 
 //    std::cout << "Calculated output: " << output.slice(1,0,classNames.size());
 
@@ -167,89 +621,150 @@ at::Tensor TorchClassifier::forward(std::vector<double> rawInput)
     return output;
 }
 
-Annotation TorchClassifier::getAnnotation(std::vector<double> input)
+/*!
+ * \brief TorchClassifier::forwardQuantized runs the int8 layers on the normalised input rows of \a inputTensor.
+ */
+at::Tensor TorchClassifier::forwardQuantized(const at::Tensor &inputTensor) const
 {
-    if (input.size() != N)
+    static const c10::OperatorHandle linearDynamic = c10::Dispatcher::singleton().findSchemaOrThrow("quantized::linear_dynamic", "");
+
+    at::Tensor x = inputTensor;
+    for (const QuantizedLayer &layer : quantizedLayers)
+    {
+        torch::jit::Stack stack{x, layer.packedWeights, reduceRange};
+        linearDynamic.callBoxed(&stack);
+        x = stack.back().toTensor();
+
+        switch (layer.activation)
+        {
+        case MlpClassifier::Activation::ReLU:
+            x = torch::relu(x);
+            break;
+        case MlpClassifier::Activation::LeakyReLU:
+            x = torch::leaky_relu(x, layer.negativeSlope);
+            break;
+        case MlpClassifier::Activation::Sigmoid:
+            x = torch::sigmoid(x);
+            break;
+        case MlpClassifier::Activation::Tanh:
+            x = torch::tanh(x);
+            break;
+        case MlpClassifier::Activation::Softmax:
+            x = torch::softmax(x, 1);
+            break;
+        case MlpClassifier::Activation::LogSoftmax:
+            x = torch::log_softmax(x, 1);
+            break;
+        default:
+            break;
+        }
+    }
+
+    return x;
+}
+
+/*!
+ * \brief TorchClassifier::getAnnotation classifies \a input. Inputs found in the cache are not classified again, unless \a useCache is false.
+ * Throws std::invalid_argument if the input has the wrong size.
+ */
+Annotation TorchClassifier::getAnnotation(const std::vector<double> &input, bool useCache)
+{
+    if (input.size() != inputWidth)
         throw std::invalid_argument("Input vector has wrong size.");
 
-//    std::cout << "input" << input << "\n";
-    auto normalised_input = normalise(input);
-//    std::cout << "normalised input" << normalised_input << "\n";
+    ClassificationCache *inputCache = useCache ? cache : nullptr;
 
-    // get class probabilities
-    auto output = forward(normalised_input);
+    Annotation annotation;
+    if (inputCache != nullptr && inputCache->find(modelKey, input, annotation))
+        return annotation;
 
-//    std::cout << "output: " << output.slice(1,0,classNames.size()) << "\n";
+    annotation = classify(input);
 
-    // apply outputFunction
-    at::Tensor probabilities;
-    if (outputFunctionType == OutputFunctionType::logsoftmax)
-        probabilities = torch::softmax(output, 1);
-    else if (outputFunctionType == OutputFunctionType::sigmoid)
-        probabilities = torch::sigmoid(output);
-    else
-        probabilities = output;
+    if (inputCache != nullptr)
+        inputCache->insert(modelKey, input, annotation);
 
-//    std::cout << "probabilities: " << probabilities.slice(1,0,classNames.size()) << "\n";
+    return annotation;
+}
 
+Annotation TorchClassifier::classify(const std::vector<double> &input)
+{
+    at::Tensor inputBuffer = takeInputBuffer(1);
+    at::Tensor inputTensor = inputBuffer.narrow(0, 0, 1);
+    normalise(input.data(), (float*) inputTensor.data_ptr());
 
-    //                              //
-    // extract classes from tensor  //
-    //                              //
-    QSet<aClass> classSet;
+    // get class probabilities
+    at::Tensor probabilities = applyOutputFunction(forward(inputTensor)).contiguous();
+    returnInputBuffer(inputBuffer);
 
-    float* ptr = (float*) probabilities.data_ptr();
-    for (int i = 0; i < classNames.size(); ++i)
-        classSet << aClass(classNames[i], *ptr++);
+    return decodeAnnotation((float*) probabilities.data_ptr(), classNames, isMultiLabel, threshold, isRegression);
+}
 
-    //                                          //
-    // make predictions based on probabilities  //
-    //                                          //
-    QSet<aClass> predClasses;
-    // multi label classification:
-    if (isMultiLabel)
-    {
-        // apply threshold to get labels
-        for (aClass aclass : classSet)
-        {
-            if (aclass.getValue() > threshold)
-                predClasses << aClass(aclass);
-        }
-        // set prob of No Smell 1-maxProb
-        double maxProb = 0.;
-        for (aClass aclass : classSet)
-        {
-            if (aclass.getValue() > maxProb)
-                maxProb = aclass.getValue();
-        }
-        classSet << aClass(NO_SMELL_STRING, 1.-maxProb);
+/*!
+ * \brief TorchClassifier::getAnnotations classifies all \a inputs. Inputs found in the cache are taken from it if \a useCache is set,
+ * the remaining rows are packed into tensors of up to \a batchSize rows, so the model runs once per chunk instead of once per input.
+ * The annotations equal those of getAnnotation for each input.
+ * Throws std::invalid_argument if an input has the wrong size.
+ */
+QList<Annotation> TorchClassifier::getAnnotations(const std::vector<std::vector<double>> &inputs, int batchSize, bool useCache)
+{
+    Q_ASSERT("Invalid batch size!" && batchSize > 0);
 
-        // set pred to No Smell if no label was detected
-        if (predClasses.isEmpty())
-            predClasses << aClass(NO_SMELL_STRING);
-    }
-    // multi-class classification:
-    // get class with highest probabillity
-    else
+    ClassificationCache *inputCache = useCache ? cache : nullptr;
+
+    QVector<Annotation> annotations(static_cast<int>(inputs.size()));
+
+    // look up cached inputs
+    std::vector<size_t> missing;
+    missing.reserve(inputs.size());
+    for (size_t i=0; i<inputs.size(); i++)
     {
-        for (aClass aclass : classSet)
-            if (predClasses.isEmpty())
-                predClasses << aclass;
-            else if (aclass.getValue() > predClasses.begin()->getValue())
-            {
-                predClasses.clear();
-                predClasses << aClass(aclass);
-            }
+        if (inputs[i].size() != inputWidth)
+            throw std::invalid_argument("Input vector has wrong size.");
+
+        if (inputCache == nullptr || !inputCache->find(modelKey, inputs[i], annotations[static_cast<int>(i)]))
+            missing.push_back(i);
     }
-    // no regression:
-    // ignore value of predicted classes
-    if (!isRegression)
+
+    if (missing.empty())
+        return annotations.toList();
+
+    at::Tensor inputBuffer = takeInputBuffer(static_cast<int>(qMin(missing.size(), static_cast<size_t>(batchSize))));
+    for (size_t start=0; start<missing.size(); start+=static_cast<size_t>(batchSize))
     {
-        for (aClass aclass : predClasses)
-            aclass.setType(aClass::Type::CLASS_ONLY);
+        int nRows = static_cast<int>(qMin(missing.size() - start, static_cast<size_t>(batchSize)));
+        at::Tensor inputTensor = inputBuffer.narrow(0, 0, nRows);
+        float* inputData = (float*) inputTensor.data_ptr();
+
+        for (int row=0; row<nRows; row++)
+            normalise(inputs[missing[start + row]].data(), inputData + row * inputWidth);
+
+        // get class probabilities
+        at::Tensor probabilities = applyOutputFunction(forward(inputTensor)).contiguous();
+
+        float* ptr = (float*) probabilities.data_ptr();
+        int rowSize = static_cast<int>(probabilities.size(1));
+        for (int row=0; row<nRows; row++)
+        {
+            size_t index = missing[start + row];
+            annotations[static_cast<int>(index)] = decodeAnnotation(ptr + row * rowSize, classNames, isMultiLabel, threshold, isRegression);
+
+            if (inputCache != nullptr)
+                inputCache->insert(modelKey, inputs[index], annotations[static_cast<int>(index)]);
+        }
     }
+    returnInputBuffer(inputBuffer);
+
+    return annotations.toList();
+}
 
-    return Annotation(classSet, predClasses);
+at::Tensor TorchClassifier::applyOutputFunction(const at::Tensor &output)
+{
+    if (outputFunctionType == OutputFunctionType::logsoftmax)
+        return torch::softmax(output, 1);
+    else if (outputFunctionType == OutputFunctionType::sigmoid)
+        return torch::sigmoid(output);
+    else
+        return output;
 }
 
 QString TorchClassifier::getName() const
@@ -272,11 +787,38 @@ QStringList TorchClassifier::getClassNames() const
     return classNames;
 }
 
+/*!
+ * \brief TorchClassifier::getN returns the size of the func vectors classified.
+ */
 int TorchClassifier::getN() const
 {
     return N;
 }
 
+/*!
+ * \brief TorchClassifier::getInputWidth returns the number of inputs of the model: the values of a window of func vectors and their slopes.
+ * Equals N for models classifying single func vectors.
+ */
+int TorchClassifier::getInputWidth() const
+{
+    return inputWidth;
+}
+
+int TorchClassifier::getWindowLength() const
+{
+    return windowLength;
+}
+
+int TorchClassifier::getWindowStride() const
+{
+    return windowStride;
+}
+
+bool TorchClassifier::getWindowSlopes() const
+{
+    return windowSlopes;
+}
+
 int TorchClassifier::getM() const
 {
     return M;
@@ -292,28 +834,27 @@ InputFunctionType TorchClassifier::getInputFunctionType() const
     return inputFunctionType;
 }
 
-std::vector<double> TorchClassifier::normalise(std::vector<double> input)
+bool TorchClassifier::getIsMultiLabel() const
 {
-    Q_ASSERT(input.size() == N);
-
-    // variance not set:
-    // don't normalise
-    if (stdev_vector.empty())
-        return input;
-
-    // mean not set:
-    // zero init
-    if (mean_vector.empty())
-        for (int i=0; i<N; i++)
-            mean_vector.push_back(0.0);
-
-    Q_ASSERT(mean_vector.size() == N);
-    Q_ASSERT(stdev_vector.size() == N);
+    return isMultiLabel;
+}
 
-    std::vector<double> normalised_vector;
-    for (uint i=0; i<N; i++)
-        normalised_vector.push_back((input[i] - mean_vector[i]) / stdev_vector[i]);
+double TorchClassifier::getThreshold() const
+{
+    return threshold;
+}
 
-    return normalised_vector;
+/*!
+ * \brief TorchClassifier::normalise normalises the inputWidth values of \a input and converts them to float in one pass, writing directly to \a output.
+ * The shift & scale arrays are precomputed at load time, so the loop has no branches and is vectorised by the compiler.
+ * Does not modify the classifier, so inputs can be classified in a worker thread while the GUI thread classifies live vectors.
+ */
+void TorchClassifier::normalise(const double *input, float *output) const
+{
+    const double *shiftData = shift.data();
+    const double *scaleData = scale.data();
 
+    // shift in double: rounding the raw values to float first would lose the digits the shift leaves
+    for (int i=0; i<inputWidth; i++)
+        output[i] = static_cast<float>((input[i] - shiftData[i]) * scaleData[i]);
 }
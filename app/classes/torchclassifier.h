@@ -8,34 +8,67 @@
 #include <torch/script.h>
 #define slots Q_SLOTS
 
-#include "annotation.h"
+#include <atomic>
 
-#include "classifier_definitions.h"
+#include "classifier.h"
+#include "mlpclassifier.h"
 
-class TorchClassifier : public QObject
+class TorchClassifier : public Classifier
 {
     Q_OBJECT
 
 public:  
-    explicit TorchClassifier(QObject *parent, QString filename, bool* loadOk, QString *errorString, int nInputs);
+    explicit TorchClassifier(QObject *parent, QString filename, bool* loadOk, QString *errorString, int nInputs, Settings settings = Settings());
 
-    Annotation getAnnotation (std::vector<double> input);
+    static void setThreadCounts(int intraOpThreads, int interOpThreads);
 
-    QString getName() const;
+    static bool exportMlp(QString filename, QString mlpFilename, QString *errorString);
+
+    static bool setQuantizedEngine(QString engineName, QString *errorString);
+
+    Annotation getAnnotation (const std::vector<double> &input, bool useCache = true) override;
+
+    QList<Annotation> getAnnotations (const std::vector<std::vector<double>> &inputs, int batchSize, bool useCache = true) override;
+
+    QString getName() const override;
 
     QString getFilename() const;
 
-    bool getIsInputAbsolute() const;
+    bool getIsInputAbsolute() const override;
+
+    QStringList getClassNames() const override;
+
+    int getN() const override;
+
+    int getInputWidth() const override;
+
+    int getWindowLength() const override;
 
-    QStringList getClassNames() const;
+    int getWindowStride() const override;
 
-    int getN() const;
+    bool getWindowSlopes() const override;
 
     int getM() const;
 
-    QString getPresetName() const;
+    QString getPresetName() const override;
+
+    InputFunctionType getInputFunctionType() const override;
+
+    bool getIsMultiLabel() const override;
+
+    double getThreshold() const override;
+
+    double getLoadTime() const;
+
+    double getFirstInferenceTime() const;
+
+    bool getIsQuantized() const;
+
+    QString getQuantizedEngine() const;
+
+    QByteArray getModelKey() const;
 
-    InputFunctionType getInputFunctionType() const;
+    void setCache(ClassificationCache *value) override;
 
 signals:
     void isInputAbsoluteSet (bool);
@@ -50,16 +83,54 @@ private:
     QString name;
     QString filename;
     QString presetName = "None";
+    QByteArray modelKey;                // identifies the model in the classification cache
+    QString preparation;                // applied by prepareModule: "int8 <engine>", "optimized", "frozen" or "float"
+    ClassificationCache *cache = nullptr;
     int N, M;
+    int windowLength = 1;               // func vectors per input
+    int windowStride = 1;               // func vectors between inputs classified
+    bool windowSlopes = false;          // slopes of the window appended to the input
+    int inputWidth = 0;
     std::vector<double> mean_vector, stdev_vector;
+    std::vector<double> shift, scale;   // precomputed normalisation: (x - shift) * scale, in double: the mean is close to the raw values
+
+    double loadTime = 0.0;              // in ms
+
+    /*!
+     * \brief The QuantizedLayer struct is a Linear layer with int8 weights prepacked for the quantized backend, followed by its activation.
+     */
+    struct QuantizedLayer{
+        c10::IValue packedWeights;
+        MlpClassifier::Activation activation = MlpClassifier::Activation::None;
+        float negativeSlope = 0.01f;
+    };
+    std::vector<QuantizedLayer> quantizedLayers;    // replace the module if set
+    bool reduceRange = false;                       // quantize activations to 7 bit to avoid overflows of FBGEMM
+    QString quantizedEngine;                        // engine the int8 layers were prepacked for
+    std::atomic<bool> firstInferenceDone{false};
+    double firstInferenceTime = 0.0;    // in ms
+
+    // input tensors reused by the inferences, one per inference running at the same time; freed with the classifier
+    mutable QMutex inputBufferMutex;
+    mutable std::vector<at::Tensor> inputBuffers;
+
+    void prepareModule(const Settings &settings);
+    bool quantize(QString *errorString);
+    static bool extractLayers(const torch::jit::script::Module &module, QList<MlpClassifier::Layer> &layers, QString *errorString);
+    void warmUp(int nRuns);
     InputFunctionType inputFunctionType = InputFunctionType::average;
     OutputFunctionType outputFunctionType = OutputFunctionType::logsoftmax;
     bool isMultiLabel = false;
     bool isRegression = false;
     double threshold = 0.3;
 
-    at::Tensor forward (std::vector<double> input);
-    std::vector<double> normalise(std::vector<double> input);
+    Annotation classify (const std::vector<double> &input);
+    at::Tensor takeInputBuffer (int nRows) const;
+    void returnInputBuffer (at::Tensor buffer) const;
+    at::Tensor forward (const at::Tensor &inputTensor);
+    at::Tensor forwardQuantized (const at::Tensor &inputTensor) const;
+    at::Tensor applyOutputFunction (const at::Tensor &output);
+    void normalise(const double *input, float *output) const;
 };
 
 #endif // TORCHCLASSIFIER_H
@@ -20,6 +20,7 @@ USBDataSource::~USBDataSource()
     closeConnections();
     closeSerialPort();
     delete serial;
+    delete journal;
 }
 
 USBDataSource::Settings USBDataSource::getSettings()
@@ -29,6 +30,20 @@ USBDataSource::Settings USBDataSource::getSettings()
 
 void USBDataSource::init()
 {
+    // capture raw bytes
+    if (!settings.journalFile.isEmpty())
+    {
+        journal = new SerialJournal(settings.journalFile);
+        try {
+            journal->open();
+            qDebug() << "Capturing serial data of" << settings.portName << "to" << settings.journalFile;
+        } catch (std::runtime_error e) {
+            emit error(e.what());
+            delete journal;
+            journal = nullptr;
+        }
+    }
+
     serial = new QSerialPort();
     makeConnections();
     openSerialPort();
@@ -37,12 +52,14 @@ void USBDataSource::init()
 
 DataSource::Status USBDataSource::status()
 {
-    if (connectionStatus != Status::NOT_CONNECTED)
+    if (connectionStatus != Status::NOT_CONNECTED && serial != nullptr)
     {
         // check if serial connection is still open
         if (!serial->isOpen())
         {
             closeSerialPort();
+            if (connectionStatus != Status::CONNECTION_ERROR)
+                nReconnects++;
             setStatus (Status::CONNECTION_ERROR);
         }
     }
@@ -70,8 +87,11 @@ void USBDataSource::makeConnections()
  */
 void USBDataSource::closeConnections()
 {
-    disconnect(serial, &QSerialPort::readyRead, this, &USBDataSource::handleReadyRead);
-    disconnect(serial, &QSerialPort::errorOccurred, this, &USBDataSource::handleError);
+    if (serial != nullptr)
+    {
+        disconnect(serial, &QSerialPort::readyRead, this, &USBDataSource::handleReadyRead);
+        disconnect(serial, &QSerialPort::errorOccurred, this, &USBDataSource::handleError);
+    }
     disconnect(timer, &QTimer::timeout, this, &USBDataSource::handleTimeout);
 }
 
@@ -93,6 +113,9 @@ void USBDataSource::openSerialPort()
     if (serial->open(QIODevice::ReadWrite))
     {
         serial->clear();
+        readBuffer.clear();
+        frameDecoder.clear();
+        binaryMode = false;
         setStatus (DataSource::Status::CONNECTING);
 
         // don't emit data until measurement is started
@@ -113,6 +136,10 @@ void USBDataSource::openSerialPort()
  */
 void USBDataSource::reconnect()
 {
+    // losses by timeouts & I/O errors were counted when the connection was closed
+    if (connectionStatus != Status::CONNECTION_ERROR)
+        nReconnects++;
+
     if (serial != nullptr)
     {
         closeSerialPort();
@@ -127,7 +154,7 @@ void USBDataSource::reconnect()
 
 void USBDataSource::closeSerialPort()
 {
-    if (serial->isOpen())
+    if (serial != nullptr && serial->isOpen())
     {
         serial->clear();
         serial->close();
@@ -143,9 +170,135 @@ void USBDataSource::closeSerialPort()
  */
 void USBDataSource::handleReadyRead()
 {
-    // process lines
-    while (serial->canReadLine())
-        processLine(serial->readLine());
+    QByteArray data = serial->readAll();
+
+    if (journal != nullptr)
+        journal->append(data);
+
+    processData(data);
+}
+
+/*!
+ * \brief USBDataSource::processData processes all complete lines received. Incomplete lines are kept until the rest of the line is received.
+ */
+void USBDataSource::processData(const QByteArray &data)
+{
+    if (binaryMode)
+    {
+        processFrames(data);
+        return;
+    }
+
+    readBuffer.append(data);
+
+    int start = 0, end;
+    while (!binaryMode && (end = readBuffer.indexOf('\n', start)) >= 0)
+    {
+        processLine(readBuffer.mid(start, end - start + 1));
+        start = end + 1;
+    }
+    readBuffer.remove(0, start);
+
+    // bytes after BINARY_OK are frames
+    if (binaryMode && !readBuffer.isEmpty())
+    {
+        QByteArray frameData;
+        frameData.swap(readBuffer);
+        processFrames(frameData);
+    }
+}
+
+/*!
+ * \brief USBDataSource::processFrames decodes all complete binary frames received.
+ */
+void USBDataSource::processFrames(const QByteArray &data)
+{
+    frameDecoder.append(data);
+    quint64 prevCrcErrors = frameDecoder.getNCrcErrors();
+
+    BinaryFrameDecoder::Frame frame;
+    while (frameDecoder.takeFrame(frame))
+    {
+        // reset timer
+        timer->start(timeout*1000);
+
+        switch (frame.type)
+        {
+        case BinaryFrameDecoder::FrameType::Measurement:
+            nReceived++;
+            processMeasFrame(frame);
+            break;
+        case BinaryFrameDecoder::FrameType::Fan:
+        {
+            int fanLevel = BinaryFrameDecoder::decodeFanLevel(frame);
+            if (fanLevel >= 0)
+                emit fanLevelSet(fanLevel);
+            break;
+        }
+        case BinaryFrameDecoder::FrameType::Event:
+            measEventFlag = true;
+            break;
+        }
+    }
+
+    nParseErrors += frameDecoder.getNCrcErrors() - prevCrcErrors;
+}
+
+/*!
+ * \brief USBDataSource::processMeasFrame decodes the channel values of \a frame directly into the vector reused for all frames.
+ */
+void USBDataSource::processMeasFrame(const BinaryFrameDecoder::Frame &frame)
+{
+    if (!emitData)
+    {
+        nIgnored++;
+        return;
+    }
+
+    if (frameVector.getSize() != static_cast<size_t>(nChannels))
+        frameVector = AbsoluteMVector(nullptr, static_cast<size_t>(nChannels));
+
+    quint32 frameCount;
+    double temperature, humidity;
+    bool hasEnvSensors;
+    if (!BinaryFrameDecoder::decodeMeasurement(frame, frameVector, frameCount, temperature, humidity, hasEnvSensors))
+    {
+        qWarning() << identifier() << ": Malformed measurement frame or number of values differs from " << nChannels << " channels";
+        nParseErrors++;
+        return;
+    }
+    count++;
+
+    frameVector.userAnnotation = Annotation();
+    frameVector.sensorAttributes.clear();
+    if (hasEnvSensors)
+    {
+        frameVector.sensorAttributes["humidity[%]"] = humidity;
+        frameVector.sensorAttributes["temperature[°C]"] = temperature;
+    }
+
+    processVector(currentTimestamp(), frameVector);
+}
+
+/*!
+ * \brief USBDataSource::requestBinaryProtocol asks the device to send binary frames instead of ASCII lines, if enabled in the settings.
+ * Devices not supporting the binary protocol ignore the request and continue to send lines.
+ */
+void USBDataSource::requestBinaryProtocol()
+{
+    if (!settings.binaryProtocol || serial == nullptr)
+        return;
+
+    QString command = "BINARY_ON\n";
+    serial->write(command.toStdString().c_str(), command.size());
+}
+
+/*!
+ * \brief USBDataSource::currentTimestamp returns the timestamp of vectors received now.
+ */
+uint USBDataSource::currentTimestamp()
+{
+    return QDateTime::currentDateTime().toTime_t();
 }
 
 void USBDataSource::handleError(QSerialPort::SerialPortError serialPortError)
@@ -158,8 +311,12 @@ void USBDataSource::handleError(QSerialPort::SerialPortError serialPortError)
 
     closeSerialPort();
 
+    if (connectionStatus != Status::CONNECTION_ERROR)
+        nReconnects++;
     setStatus (Status::CONNECTION_ERROR);
-    emit error("An I/O error occurred while reading the data from USB port " + serial->portName() + ",  error: " + serial->errorString());
+    // no serial port when replaying a journal
+    QString errorString = serial != nullptr ? serial->errorString() : "no serial port";
+    emit error("An I/O error occurred while reading the data from USB port " + settings.portName + ",  error: " + errorString);
 }
 
 void USBDataSource::handleTimeout()
@@ -171,6 +328,7 @@ void USBDataSource::handleTimeout()
 
     closeSerialPort();
 
+    nReconnects++;
     setStatus (Status::CONNECTION_ERROR);
     emit error("USB connection timed out without receiving data.\nCheck the connection settings and replug the sensor. Try to reconnect by starting a new measurement.");
 }
@@ -194,7 +352,12 @@ void USBDataSource::processLine(const QByteArray &data)
         }
         else
         {
-            if (isDeviceInfo(line) || deviceInfoRequests == 2)
+            if (isDeviceInfo(line))
+            {
+                setStatus(DataSource::Status::CONNECTED);
+                requestBinaryProtocol();
+            }
+            else if (deviceInfoRequests == 2)
                 setStatus(DataSource::Status::CONNECTED);
             else
             {
@@ -210,12 +373,20 @@ void USBDataSource::processLine(const QByteArray &data)
 //    qDebug() << line;
 
     if (isMeasValLine(line))
+    {
+        nReceived++;
         processMeasValLine(line);
+    }
     else if (isFanLine(line))
         processFanLine(line);
     else if (isEventLine(line))
         processEventLine(line);
-
+    else if (line.startsWith("BINARY_OK"))
+    {
+        qDebug() << identifier() << ": Switched to binary protocol";
+        frameDecoder.setNChannels(nChannels);
+        binaryMode = true;
+    }
 }
 
 bool USBDataSource::isMeasValLine(QString &line)
@@ -239,9 +410,12 @@ bool USBDataSource::isEventLine(QString &line)
 void USBDataSource::processMeasValLine(QString &line)
 {
     if (!emitData)
+    {
+        nIgnored++;
         return;
+    }
 
-    uint timestamp = QDateTime::currentDateTime().toTime_t();
+    uint timestamp = currentTimestamp();
 
     QStringList valueList;
     QMap<QString, double> parameterMap;
@@ -296,7 +470,17 @@ void USBDataSource::processMeasValLine(QString &line)
     }
 
     // extract values
-    AbsoluteMVector vector = getVector(valueList, parameterMap);
+    AbsoluteMVector vector(nullptr, nChannels);
+    if (!getVector(valueList, parameterMap, vector))
+        return;
+    processVector(timestamp, vector);
+}
+
+/*!
+ * \brief USBDataSource::processVector annotates measurement events, sets the base vector or publishes \a vector received at \a timestamp.
+ */
+void USBDataSource::processVector(uint timestamp, AbsoluteMVector &vector)
+{
     if (measEventFlag)
     {
         measEventFlag = false;
@@ -324,33 +508,39 @@ void USBDataSource::processMeasValLine(QString &line)
     if (startCount == 0)    // first count
     {
         // reset baselevel vector
-        baselevelVectorMap.clear();
+        baselineEstimator.reset(nChannels);
+        baseTimestamp = timestamp;
+        baseVectorPending = false;
 
         setStatus (Status::SET_BASEVECTOR);
         startCount = count;
-        baselevelVectorMap[timestamp] = vector;
     }
-    if (status() == Status::SET_BASEVECTOR && count < startCount + nBaseVectors) // prepare baselevel
+    if (status() == Status::SET_BASEVECTOR && !baselineEstimator.isReady()) // prepare baselevel
     {
-        baselevelVectorMap[timestamp] = vector;
-    } else if (status() == Status::SET_BASEVECTOR && count == startCount + nBaseVectors) // set baselevel
-    {
-        baselevelVectorMap[timestamp] = vector;
-
-        MVector baselevelVector;
-
-        for (uint ts : baselevelVectorMap.keys())
-            baselevelVector = baselevelVector + baselevelVectorMap[ts] / baselevelVectorMap.size();
-
         // set base vector
-        emit baseVectorSet(baselevelVectorMap.firstKey(), baselevelVector);
+        if (baselineEstimator.update(vector))
+        {
+            publishBaseVector(baseTimestamp, baselineEstimator.getBaseVector());
+            lastBaseTimestamp = baseTimestamp;
+        }
     }
     else // get vector & emit
     {
         if (connectionStatus != Status::RECEIVING_DATA)
             setStatus (Status::RECEIVING_DATA);
 
-        emit vectorReceived(timestamp, vector);
+        // drift of the base vector applies to this vector,
+        // only one base vector per timestamp: a drift within the second of the last one is published with the next timestamp
+        if (baselineEstimator.update(vector))
+            baseVectorPending = true;
+        if (baseVectorPending && timestamp > lastBaseTimestamp)
+        {
+            publishBaseVector(timestamp, baselineEstimator.getBaseVector());
+            lastBaseTimestamp = timestamp;
+            baseVectorPending = false;
+        }
+
+        publishVector(timestamp, vector);
     }
 }
 
@@ -391,7 +581,7 @@ bool USBDataSource::isDeviceInfo(QString &line)
 
 void USBDataSource::requestDeviceInfo()
 {
-    if (deviceInfoRequests == 0)
+    if (deviceInfoRequests == 0 && serial != nullptr)
     {
         QString command = "GET_INFO\n";
         serial->write(command.toStdString().c_str(), command.size());
@@ -425,7 +615,7 @@ void USBDataSource::start()
     Q_ASSERT("Usb connection is not connected!" && connectionStatus != Status::NOT_CONNECTED);
 
     // start new measurement
-    if (status() != Status::PAUSED && !baselevelVectorMap.isEmpty())
+    if (status() != Status::PAUSED && !baselineEstimator.isEmpty())
     {
         // start meas
         startCount = 0;
@@ -446,7 +636,7 @@ void USBDataSource::pause()
     Q_ASSERT("Usb connection was already started!" && connectionStatus == Status::RECEIVING_DATA || connectionStatus == Status::SET_BASEVECTOR);
 
     if (connectionStatus == Status::SET_BASEVECTOR)
-        baselevelVectorMap.clear();
+        baselineEstimator.reset(nChannels);
 
     emitData = false;
     setStatus (Status::PAUSED);
@@ -486,18 +676,26 @@ QString USBDataSource::identifier()
 }
 
 /*!
- * \brief USBDataSource::getVector return MVector with values contained in line.
- * Set infinite for negative values
- * \return
+ * \brief USBDataSource::getVector sets \a vector to the values contained in line.
+ * Lines with missing or malformed values are counted as parse errors and rejected: error() is emitted and false is returned.
  */
-AbsoluteMVector USBDataSource::getVector(QStringList vectorList, QMap<QString, double> parameterMap)
+bool USBDataSource::getVector(QStringList vectorList, QMap<QString, double> parameterMap, AbsoluteMVector &vector)
 {
-    AbsoluteMVector vector;
+    if (vectorList.size() < nChannels)
+    {
+        nParseErrors++;
+        emit error("Measurement line with " + QString::number(vectorList.size()) + " values received, expected " + QString::number(nChannels) + ". The line is ignored.");
+        return false;
+    }
 
-    for (int i=0; i<MVector::nChannels; i++)
+    bool valid = true;
+
+    for (int i=0; i<nChannels; i++)
     {
         // get values
-        vector[i] = vectorList[i].toDouble(); // ignore first entry in vectorList (count)
+        bool ok;
+        vector[i] = vectorList[i].toDouble(&ok); // ignore first entry in vectorList (count)
+        valid = valid && ok;
 
 //        // values < 0 or value == 1.0:
 //        // huge resistances on sensor
@@ -507,7 +705,10 @@ AbsoluteMVector USBDataSource::getVector(QStringList vectorList, QMap<QString, d
 
     vector.sensorAttributes = parameterMap;
 
-    return vector;
+    if (!valid)
+        nParseErrors++;
+
+    return true;
 }
 
 bool USBDataSource::getHasEnvSensors() const
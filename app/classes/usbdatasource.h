@@ -2,6 +2,8 @@
 #define USBDATASOURCE_H
 
 #include "datasource.h"
+#include "serialjournal.h"
+#include "binaryframedecoder.h"
 #include "qserialport.h"
 
 class USBDataSource : public DataSource
@@ -21,6 +23,12 @@ public:
         QString deviceId;
         QString firmwareVersion;
         bool hasEnvSensors;
+
+        // raw capture of the bytes received, empty: no capture
+        QString journalFile;
+
+        // request binary frames (opt-in), devices not supporting them keep sending ASCII lines
+        bool binaryProtocol = false;
     };
 
     USBDataSource(Settings settings, int sensorTimeout, int sensorNChannels);
@@ -61,10 +69,25 @@ private slots:
     void processMeasValLine(QString &line);
     void processFanLine(QString &line);
     void processEventLine(QString &line);
+    void processFrames(const QByteArray &data);
+    void processMeasFrame(const BinaryFrameDecoder::Frame &frame);
+    void processVector(uint timestamp, AbsoluteMVector &vector);
+    void requestBinaryProtocol();
     bool isDeviceInfo(QString &line);
     void requestDeviceInfo();
     void getChannelInfo(QString &ine);
 
+protected:
+    Settings settings;
+    bool emitData;
+    int deviceInfoRequests = 0;
+    QByteArray readBuffer;     // received bytes of incomplete lines
+    bool binaryMode = false;    // device sends binary frames
+    BinaryFrameDecoder frameDecoder;
+
+    void processData(const QByteArray &data);
+    virtual uint currentTimestamp();
+
 private:
     void openSerialPort();
     void closeSerialPort();
@@ -76,17 +99,19 @@ private:
     bool isEventLine(QString &line);
 
 
-    AbsoluteMVector getVector(QStringList, QMap<QString, double> parameterMap);
+    bool getVector(QStringList, QMap<QString, double> parameterMap, AbsoluteMVector &vector);
 
     QSerialPort *serial = nullptr;
-    Settings settings;
+    SerialJournal *journal = nullptr;
     bool measEventFlag = false;
     bool exposureStartSet = false,  exposureEndSet = false;
     bool runningMeasFailed = false;
 
-    bool emitData;
-    int deviceInfoRequests = 0;
     int count = 0;
+    uint baseTimestamp = 0;     // timestamp of the first vector used for the current base vector
+    uint lastBaseTimestamp = 0; // timestamp of the last base vector published
+    bool baseVectorPending = false; // drifted base vector not yet published
+    AbsoluteMVector frameVector;    // reused for all measurement frames
 };
 
 #endif // USBDATASOURCE_H
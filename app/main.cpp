@@ -35,7 +35,7 @@ int main(int argc, char *argv[])
     QTimer::singleShot(0, &c, &Controler::initialize);
 
     // start application
-    if (!c.getParseResult().curveFit)
+    if (!c.getParseResult().isHeadless())
         c.getWindow()->show();
     return a.exec();
 }
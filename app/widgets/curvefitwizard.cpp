@@ -19,11 +19,6 @@ CurveFitWizard::CurveFitWizard(MeasurementData* mData, QWidget* parent):
     setPage(Page_Fit, fitPage);
     setPage(Page_Result, resultPage);
 
-    // don't delete QRunnable after run() was finished
-    // -> 1 call to run for each channel
-    worker->setAutoDelete(false);
-//    QThreadPool::globalInstance()->setMaxThreadCount(1);
-
     // page connections:
     // worker settings
     connect(introPage, &IntroPage::typeChanged, this, &CurveFitWizard::selectType);
@@ -38,6 +33,8 @@ CurveFitWizard::CurveFitWizard(MeasurementData* mData, QWidget* parent):
 
     connect(introPage, &IntroPage::nIterationsChanged, worker, &CurveFitWorker::setNIterations);
     connect(introPage, &IntroPage::limitFactorChanged, worker, &CurveFitWorker::setLimitFactor);
+    connect(introPage, &IntroPage::targetErrorChanged, worker, &CurveFitWorker::setTargetError);
+    connect(introPage, &IntroPage::warmStartChanged, worker, &CurveFitWorker::setWarmStart);
 
     // range determination
     connect(worker, &CurveFitWorker::rangeRedeterminationPossible, introPage, &IntroPage::setRangeRedeterminationPossible);
@@ -70,8 +67,8 @@ CurveFitWizard::CurveFitWizard(MeasurementData* mData, QWidget* parent):
 CurveFitWizard::~CurveFitWizard()
 {
     // stop worker threads and delete worker
-    QThreadPool::globalInstance()->clear();
-    QThreadPool::globalInstance()->waitForDone();
+    worker->cancel();
+    worker->waitForDone();
     worker->deleteLater();
 }
 
@@ -110,12 +107,10 @@ void CurveFitWizard::fitCurves()
 
     // debug: only one active fitWorker thread at once
     if (CVWIZ_DEBUG_MODE)
-        QThreadPool::globalInstance()->setMaxThreadCount(1);
+        worker->setNThreads(1);
 
     qDebug() << "\n--------\nStarting curve fit:";
-    qDebug() << "max thread count:\t" << QString::number(QThreadPool::globalInstance()->maxThreadCount());
-    for (size_t i=0; i<nChannels; i++)
-        QThreadPool::globalInstance()->start(worker);
+    worker->start();
 }
 
 IntroPage::IntroPage(QWidget* parent):
@@ -124,7 +119,9 @@ IntroPage::IntroPage(QWidget* parent):
     typeSelector(new QComboBox),
     detectExpositionStartCheckBox(new QCheckBox),
     detectRecoveryCheckBox(new QCheckBox),
+    warmStartCheckBox(new QCheckBox),
     limitFactorSpinBox(new QDoubleSpinBox),
+    targetErrorSpinBox(new QDoubleSpinBox),
     jumpFactorSpinBox(new QDoubleSpinBox),
     jumpBaseThresholdSpinBox(new QDoubleSpinBox),
     recoveryFactorSpinBox(new QDoubleSpinBox),
@@ -158,6 +155,18 @@ IntroPage::IntroPage(QWidget* parent):
     modelLayout->addRow("Conversion limit factor", limitFactorSpinBox);
     modelLayout->labelForField(limitFactorSpinBox)->setToolTip("The convergion limit defines the maximum convergion value of accepted solutions.\nConvergion limit = convergion limit factor * maxValue(channel)");
 
+    targetErrorSpinBox->setRange(0.0, 1000.);
+    targetErrorSpinBox->setDecimals(3);
+    targetErrorSpinBox->setSingleStep(0.01);
+    targetErrorSpinBox->setValue(CVWIZ_DEFAULT_TARGET_ERROR);
+    targetErrorSpinBox->setSpecialValueText("off");
+    modelLayout->addRow("Target error", targetErrorSpinBox);
+    modelLayout->labelForField(targetErrorSpinBox)->setToolTip("The solving repetitions of a channel stop as soon as a valid solution reaches this rms error.\nResults are reproducible for any number of threads.");
+
+    warmStartCheckBox->setCheckState(CVWIZ_DEFAULT_WARM_START ? Qt::CheckState::Checked : Qt::CheckState::Unchecked);
+    modelLayout->addRow("Warm start", warmStartCheckBox);
+    modelLayout->labelForField(warmStartCheckBox)->setToolTip("Channels of the same functionalisation start from the fit of the channel with the most samples.\nRandom solving repetitions are only used if that start is not accepted.");
+
     modelGroupBox->setLayout(modelLayout);
 
     QGroupBox *detectiongroupBox = new QGroupBox(tr("Detection settings"));
@@ -205,6 +214,8 @@ IntroPage::IntroPage(QWidget* parent):
     connect(typeSelector, &QComboBox::currentTextChanged, this, &IntroPage::typeChanged);
     connect(nIterationsSpinBox, SIGNAL(valueChanged(int)), this, SIGNAL(nIterationsChanged(int)));
     connect(limitFactorSpinBox, SIGNAL(valueChanged(double)), this, SIGNAL(limitFactorChanged(double)));
+    connect(targetErrorSpinBox, SIGNAL(valueChanged(double)), this, SIGNAL(targetErrorChanged(double)));
+    connect(warmStartCheckBox, &QCheckBox::toggled, this, &IntroPage::warmStartChanged);
 
     connect(jumpBaseThresholdSpinBox, SIGNAL(valueChanged(double)), this, SIGNAL(jumpBaseThresholdChanged(double)));
     connect(jumpFactorSpinBox, SIGNAL(valueChanged(double)), this, SIGNAL(jumpFactorChanged(double)));
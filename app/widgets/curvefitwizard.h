@@ -29,6 +29,8 @@ Q_SIGNALS:
     void typeChanged(QString typeString);
     void nIterationsChanged(const int &value);
     void limitFactorChanged(const double &value);
+    void targetErrorChanged(double targetError);
+    void warmStartChanged(bool warmStart);
     void jumpBaseThresholdChanged(double jumpBaseThreshold);
     void jumpFactorChanged(double jumpFactor);
     void recoveryFactorChanged (double recoveryFactor);
@@ -45,8 +47,8 @@ public Q_SLOTS:
 private:
     QFormLayout *detectionLayout;
     QComboBox *typeSelector;
-    QCheckBox *detectExpositionStartCheckBox, *detectRecoveryCheckBox;
-    QDoubleSpinBox *limitFactorSpinBox, *jumpFactorSpinBox, *jumpBaseThresholdSpinBox, *recoveryFactorSpinBox;
+    QCheckBox *detectExpositionStartCheckBox, *detectRecoveryCheckBox, *warmStartCheckBox;
+    QDoubleSpinBox *limitFactorSpinBox, *targetErrorSpinBox, *jumpFactorSpinBox, *jumpBaseThresholdSpinBox, *recoveryFactorSpinBox;
     QSpinBox *nIterationsSpinBox, *fitBufferSpinBox, *recoveryTimeSpinBox;
     bool rangeRedeterminationPossible = false;
 };
@@ -117,6 +117,105 @@ void GeneralSettingsDialog::setRunAutoSaveInterval(uint minutes)
     ui->save_SpinBox->setValue(minutes);
 }
 
+BaselineEstimator::Mode GeneralSettingsDialog::getBaselineMode() const
+{
+    return BaselineEstimator::modeFromString(ui->baselineModeComboBox->currentText());
+}
+
+void GeneralSettingsDialog::setBaselineMode(BaselineEstimator::Mode mode)
+{
+    ui->baselineModeComboBox->setCurrentText(BaselineEstimator::modeToString(mode));
+}
+
+bool GeneralSettingsDialog::getTrackDrift() const
+{
+    return ui->trackDriftCheckBox->isChecked();
+}
+
+void GeneralSettingsDialog::setTrackDrift(bool value)
+{
+    ui->trackDriftCheckBox->setChecked(value);
+}
+
+bool GeneralSettingsDialog::getFreezeClassifier() const
+{
+    return ui->freezeClassifierCheckBox->isChecked();
+}
+
+void GeneralSettingsDialog::setFreezeClassifier(bool value)
+{
+    ui->freezeClassifierCheckBox->setChecked(value);
+}
+
+bool GeneralSettingsDialog::getOptimizeClassifier() const
+{
+    return ui->optimizeClassifierCheckBox->isChecked();
+}
+
+void GeneralSettingsDialog::setOptimizeClassifier(bool value)
+{
+    ui->optimizeClassifierCheckBox->setChecked(value);
+}
+
+int GeneralSettingsDialog::getClassifierWarmupRuns() const
+{
+    return ui->warmupRunsSpinBox->value();
+}
+
+void GeneralSettingsDialog::setClassifierWarmupRuns(int value)
+{
+    ui->warmupRunsSpinBox->setValue(value);
+}
+
+/*!
+ * \brief GeneralSettingsDialog::getIntraOpThreads returns the number of intra-op threads of libtorch. 0: libtorch default
+ */
+int GeneralSettingsDialog::getIntraOpThreads() const
+{
+    return ui->intraOpThreadsSpinBox->value();
+}
+
+void GeneralSettingsDialog::setIntraOpThreads(int value)
+{
+    ui->intraOpThreadsSpinBox->setValue(value);
+}
+
+/*!
+ * \brief GeneralSettingsDialog::getInterOpThreads returns the number of inter-op threads of libtorch. 0: libtorch default
+ */
+int GeneralSettingsDialog::getInterOpThreads() const
+{
+    return ui->interOpThreadsSpinBox->value();
+}
+
+void GeneralSettingsDialog::setInterOpThreads(int value)
+{
+    ui->interOpThreadsSpinBox->setValue(value);
+}
+
+ClassifierEnsemble::MergeRule GeneralSettingsDialog::getEnsembleMergeRule() const
+{
+    return ClassifierEnsemble::mergeRuleFromString(ui->ensembleMergeRuleComboBox->currentText());
+}
+
+void GeneralSettingsDialog::setEnsembleMergeRule(ClassifierEnsemble::MergeRule rule)
+{
+    ui->ensembleMergeRuleComboBox->setCurrentText(ClassifierEnsemble::mergeRuleToString(rule));
+}
+
+/*!
+ * \brief GeneralSettingsDialog::getClassifierQuantization returns "off" or the quantized backend of libtorch used for int8 classifiers ("auto", "fbgemm" or "qnnpack").
+ */
+QString GeneralSettingsDialog::getClassifierQuantization() const
+{
+    return ui->quantizationComboBox->currentText();
+}
+
+void GeneralSettingsDialog::setClassifierQuantization(QString value)
+{
+    ui->quantizationComboBox->setCurrentText(value);
+}
+
 void GeneralSettingsDialog::on_presetDirPushButton_clicked()
 {
     QString presetDir = QFileDialog::getExistingDirectory(this, "Set preset folder", ui->presetDirlineEdit->text());
@@ -130,4 +229,13 @@ void GeneralSettingsDialog::on_defaultPushButton_clicked()
     ui->maxValSpinBox->setValue(DEFAULT_UPPER_LIMIT);
     ui->useLimitsCheckBox->setCheckState(DEFAULT_USE_LIMITS ? Qt::CheckState::Checked : Qt::CheckState::Unchecked);
     ui->presetDirlineEdit->setText(QDir(DEFAULT_PRESET_DIR).absolutePath());
+    ui->baselineModeComboBox->setCurrentText(DEFAULT_BASELINE_MODE);
+    ui->trackDriftCheckBox->setChecked(DEFAULT_BASELINE_DRIFT);
+    ui->freezeClassifierCheckBox->setChecked(DEFAULT_CLASSIFIER_FREEZE);
+    ui->optimizeClassifierCheckBox->setChecked(DEFAULT_CLASSIFIER_OPTIMIZE);
+    ui->warmupRunsSpinBox->setValue(DEFAULT_CLASSIFIER_WARMUP_RUNS);
+    ui->intraOpThreadsSpinBox->setValue(DEFAULT_CLASSIFIER_INTRA_OP_THREADS);
+    ui->interOpThreadsSpinBox->setValue(DEFAULT_CLASSIFIER_INTER_OP_THREADS);
+    ui->ensembleMergeRuleComboBox->setCurrentText(DEFAULT_ENSEMBLE_MERGE_RULE);
+    ui->quantizationComboBox->setCurrentText(DEFAULT_CLASSIFIER_QUANTIZATION);
 }
@@ -5,6 +5,8 @@
 #include <QDialog>
 
 #include "bargraphwidget_old.h"
+#include "../classes/baselineestimator.h"
+#include "../classes/classifierensemble.h"
 
 namespace Ui {
 class GeneralSettings;
@@ -37,6 +39,33 @@ public:
     uint getRunAutoSaveInterval() const;
     void setRunAutoSaveInterval(uint minutes);
 
+    BaselineEstimator::Mode getBaselineMode() const;
+    void setBaselineMode(BaselineEstimator::Mode mode);
+
+    bool getTrackDrift() const;
+    void setTrackDrift(bool value);
+
+    bool getFreezeClassifier() const;
+    void setFreezeClassifier(bool value);
+
+    bool getOptimizeClassifier() const;
+    void setOptimizeClassifier(bool value);
+
+    int getClassifierWarmupRuns() const;
+    void setClassifierWarmupRuns(int value);
+
+    int getIntraOpThreads() const;
+    void setIntraOpThreads(int value);
+
+    int getInterOpThreads() const;
+    void setInterOpThreads(int value);
+
+    ClassifierEnsemble::MergeRule getEnsembleMergeRule() const;
+    void setEnsembleMergeRule(ClassifierEnsemble::MergeRule rule);
+
+    QString getClassifierQuantization() const;
+    void setClassifierQuantization(QString value);
+
 
 private slots:
     void on_buttonBox_accepted();
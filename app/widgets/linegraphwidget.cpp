@@ -1111,6 +1111,32 @@ void LineGraphWidget::addVector(uint timestamp, MVector vector, const Functional
     }
 }
 
+/*!
+ * \brief LineGraphWidget::addVectors adds all \a vectors and replots only once afterwards.
+ * Used when several vectors are delivered at once, e.g. by the source buffer of a running measurement.
+ */
+void LineGraphWidget::addVectors(const QMap<uint, MVector> &vectors, const Functionalisation &functionalisation, const std::vector<bool> &sensorFailures)
+{
+    if (vectors.isEmpty())
+        return;
+
+    bool prevReplotStatus = replotStatus;
+    replotStatus = false;
+
+    for (auto it = vectors.constBegin(); it != vectors.constEnd(); ++it)
+        addVector(it.key(), it.value(), functionalisation, sensorFailures);
+
+    if (!prevReplotStatus)
+        return;
+
+    // y-autoscale as in addVector, but only for the latest vector
+    auto xIntv = axisInterval(QwtPlot::xBottom);
+    if (qFuzzyCompare( xIntv.width(), LGW_AUTO_MOVE_ZONE_SIZE*1000 ) && xIntv.contains(getT(vectors.lastKey())) )
+        autoScale(false, true);
+
+    setReplotStatus(true);
+}
+
 RelativeLineGraphWidget::RelativeLineGraphWidget(QWidget* parent):
     LineGraphWidget(parent)
 {
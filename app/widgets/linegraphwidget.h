@@ -135,6 +135,8 @@ signals:
 public slots:
     virtual void addVector(uint timestamp, MVector vector, const Functionalisation &functionalisation, const std::vector<bool> &sensorFailures);
 
+    void addVectors(const QMap<uint, MVector> &vectors, const Functionalisation &functionalisation, const std::vector<bool> &sensorFailures);
+
     void clearGraph();
 
     void zoomToData();
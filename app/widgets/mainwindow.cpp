@@ -25,10 +25,12 @@ MainWindow::MainWindow(QWidget *parent)
     // init statusbar
     statusTextLabel = new QLabel(statusBar());
     statusImageLabel = new QLabel(statusBar());
+    healthLabel = new QLabel(statusBar());
     statusTextLabel->setText("Sensor status: Not connected ");
     statusImageLabel->setPixmap(QPixmap(":/icons/disconnected"));
     statusImageLabel->setScaledContents(true);
     statusImageLabel->setMaximumSize(16,16);
+    statusBar()->addPermanentWidget(healthLabel);
     statusBar()->addPermanentWidget(statusTextLabel);
     statusBar()->addPermanentWidget(statusImageLabel);
 
@@ -94,6 +96,28 @@ void MainWindow::addVector(uint timestamp, AbsoluteMVector absoluteVector, const
 
 }
 
+/*!
+ * \brief MainWindow::addVectors adds \a vectors to all graphs. Each graph is replotted once.
+ */
+void MainWindow::addVectors(const QMap<uint, AbsoluteMVector> &vectors, const Functionalisation &functionalisation, const std::vector<bool> &sensorFailures)
+{
+    QMap<uint, MVector> absVectors, relVectors, funcVectors;
+
+    for (auto it = vectors.constBegin(); it != vectors.constEnd(); ++it)
+    {
+        absVectors.insert(it.key(), it.value());
+
+        RelativeMVector relVector = it.value().getRelativeVector();
+        relVectors.insert(it.key(), relVector);
+        funcVectors.insert(it.key(), relVector.getFuncVector(functionalisation, sensorFailures));
+    }
+
+    absLineGraph->addVectors(absVectors, functionalisation, sensorFailures);
+    relLineGraph->addVectors(relVectors, functionalisation, sensorFailures);
+    funcLineGraph->addVectors(funcVectors, functionalisation, sensorFailures);
+    parameterLineGraph->addVectors(absVectors, functionalisation, sensorFailures);
+}
+
 void MainWindow::setData(const QMap<uint, AbsoluteMVector> &data, const Functionalisation &functionalisation, const std::vector<bool> &sensorFailures)
 {
     absLineGraph->clearGraph();
@@ -133,6 +157,15 @@ void MainWindow::setData(const QMap<uint, AbsoluteMVector> &data, const Function
         parameterLineGraph->zoomToData();
 }
 
+/*!
+ * \brief MainWindow::setPipelineHealth shows the rates of the source pipeline in the statusbar, details as tool tip.
+ */
+void MainWindow::setPipelineHealth(PipelineHealth health)
+{
+    healthLabel->setText(health.toStatusString() + "  ");
+    healthLabel->setToolTip(health.toString().replace(",\t", "\n").replace(":\t", ":\n"));
+}
+
 void MainWindow::setStatus(DataSource::Status newStatus)
 {
     switch (newStatus) {
@@ -14,6 +14,7 @@
 #include "classifierwidget.h"
 
 #include "../classes/clouduploader.h"
+#include "../classes/devicepipeline.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -78,11 +79,13 @@ signals:
 
 public slots:
     void addVector(uint timestamp, AbsoluteMVector absoluteVector, const Functionalisation &functionalisation, const std::vector<bool> &sensorFailures);
+    void addVectors(const QMap<uint, AbsoluteMVector> &vectors, const Functionalisation &functionalisation, const std::vector<bool> &sensorFailures);
     void setData(const QMap<uint, AbsoluteMVector> &data, const Functionalisation &functionalisation, const std::vector<bool> &sensorFailures);
     void clearGraphs();
 
     void setStatus(DataSource::Status newStatus);
     void setFanLevel(int level);
+    void setPipelineHealth(PipelineHealth health);
 
     void sensorConnected(QString sensorId);
 
@@ -187,6 +190,7 @@ private:
 
     QLabel *statusTextLabel;
     QLabel *statusImageLabel;
+    QLabel *healthLabel;
 
     bool dataIsChanged = false;
     bool converterRunning = false;